@@ -33,6 +33,10 @@ extern "C" {
  * @file metadata_extractor.h
  * @brief This file contains the multimedia content metadata extractor API and related structure and enumeration. \n
  *        Description of metadata: duration, bitrate, album, artist, author, genre and description etc. \n
+ *
+ * A handle may be shared by several threads calling the getters at the same time. The first getter extracts
+ * the file and the others wait for it; after that getters take no lock. metadata_extractor_set_path(),
+ * metadata_extractor_set_stats_enabled(), metadata_extractor_set_arena_enabled(), metadata_extractor_set_allocator(), metadata_extractor_set_prefetch_depth(), metadata_extractor_set_source(), metadata_extractor_set_waveform_cache() and metadata_extractor_destroy() must not run concurrently with any other call on the same handle.
  */
 
 
@@ -84,7 +88,7 @@ int metadata_extractor_destroy(metadata_extractor_h metadata);
 /**
  * @brief Get metadata
  *
- * @remarks @a value must be released with @c free() by you
+ * @remarks @a value must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
  *
  * @param [in] metadata The handle to metadata
  * @param [in] attribute key attribute name to get
@@ -103,7 +107,7 @@ int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extr
 /**
  * @brief Get artwork image in media file
  *
- * @remarks @a artwork and @a artwork_mime must be released with @c free() by you
+ * @remarks @a artwork and @a artwork_mime must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
  *
  * @param [in] metadata The handle to metadata
  * @param [out] artwork encoded artwork image
@@ -120,10 +124,150 @@ int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extr
 int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork, int *size, char **mime_type);
 
 
+/**
+ * @brief Get artwork image in media file without copying it
+ *
+ * @remarks @a artwork and @a mime_type point into the handle and must not be released. They stay valid until
+ * the next metadata_extractor_set_path() or metadata_extractor_destroy(). @a mime_type is NULL when the tag has none.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [out] artwork encoded artwork image
+ * @param [out] size encoded artwork size
+ * @param [out] mime_type mime type of artwork
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_artwork()
+ */
+int metadata_extractor_get_artwork_view(metadata_extractor_h metadata, const void **artwork, int *size, const char **mime_type);
+
+/**
+ * @brief Get a digest of the artwork of media file
+ *
+ * @remarks The digest is the XXH64 hash, seed 0, of the artwork bytes, computed without copying them.
+ * Equal digests mean equal artwork, so a cover shared by the tracks of an album needs to be fetched and stored once only.
+ * The digests match those of a batch with artwork enabled.
+ * @remarks If there is no artwork, @a digest and @a size are 0.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [out] digest The digest of the artwork
+ * @param [out] size The artwork size
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_FILE_EXISTS File not exist
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_artwork(), metadata_extractor_batch_set_artwork_enabled()
+ */
+int metadata_extractor_get_artwork_digest(metadata_extractor_h metadata, unsigned long long *digest, int *size);
+
+
+/**
+ * @brief Get where the artwork image is stored in media file
+ *
+ * @remarks For a picture stored as plain bytes, in an ID3v2 APIC frame without unsynchronisation, compression or encryption,
+ * a FLAC PICTURE block or an MP4 covr atom, @a offset and @a size give its place in the file, so that it can be sent with
+ * @c sendfile() or @c splice() without reading it. A front cover is preferred when a tag holds several pictures.\n
+ * @a size is 0 when the file has no picture stored that way; metadata_extractor_get_artwork() may still return one.\n
+ * @a mime_type must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled.
+ * It is NULL when neither the tag nor the first bytes of the picture tell the type.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [out] offset The byte offset of the picture in the file
+ * @param [out] size The size of the picture
+ * @param [out] mime_type mime type of the picture
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_FILE_EXISTS File not exist
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_artwork()
+ */
+int metadata_extractor_get_artwork_location(metadata_extractor_h metadata, long long *offset, int *size, char **mime_type);
+
+
+/**
+ * @brief Get artwork of media file scaled down to thumbnail size
+ *
+ * @remarks @a image must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
+ * @remarks The artwork is scaled to fit into @a max_dim x @a max_dim keeping its aspect ratio, and is never scaled up.
+ * A JPEG artwork is decoded at 1/2, 1/4 or 1/8 of its size where that is still large enough, so a large cover is never decoded in full.
+ * @remarks Only JPEG and PNG artwork is supported. If there is no artwork, @a image is NULL and @a size, @a width and @a height are 0.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] max_dim The largest width and height of the result, in pixels
+ * @param [in] format The format of the result
+ * @param [out] image The scaled artwork, raw pixels or an encoded file depending on @a format
+ * @param [out] size The size of @a image
+ * @param [out] width The width of the scaled artwork
+ * @param [out] height The height of the scaled artwork
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_artwork()
+ */
+int metadata_extractor_get_artwork_scaled(metadata_extractor_h metadata, int max_dim, metadata_extractor_image_format_e format, void **image, int *size, int *width, int *height);
+
+
+/**
+ * @brief Get a fingerprint of media file to find duplicates
+ *
+ * @remarks The fingerprint combines the container format, the duration and the stream parameters with a hash of
+ * the audio and video payload. Tag blocks are left out of the hash: leading and trailing ID3v2, ID3v1 and APEv2 tags,
+ * the FLAC metadata blocks, and for MP4 everything but the mdat boxes. Copies that differ in their tags only thus get equal fingerprints.
+ * @remarks The whole payload is read once, front to back.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [out] fingerprint The fingerprint
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_FILE_EXISTS File not exist
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_artwork_digest()
+ */
+int metadata_extractor_get_fingerprint(metadata_extractor_h metadata, metadata_extractor_fingerprint_s *fingerprint);
+
+
+/**
+ * @brief Get a waveform overview of audio media file
+ *
+ * @remarks @a peaks must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
+ * @remarks The audio is split into @a buckets runs of equal length, and each bucket gets the lowest and highest sample and the
+ * root mean square of the samples of all channels. The file is read once in fixed-size pieces, so memory use does not grow with its length.
+ * Buckets past the end of a short or truncated file are 0.
+ * @remarks Only uncompressed PCM and IEEE float WAVE files are supported; other files fail with #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED.
+ * @remarks With a directory set by metadata_extractor_set_waveform_cache(), results are kept there and reused.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] buckets The number of buckets, from 1 to 65536
+ * @param [out] peaks The @a buckets peaks in order of time
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_FILE_EXISTS File not exist
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail, or the audio format is not supported
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_set_waveform_cache()
+ */
+int metadata_extractor_get_waveform(metadata_extractor_h metadata, int buckets, metadata_extractor_peak_s **peaks);
+
+
 /**
  * @brief Get frame of video media file
  *
- * @remarks @a frame must be released with @c free() by you
+ * @remarks @a frame must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
  *
  * @param [in] metadata The handle to metadata
  * @param [out] frame raw frame data in RGB888
@@ -139,10 +283,71 @@ int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork
 int metadata_extractor_get_frame(metadata_extractor_h metadata, void **frame, int *size);
 
 
+/**
+ * @brief Get the most informative of a few keyframes of video media file, for a representative thumbnail
+ *
+ * @remarks @a frame must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
+ * @remarks Up to @a budget keyframes spread evenly over the duration, away from its start and end, are decoded and scored by
+ * the entropy of their luminance histogram and their luminance variance on a small downscaled copy, so black intro frames
+ * and fades lose. Decoding stops early once a frame scores high enough. At most 32 keyframes are decoded.
+ * @remarks If the file has no video or none of the keyframes can be decoded, the result is that of metadata_extractor_get_frame().
+ * The size of @a frame is given by #METADATA_VIDEO_WIDTH and #METADATA_VIDEO_HEIGHT.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] budget The most keyframes to decode, or 0 for the default of 5
+ * @param [out] frame raw frame data in RGB888
+ * @param [out] size The frame data size
+ * @param [out] timestamp The position of @a frame in milliseconds, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_frame(), metadata_extractor_get_frame_at_time()
+ */
+int metadata_extractor_get_best_frame(metadata_extractor_h metadata, int budget, void **frame, int *size, unsigned long *timestamp);
+
+
+/**
+ * @brief Get a sprite sheet of video frames for seek previews
+ *
+ * @remarks @a sheet and @a tiles must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
+ * @remarks Frames are taken every @a interval milliseconds from the start, at most @a count of them, or with @a interval 0,
+ * @a count frames spread evenly over the duration. At most 1024 frames are taken.
+ * Each frame is scaled to fit into @a tile_width x @a tile_height keeping its aspect ratio, and the tiles are laid out
+ * left to right and top to bottom in a near-square grid. Only one decoded frame is held at a time.
+ * @remarks With @a is_accurate @c false only keyframes are decoded, as in metadata_extractor_get_frame_at_time().
+ * Positions that fall into the same group of pictures decode to the same keyframe and share its tile, so the sheet
+ * may hold fewer tiles than @a tile_count; @a height covers the rows in use.
+ * @remarks @a tiles has one entry per position with the tile it maps to. If the file has no video, @a sheet and @a tiles are NULL and the sizes 0.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] interval The time between frames in milliseconds, or 0 to spread @a count frames over the duration
+ * @param [in] count The number of frames, or 0 for every @a interval up to the end
+ * @param [in] tile_width The width of a tile in pixels
+ * @param [in] tile_height The height of a tile in pixels
+ * @param [in] is_accurate @c true to decode the exact frames, @c false to decode the keyframes before them
+ * @param [out] sheet The sheet in RGB888
+ * @param [out] width The width of @a sheet
+ * @param [out] height The height of @a sheet
+ * @param [out] tiles The position to tile map
+ * @param [out] tile_count The number of entries of @a tiles
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or the sheet would be larger than 2 GiB
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_get_frame_at_time()
+ */
+int metadata_extractor_get_sprite_sheet(metadata_extractor_h metadata, unsigned long interval, int count, int tile_width, int tile_height, bool is_accurate, void **sheet, int *width, int *height, metadata_extractor_sprite_tile_s **tiles, int *tile_count);
+
+
 /**
  * @brief Get synclyric of media file
  *
- * @remarks @a lyrics must be released with @c free() by you
+ * @remarks @a lyrics must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
  *
  * @param [in] metadata The handle to metadata
  * @param [in] index Index of time/lyrics set
@@ -161,7 +366,7 @@ int metadata_extractor_get_synclyrics(metadata_extractor_h metadata, int index,
 /**
  * @brief Get a frame of video media
  *
- * @remarks @a frame must be released with @c free() by you
+ * @remarks @a frame must be released with @c free() by you, or with the callback set by metadata_extractor_set_allocator(), unless arena mode is enabled
  *
  * @param [in] metadata The handle to metadata
  * @param [in] timestamp The timestamp in milliseconds
@@ -180,6 +385,796 @@ int metadata_extractor_get_synclyrics(metadata_extractor_h metadata, int index,
 
 int metadata_extractor_get_frame_at_time(metadata_extractor_h metadata, unsigned long timestamp, bool is_accurate, void **frame, int *size);
 
+/**
+ * @brief Serialize all attributes of metadata into one binary record
+ *
+ * @remarks The record is a versioned, length-prefixed, little-endian byte string holding the path, every attribute
+ * at a fixed offset and a table of null-terminated strings. It has no pointers, so it can be copied to shared memory,
+ * a socket or a file and read in place with metadata_extractor_record_get_int(), metadata_extractor_record_get_double()
+ * and metadata_extractor_record_get_string().\n
+ * @a record is released like the result of metadata_extractor_get_metadata().
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [out] record The serialized record
+ * @param [out] size The size of @a record
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @pre Set path to extract by calling metadata_extractor_set_path()
+ * @see metadata_extractor_record_validate()
+ */
+int metadata_extractor_serialize(metadata_extractor_h metadata, void **record, size_t *size);
+
+/**
+ * @brief Check that a serialized record is well formed
+ *
+ * @remarks Call this once on a record from an untrusted source before reading it. The other record functions
+ * do no bounds checks of their own, so that reading an attribute costs a few loads.
+ *
+ * @param [in] record The serialized record
+ * @param [in] size The size of @a record
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or the record is malformed or of an unknown version
+ * @see metadata_extractor_serialize()
+ */
+int metadata_extractor_record_validate(const void *record, size_t size);
+
+/**
+ * @brief Read an integer attribute of a serialized record
+ *
+ * @remarks Integer attributes are #METADATA_DURATION to #METADATA_HAS_AUDIO and #METADATA_SYNCLYRICS_NUM.
+ *
+ * @param [in] record The serialized record
+ * @param [in] attribute The attribute to read
+ * @param [out] value The value of the attribute
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute is not an integer
+ * @pre Validate the record by calling metadata_extractor_record_validate()
+ */
+int metadata_extractor_record_get_int(const void *record, metadata_extractor_attr_e attribute, int *value);
+
+/**
+ * @brief Read a floating point attribute of a serialized record
+ *
+ * @remarks Floating point attributes are #METADATA_LONGITUDE, #METADATA_LATITUDE and #METADATA_ALTITUDE.
+ *
+ * @param [in] record The serialized record
+ * @param [in] attribute The attribute to read
+ * @param [out] value The value of the attribute
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute is not a floating point value
+ * @pre Validate the record by calling metadata_extractor_record_validate()
+ */
+int metadata_extractor_record_get_double(const void *record, metadata_extractor_attr_e attribute, double *value);
+
+/**
+ * @brief Read a string attribute of a serialized record
+ *
+ * @remarks @a value points into @a record and must not be released. It is NULL when the attribute has no value.
+ *
+ * @param [in] record The serialized record
+ * @param [in] attribute The attribute to read
+ * @param [out] value The null-terminated value of the attribute
+ * @param [out] length The length of @a value without the terminating null, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute is not a string
+ * @pre Validate the record by calling metadata_extractor_record_validate()
+ */
+int metadata_extractor_record_get_string(const void *record, metadata_extractor_attr_e attribute, const char **value, int *length);
+
+/**
+ * @brief Read the path of a serialized record
+ *
+ * @remarks @a path points into @a record and must not be released.
+ *
+ * @param [in] record The serialized record
+ * @param [out] path The null-terminated path the record was extracted from
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Validate the record by calling metadata_extractor_record_validate()
+ */
+int metadata_extractor_record_get_path(const void *record, const char **path);
+
+/**
+ * @brief Create an empty columnar batch
+ *
+ * @remarks A batch holds one row per file and one column per attribute, laid out like the Arrow columnar format:
+ * integer and floating point columns are contiguous 64 byte aligned arrays, string columns are (row count + 1) offsets
+ * into one data buffer, and every column has an LSB-first validity bitmap. Rows are added by metadata_extractor_batch_extract().\n
+ * @a batch must be released with metadata_extractor_batch_destroy() by you.
+ *
+ * @param [out] batch The batch handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @see metadata_extractor_batch_destroy()
+ */
+int metadata_extractor_batch_create(metadata_extractor_batch_h *batch);
+
+/**
+ * @brief Remove all rows of a batch
+ *
+ * @remarks The buffers are kept, so that the batch can be filled again without allocating.
+ * Column pointers obtained before stay valid until the next metadata_extractor_batch_extract().
+ *
+ * @param [in] batch The batch handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int metadata_extractor_batch_clear(metadata_extractor_batch_h batch);
+
+/**
+ * @brief Destroy a batch and release all its buffers
+ *
+ * @param [in] batch The batch handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see metadata_extractor_batch_create()
+ */
+int metadata_extractor_batch_destroy(metadata_extractor_batch_h batch);
+
+/**
+ * @brief Extract many files into a batch
+ *
+ * @remarks One row is appended per path, in order. A file that can not be extracted still gets its row,
+ * with a path and no value in any other column.\n
+ * @a metadata is used for every file and is left set to the last path.
+ * Column pointers obtained before the call are invalid after it.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] paths The paths of the files
+ * @param [in] count The number of @a paths
+ * @param [in] batch The batch to append to
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available, the rows appended so far are kept
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_batch_create(), metadata_extractor_set_prefetch_depth()
+ */
+int metadata_extractor_batch_extract(metadata_extractor_h metadata, const char **paths, int count, metadata_extractor_batch_h batch);
+
+/**
+ * @brief Get the number of rows of a batch
+ *
+ * @param [in] batch The batch handle
+ * @param [out] row_count The number of rows
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int metadata_extractor_batch_get_row_count(metadata_extractor_batch_h batch, int *row_count);
+
+/**
+ * @brief Get an integer column of a batch
+ *
+ * @remarks @a values and @a validity belong to @a batch and must not be released.
+ * A row without a value holds 0 in @a values, so that the array can be summed without reading @a validity.
+ *
+ * @param [in] batch The batch handle
+ * @param [in] attribute An integer attribute, see metadata_extractor_record_get_int()
+ * @param [out] values One value per row
+ * @param [out] validity Bit n (of byte n / 8, least significant first) is set when row n has a value, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute is not an integer
+ */
+int metadata_extractor_batch_get_int_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const int **values, const unsigned char **validity);
+
+/**
+ * @brief Get a floating point column of a batch
+ *
+ * @remarks @a values and @a validity belong to @a batch and must not be released.
+ * A row without a value holds 0 in @a values.
+ *
+ * @param [in] batch The batch handle
+ * @param [in] attribute A floating point attribute, see metadata_extractor_record_get_double()
+ * @param [out] values One value per row
+ * @param [out] validity Bit n (of byte n / 8, least significant first) is set when row n has a value, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute is not a floating point value
+ */
+int metadata_extractor_batch_get_double_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const double **values, const unsigned char **validity);
+
+/**
+ * @brief Get a string column of a batch
+ *
+ * @remarks The value of row n is the @a offsets[n + 1] - @a offsets[n] bytes at @a data + @a offsets[n].
+ * Values are not null-terminated. A row without a value has an empty range.
+ * A column with an intern table set has empty ranges only, read it with metadata_extractor_batch_get_id_column().\n
+ * @a offsets, @a data and @a validity belong to @a batch and must not be released.
+ *
+ * @param [in] batch The batch handle
+ * @param [in] attribute A string attribute, see metadata_extractor_record_get_string()
+ * @param [out] offsets The row count + 1 offsets into @a data
+ * @param [out] data The bytes of all values
+ * @param [out] validity Bit n (of byte n / 8, least significant first) is set when row n has a value, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute is not a string
+ */
+int metadata_extractor_batch_get_string_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const int **offsets, const char **data, const unsigned char **validity);
+
+/**
+ * @brief Store a string attribute of a batch as ids of an intern table
+ *
+ * @remarks Each value is added to @a intern and the row keeps its id, so that a value repeated over many files
+ * is stored once and rows can be grouped by comparing integers. One table can serve several attributes and batches.\n
+ * @a intern must stay alive while the batch is in use. Pass NULL to store the attribute as strings again.
+ *
+ * @param [in] batch The batch handle, without rows
+ * @param [in] attribute A string attribute, for example #METADATA_ARTIST, #METADATA_ALBUM or #METADATA_GENRE
+ * @param [in] intern The intern table, or NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, @a attribute is not a string or the batch has rows
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @see metadata_extractor_intern_create(), metadata_extractor_batch_get_id_column()
+ */
+int metadata_extractor_batch_set_intern(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, metadata_extractor_intern_h intern);
+
+/**
+ * @brief Get the intern ids of a string attribute of a batch
+ *
+ * @remarks The ids index the dictionary of metadata_extractor_intern_get_dictionary(). A row without a value has id -1.\n
+ * @a ids and @a validity belong to @a batch and must not be released.
+ *
+ * @param [in] batch The batch handle
+ * @param [in] attribute A string attribute with an intern table set
+ * @param [out] ids One id per row
+ * @param [out] validity Bit n (of byte n / 8, least significant first) is set when row n has a value, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a attribute has no intern table
+ * @see metadata_extractor_batch_set_intern()
+ */
+int metadata_extractor_batch_get_id_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const int **ids, const unsigned char **validity);
+
+/**
+ * @brief Get the path column of a batch
+ *
+ * @remarks The column is laid out like a string column and has a value in every row.
+ *
+ * @param [in] batch The batch handle
+ * @param [out] offsets The row count + 1 offsets into @a data
+ * @param [out] data The bytes of all paths
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see metadata_extractor_batch_get_string_column()
+ */
+int metadata_extractor_batch_get_path_column(metadata_extractor_batch_h batch, const int **offsets, const char **data);
+
+/**
+ * @brief Keep the artwork of the files extracted into a batch
+ *
+ * @remarks With artwork enabled, metadata_extractor_batch_extract() stores the digest of the artwork of every row,
+ * as metadata_extractor_get_artwork_digest() computes it, and copies each distinct artwork into the batch once:
+ * the tracks of an album that share a cover all refer to one copy.
+ * metadata_extractor_batch_clear() drops the stored artwork along with the rows.
+ *
+ * @param [in] batch The batch handle, without rows
+ * @param [in] enable @a true to keep artwork, @a false otherwise (default)
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or the batch has rows
+ * @see metadata_extractor_batch_get_artwork_column(), metadata_extractor_batch_get_artwork()
+ */
+int metadata_extractor_batch_set_artwork_enabled(metadata_extractor_batch_h batch, bool enable);
+
+/**
+ * @brief Get the artwork digest column of a batch
+ *
+ * @remarks Rows without artwork, or extracted with artwork disabled, have no value and a digest of 0.\n
+ * @a digests and @a validity belong to @a batch and must not be released.
+ *
+ * @param [in] batch The batch handle
+ * @param [out] digests The artwork digest per row
+ * @param [out] validity The validity bitmap, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see metadata_extractor_batch_set_artwork_enabled(), metadata_extractor_batch_get_artwork()
+ */
+int metadata_extractor_batch_get_artwork_column(metadata_extractor_batch_h batch, const unsigned long long **digests, const unsigned char **validity);
+
+/**
+ * @brief Get the number of distinct artworks stored in a batch
+ *
+ * @param [in] batch The batch handle
+ * @param [out] artwork_count The number of distinct artworks
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see metadata_extractor_batch_set_artwork_enabled()
+ */
+int metadata_extractor_batch_get_artwork_count(metadata_extractor_batch_h batch, int *artwork_count);
+
+/**
+ * @brief Get an artwork stored in a batch by its digest
+ *
+ * @remarks @a artwork and @a mime_type belong to @a batch and must not be released. They stay valid until
+ * the batch is cleared or destroyed.
+ * If no row of the batch has the artwork, @a artwork and @a mime_type are NULL and @a size is 0.
+ * @a mime_type is also NULL for an artwork whose file gives no mime type for it.
+ *
+ * @param [in] batch The batch handle
+ * @param [in] digest The digest from the artwork column
+ * @param [out] artwork The artwork
+ * @param [out] size The artwork size
+ * @param [out] mime_type The mime type of artwork, NULL if unknown
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see metadata_extractor_batch_get_artwork_column()
+ */
+int metadata_extractor_batch_get_artwork(metadata_extractor_batch_h batch, unsigned long long digest, const void **artwork, int *size, const char **mime_type);
+
+/**
+ * @brief Create an empty string intern table
+ *
+ * @remarks The table keeps one copy of each distinct string and gives it an id, counting up from 0.
+ * All functions of the table may be called from several threads at once.\n
+ * @a intern must be released with metadata_extractor_intern_destroy() by you.
+ *
+ * @param [out] intern The intern table handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @see metadata_extractor_intern_destroy()
+ */
+int metadata_extractor_intern_create(metadata_extractor_intern_h *intern);
+
+/**
+ * @brief Destroy an intern table and all its strings
+ *
+ * @param [in] intern The intern table handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see metadata_extractor_intern_create()
+ */
+int metadata_extractor_intern_destroy(metadata_extractor_intern_h intern);
+
+/**
+ * @brief Add a string to an intern table
+ *
+ * @remarks A string already in the table gets its existing id.
+ *
+ * @param [in] intern The intern table handle
+ * @param [in] value The string
+ * @param [in] length The length of @a value, or -1 when it is null-terminated
+ * @param [out] id The id of the string
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ */
+int metadata_extractor_intern_add(metadata_extractor_intern_h intern, const char *value, int length, int *id);
+
+/**
+ * @brief Get the string of an id
+ *
+ * @remarks @a value is null-terminated, belongs to @a intern and stays at the same address until the table is destroyed.
+ *
+ * @param [in] intern The intern table handle
+ * @param [in] id The id of the string
+ * @param [out] value The string
+ * @param [out] length The length of @a value, may be NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a id is not in the table
+ */
+int metadata_extractor_intern_get_string(metadata_extractor_intern_h intern, int id, const char **value, int *length);
+
+/**
+ * @brief Get the number of strings of an intern table
+ *
+ * @param [in] intern The intern table handle
+ * @param [out] count The number of strings
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int metadata_extractor_intern_get_count(metadata_extractor_intern_h intern, int *count);
+
+/**
+ * @brief Get all strings of an intern table as one dictionary
+ *
+ * @remarks The dictionary is laid out like a batch string column, indexed by id: the string of id n is the
+ * @a offsets[n + 1] - @a offsets[n] bytes at @a data + @a offsets[n], without terminator.\n
+ * @a offsets and @a data belong to @a intern and stay valid until the next call of this function for a table with new strings.
+ *
+ * @param [in] intern The intern table handle
+ * @param [out] offsets The @a count + 1 offsets into @a data
+ * @param [out] data The bytes of all strings
+ * @param [out] count The number of strings
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @see metadata_extractor_batch_get_string_column()
+ */
+int metadata_extractor_intern_get_dictionary(metadata_extractor_intern_h intern, const int **offsets, const char **data, int *count);
+
+/**
+ * @brief Create a rescan journal, loading it from a file written by metadata_extractor_journal_save()
+ *
+ * @remarks The journal remembers the inode, size and modification time of every file seen by a scan,
+ * so that a rescan extracts only what changed. A missing or damaged file gives an empty journal.\n
+ * The file is a machine-local cache in host byte order. A journal must not be used from several threads at once.\n
+ * The @a journal must be released with metadata_extractor_journal_destroy() by you.
+ *
+ * @param [in] path The path of the journal file
+ * @param [out] journal The journal handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @see metadata_extractor_journal_scan(), metadata_extractor_journal_save(), metadata_extractor_journal_destroy()
+ */
+int metadata_extractor_journal_create(const char *path, metadata_extractor_journal_h *journal);
+
+/**
+ * @brief Scan a directory tree and report the files that differ from the journal
+ *
+ * @remarks Regular files under @a root are listed without following symbolic links and stat()ed from @a threads threads.
+ * @a callback is then called on the calling thread for every file that is new or whose inode, size or modification time changed,
+ * and for every file of the journal under @a root that is gone. Unchanged files are not reported.\n
+ * A file reported as new or changed is already in the journal with its digest reset to 0, so @a callback may
+ * call metadata_extractor_journal_set_digest() for it. No other journal function may be called from @a callback.\n
+ * Changes are kept in memory until metadata_extractor_journal_save().
+ *
+ * @param [in] journal The journal handle
+ * @param [in] root The directory to scan
+ * @param [in] threads The number of threads to stat files with, 1 to stat them on the calling thread
+ * @param [in] callback The callback function to invoke
+ * @param [in] user_data The user data passed to the callback function
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @pre Create a journal handle by calling metadata_extractor_journal_create()
+ * @post metadata_extractor_journal_cb() will be invoked
+ * @see metadata_extractor_journal_set_digest()
+ */
+int metadata_extractor_journal_scan(metadata_extractor_journal_h journal, const char *root, int threads, metadata_extractor_journal_cb callback, void *user_data);
+
+/**
+ * @brief Store a digest of the extraction result of a file in the journal
+ *
+ * @remarks The digest is an opaque value chosen by the caller, for example a hash of the record written for the file.
+ * It is saved with the journal and reset to 0 when a scan finds the file changed.
+ *
+ * @param [in] journal The journal handle
+ * @param [in] path The path of the file, as reported by metadata_extractor_journal_scan()
+ * @param [in] digest The digest to store
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a path is not in the journal
+ * @see metadata_extractor_journal_get_digest()
+ */
+int metadata_extractor_journal_set_digest(metadata_extractor_journal_h journal, const char *path, unsigned long long digest);
+
+/**
+ * @brief Get the digest stored for a file in the journal
+ *
+ * @param [in] journal The journal handle
+ * @param [in] path The path of the file
+ * @param [out] digest The stored digest, 0 if none was stored since the file last changed
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a path is not in the journal
+ * @see metadata_extractor_journal_set_digest()
+ */
+int metadata_extractor_journal_get_digest(metadata_extractor_journal_h journal, const char *path, unsigned long long *digest);
+
+/**
+ * @brief Write a journal to the file it was created with
+ *
+ * @remarks The journal is written to a temporary file and renamed over the old one, so a crash never leaves a partial journal.
+ *
+ * @param [in] journal The journal handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @see metadata_extractor_journal_create()
+ */
+int metadata_extractor_journal_save(metadata_extractor_journal_h journal);
+
+/**
+ * @brief Destroy a journal without saving it
+ *
+ * @param [in] journal The journal handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Create a journal handle by calling metadata_extractor_journal_create()
+ */
+int metadata_extractor_journal_destroy(metadata_extractor_journal_h journal);
+
+/**
+ * @brief Create a watcher that keeps an index of the media under a directory up to date
+ *
+ * @remarks The watcher thread extracts every file under @a root into an in-memory index of serialized records, then follows
+ * the tree with inotify. A file is extracted again once it has been closed after writing, or moved in, and has not been
+ * written for @a debounce_ms, so a file copied in chunks is extracted once. Files that can not be extracted are not indexed.
+
+ * @a callback is called on the watcher thread after each change of the index; it may call metadata_extractor_watcher_get_record().\n
+ * The @a watcher must be released with metadata_extractor_watcher_destroy() by you.
+ *
+ * @param [in] root The absolute path of the directory to watch
+ * @param [in] debounce_ms The time in milliseconds a file must stay unwritten before it is extracted
+ * @param [in] callback The callback function to invoke
+ * @param [in] user_data The user data passed to the callback function
+ * @param [out] watcher The watcher handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or @a root is not a directory
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @post metadata_extractor_watcher_cb() will be invoked
+ * @see metadata_extractor_watcher_get_record(), metadata_extractor_watcher_destroy()
+ */
+int metadata_extractor_watcher_create(const char *root, int debounce_ms, metadata_extractor_watcher_cb callback, void *user_data, metadata_extractor_watcher_h *watcher);
+
+/**
+ * @brief Stop a watcher and release its index
+ *
+ * @remarks Must not be called from metadata_extractor_watcher_cb().
+ *
+ * @param [in] watcher The watcher handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Create a watcher handle by calling metadata_extractor_watcher_create()
+ */
+int metadata_extractor_watcher_destroy(metadata_extractor_watcher_h watcher);
+
+/**
+ * @brief Get a copy of the indexed record of a file
+ *
+ * @remarks @a record is NULL and @a size 0 when the file is not indexed (yet).
+ * Otherwise @a record is a copy made with @c malloc(), to be released with @c free() by you.\n
+ * The record is read with metadata_extractor_record_get_int() and the other record functions.
+ *
+ * @param [in] watcher The watcher handle
+ * @param [in] path The path of the file
+ * @param [out] record The serialized record
+ * @param [out] size The size of @a record
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @see metadata_extractor_serialize()
+ */
+int metadata_extractor_watcher_get_record(metadata_extractor_watcher_h watcher, const char *path, void **record, size_t *size);
+
+/**
+ * @brief Get the number of files in the index of a watcher
+ *
+ * @param [in] watcher The watcher handle
+ * @param [out] count The number of indexed files
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int metadata_extractor_watcher_get_count(metadata_extractor_watcher_h watcher, int *count);
+
+/**
+ * @brief Enable or disable phase timing of metadata
+ *
+ * @remarks Statistics are disabled by default and cost nothing while disabled.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] enable @a true to collect statistics, @a false to stop collecting
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_get_stats()
+ */
+int metadata_extractor_set_stats_enabled(metadata_extractor_h metadata, bool enable);
+
+/**
+ * @brief Enable or disable arena mode of metadata
+ *
+ * @remarks In arena mode every value, artwork, mime type, frame and lyric returned for the current path is
+ * carved from one per-handle buffer. Such results must not be released with @c free(); they stay valid until the next
+ * metadata_extractor_set_path() or metadata_extractor_destroy(), which release them all at once.\n
+ * Arena mode is disabled by default. Results returned before it is disabled stay owned by the handle.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] enable @a true to return results from the arena, @a false to return results allocated one by one
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_set_path(), metadata_extractor_destroy()
+ */
+int metadata_extractor_set_arena_enabled(metadata_extractor_h metadata, bool enable);
+
+/**
+ * @brief Set how metadata reads its file
+ *
+ * @remarks In the mmap source modes the file is mapped once, on the first call that needs it, and the content and tag parsers
+ * and metadata_extractor_get_frame_at_time() read from the mapping instead of issuing their own small reads.
+ * #METADATA_EXTRACTOR_SOURCE_MMAP_SEQUENTIAL suits files read through once, #METADATA_EXTRACTOR_SOURCE_MMAP_RANDOM large
+ * files whose index sits far from the start, such as MP4 with the moov atom at the end or Matroska cues.\n
+ * Files that can not be mapped, files of 4 GiB or more and containers the memory parsers do not know are read by path, and so is a file the memory parsers fail on.
+ * The mode applies from the next metadata_extractor_set_path(); the default is #METADATA_EXTRACTOR_SOURCE_PATH.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] source The source mode
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_set_path()
+ */
+int metadata_extractor_set_source(metadata_extractor_h metadata, metadata_extractor_source_e source);
+
+/**
+ * @brief Set how many files metadata_extractor_batch_extract() reads ahead
+ *
+ * @remarks With a depth above 0, batch extraction starts up to @a depth threads (at most 16) that open the next
+ * @a depth files and read their first and last 256 KiB into the page cache while the current file is parsed,
+ * so that the parser does not wait on a cold disk for each of its reads in turn. This pays off on rotating disks,
+ * eMMC and network storage; on a warm cache it only costs the threads.\n
+ * Prefetch is disabled (depth 0) by default.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] depth The number of files to read ahead, 0 to disable prefetch
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_batch_extract()
+ */
+int metadata_extractor_set_prefetch_depth(metadata_extractor_h metadata, int depth);
+
+/**
+ * @brief Set the directory metadata_extractor_get_waveform() keeps its results in
+ *
+ * @remarks Every waveform computed while a directory is set is written to a file in it named after a hash of the media path and the bucket count,
+ * and read back by later calls for the same file and bucket count while the inode, size and modification time of the file stay the same.
+ * The directory must exist; a cache file that cannot be read or written is skipped. The files are in host byte order.\n
+ * No directory is set by default. Pass NULL to stop caching.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] path The cache directory, or NULL
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_get_waveform()
+ */
+int metadata_extractor_set_waveform_cache(metadata_extractor_h metadata, const char *path);
+
+/**
+ * @brief Set the allocator of buffers returned by metadata
+ *
+ * @remarks Every value, artwork, mime type, frame and lyric returned by the handle, and the arena of arena mode,
+ * is allocated with @a malloc_cb. Results returned while an allocator is set must be released with @a free_cb
+ * instead of @c free(). Pass NULL for all three callbacks to go back to the C library allocator.\n
+ * Setting the allocator releases the arena, so results returned in arena mode become invalid.
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [in] malloc_cb The callback to allocate a buffer
+ * @param [in] realloc_cb The callback to resize a buffer
+ * @param [in] free_cb The callback to release a buffer
+ * @param [in] user_data The user data passed to the callbacks
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter, or only some of the callbacks are set
+ * @pre Create metadata handle by calling metadata_extractor_create()
+ * @see metadata_extractor_set_arena_enabled()
+ */
+int metadata_extractor_set_allocator(metadata_extractor_h metadata, metadata_extractor_malloc_cb malloc_cb, metadata_extractor_realloc_cb realloc_cb, metadata_extractor_free_cb free_cb, void *user_data);
+
+/**
+ * @brief Get phase timing and counters of metadata
+ *
+ * @remarks Statistics cover the calls made since the last metadata_extractor_set_path().
+ *
+ * @param [in] metadata The handle to metadata
+ * @param [out] stats The statistics of the handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @pre Enable statistics by calling metadata_extractor_set_stats_enabled()
+ * @see metadata_extractor_set_stats_enabled()
+ */
+int metadata_extractor_get_stats(metadata_extractor_h metadata, metadata_extractor_stats_s *stats);
+
+/**
+ * @brief Dump process-wide metrics in Prometheus text format
+ *
+ * @remarks Metrics aggregate every handle in the process: extractions, failures by error,
+ * calls served from an already extracted handle, waveforms read from the waveform cache and latency histograms per API.\n
+ * @a length is always set to the length of the full snapshot without the terminating null,
+ * so a call with @a buffer NULL and @a size 0 returns the size to allocate.
+ *
+ * @param [out] buffer The buffer to write the null-terminated snapshot to
+ * @param [in] size The size of @a buffer
+ * @param [out] length The length of the snapshot
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY @a buffer is too small or not enough memory is available
+ * @see metadata_extractor_metrics_dump_to_file(), metadata_extractor_metrics_reset()
+ */
+int metadata_extractor_metrics_dump(char *buffer, int size, int *length);
+
+/**
+ * @brief Dump process-wide metrics in Prometheus text format to a file
+ *
+ * @remarks The snapshot is written to a uniquely named temporary file next to @a path and renamed over it, so readers never see a partial file.
+ *
+ * @param [in] path The path of the file to write
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @see metadata_extractor_metrics_dump()
+ */
+int metadata_extractor_metrics_dump_to_file(const char *path);
+
+/**
+ * @brief Reset process-wide metrics
+ *
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @see metadata_extractor_metrics_dump()
+ */
+int metadata_extractor_metrics_reset(void);
+
+/**
+ * @brief Enable or disable trace event recording
+ *
+ * @remarks Public calls and internal extraction phases are recorded per thread as Chrome trace events.\n
+ * Recording can also be enabled without code changes by setting the environment variable
+ * METADATA_EXTRACTOR_TRACE to a file path; the trace is then written to that path at process exit, or when the library is unloaded.
+ *
+ * @param [in] enable @a true to record events, @a false to stop recording
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @see metadata_extractor_trace_flush()
+ */
+int metadata_extractor_set_trace_enabled(bool enable);
+
+/**
+ * @brief Write recorded trace events as Chrome trace JSON
+ *
+ * @remarks The file can be opened with chrome://tracing or Perfetto. Events written are not written again by the next flush.\n
+ * Each thread keeps its most recent 2048 events. Events recorded while the flush runs may be missed.\n
+ * The events of exited threads are kept for the next flush, which then releases them; of more than 16 exited threads only the most recent are kept.
+ *
+ * @param [in] path The path of the file to write
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @see metadata_extractor_set_trace_enabled()
+ */
+int metadata_extractor_trace_flush(const char *path);
+
 /**
  * @}
  */
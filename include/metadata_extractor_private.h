@@ -19,26 +19,258 @@
 #define __TIZEN_MEDIA_METADATA_EXTRACTOR_PRIVATE_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
 #include <mm_types.h>
+#include <metadata_extractor_type.h>
 
 
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+/*
+ * Info and debug logs are compiled out unless the library is built with -DENABLE_DEBUG_LOG=ON
+ * (or as a Debug build). Error logs always stay in.
+ */
+#ifdef METADATA_EXTRACTOR_DEBUG_LOG
+#define metadata_extractor_info(fmt, arg...)		LOGI(fmt, ##arg)
+#define metadata_extractor_debug(fmt, arg...)		LOGD(fmt, ##arg)
+#else
+#define metadata_extractor_info(fmt, arg...)		do { } while (0)
+#define metadata_extractor_debug(fmt, arg...)		do { } while (0)
+#endif
+
+
+typedef struct
+{
+	metadata_extractor_malloc_cb malloc_cb;	/* all NULL means the C library allocator */
+	metadata_extractor_realloc_cb realloc_cb;
+	metadata_extractor_free_cb free_cb;
+	void *user_data;
+}metadata_extractor_allocator_s;
+
+typedef struct metadata_extractor_arena_chunk_s metadata_extractor_arena_chunk_s;
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	metadata_extractor_arena_chunk_s *chunk;
+	const metadata_extractor_allocator_s *allocator;	/* chunks come from here */
+}metadata_extractor_arena_s;
 
 typedef struct
 {
 	char *path;
-	bool extract_meta;
+	bool extract_meta;			/* set with release once attr_h/tag_h are ready, never cleared while readers run */
+	pthread_mutex_t extract_lock;	/* serializes the lazy extraction only */
 
 	int audio_track_cnt;
 	int video_track_cnt;
 
 	MMHandleType attr_h;
 	MMHandleType tag_h;
+	char *text[METADATA_RECDATE + 1];	/* normalized tag strings, NULL when the tag string is clean as it is */
+
+	bool stats_enabled;
+	metadata_extractor_stats_s stats;
+
+	metadata_extractor_allocator_s allocator;
+	bool arena_enabled;
+	metadata_extractor_arena_s arena;	/* results of the current path while arena_enabled */
+
+	int prefetch_depth;			/* files read ahead by metadata_extractor_batch_extract(), 0 for none */
+
+	metadata_extractor_source_e source;
+	void *map;					/* mapping of path in the mmap source modes, NULL when read by path */
+	size_t map_size;
+	int map_format;				/* container of the mapping for the mm-fileinfo memory parsers */
+	bool map_rejected;			/* the memory parsers refused the mapping, which is kept but parsed by path; under extract_lock */
+
+	char *waveform_cache;		/* directory waveforms are kept in, NULL for none */
 }metadata_extractor_s;
 
+typedef enum
+{
+	METADATA_EXTRACTOR_METRIC_GET_METADATA = 0,
+	METADATA_EXTRACTOR_METRIC_GET_ARTWORK,
+	METADATA_EXTRACTOR_METRIC_GET_FRAME,
+	METADATA_EXTRACTOR_METRIC_GET_FRAME_AT_TIME,
+	METADATA_EXTRACTOR_METRIC_GET_SYNCLYRICS,
+	METADATA_EXTRACTOR_METRIC_SERIALIZE,
+	METADATA_EXTRACTOR_METRIC_BATCH_EXTRACT,
+	METADATA_EXTRACTOR_METRIC_GET_ARTWORK_LOCATION,
+	METADATA_EXTRACTOR_METRIC_GET_ARTWORK_SCALED,
+	METADATA_EXTRACTOR_METRIC_GET_FINGERPRINT,
+	METADATA_EXTRACTOR_METRIC_GET_SPRITE_SHEET,
+	METADATA_EXTRACTOR_METRIC_GET_BEST_FRAME,
+	METADATA_EXTRACTOR_METRIC_GET_WAVEFORM,
+	METADATA_EXTRACTOR_METRIC_GET_ARTWORK_VIEW,
+	METADATA_EXTRACTOR_METRIC_GET_ARTWORK_DIGEST,
+	METADATA_EXTRACTOR_METRIC_API_MAX,
+}metadata_extractor_metric_api_e;
+
+unsigned long long __metadata_extractor_metrics_begin(void);
+void __metadata_extractor_metrics_end(metadata_extractor_metric_api_e api, unsigned long long begin, int error);
+void __metadata_extractor_metrics_extraction(int error);
+void __metadata_extractor_metrics_cache_hit(void);
+void __metadata_extractor_metrics_waveform_cache_hit(void);
+
+/*
+ * Serialized record (all little-endian, see metadata_extractor_serialize()):
+ *
+ *   0  uint32 magic "MXRC"
+ *   4  uint16 version
+ *   6  uint16 attribute count
+ *   8  uint32 total size of the record
+ *  12  uint32 presence bitmap, bit n set when attribute n has a value
+ *  16  uint32 path offset, uint32 path length
+ *  24  one 8 byte slot per attribute, in metadata_extractor_attr_e order:
+ *      int32 + 4 bytes padding, IEEE 754 double, or uint32 offset + uint32 length of a string
+ *  ..  string table, every string null-terminated so that it can be used in place
+ */
+#define METADATA_EXTRACTOR_RECORD_MAGIC			0x4352584d
+#define METADATA_EXTRACTOR_RECORD_VERSION		1
+#define METADATA_EXTRACTOR_RECORD_HEADER_SIZE	24
+#define METADATA_EXTRACTOR_RECORD_SLOT_SIZE		8
+#define METADATA_EXTRACTOR_RECORD_ATTR_COUNT	(METADATA_RECDATE + 1)
+
+typedef enum
+{
+	METADATA_EXTRACTOR_RECORD_INT = 0,
+	METADATA_EXTRACTOR_RECORD_DOUBLE,
+	METADATA_EXTRACTOR_RECORD_STRING,
+}metadata_extractor_record_type_e;
+
+typedef struct
+{
+	int i_value;
+	double d_value;
+	const char *s_value;	/* NULL when the attribute has no value */
+}metadata_extractor_record_value_s;
+
+metadata_extractor_record_type_e __metadata_extractor_record_attr_type(metadata_extractor_attr_e attribute);
+size_t __metadata_extractor_record_size(const char *path, const metadata_extractor_record_value_s *values);
+void __metadata_extractor_record_write(const char *path, const metadata_extractor_record_value_s *values, void *record, size_t size);
+
+/*
+ * Columnar batch, one row per file. Layout follows the Arrow columnar format so that the buffers can be
+ * handed over without a copy: fixed-width values in a 64 byte aligned array, strings as (row_count + 1)
+ * int offsets into one data buffer without terminators, and an LSB-first validity bitmap per column.
+ * Slots without a value hold 0, so numeric columns can be summed without looking at the bitmap.
+ * A string column with an intern table is dictionary encoded: it keeps the bitmap and empty offsets,
+ * and an int id per row (-1 without a value) into the table.
+ */
+#define METADATA_EXTRACTOR_BATCH_ALIGN		64
+
+typedef struct
+{
+	void *values;				/* int or double per row */
+	int *offsets;				/* strings only */
+	char *data;					/* strings only */
+	size_t data_size;
+	size_t data_capacity;
+	unsigned char *validity;
+	metadata_extractor_intern_h intern;	/* strings only: set when the column holds ids instead of data */
+	int *ids;
+}metadata_extractor_batch_column_s;
+
+/* one distinct artwork of a batch, however many rows carry it */
+typedef struct
+{
+	unsigned long long digest;
+	void *data;					/* NULL for an empty slot */
+	int size;
+	char *mime;
+}metadata_extractor_batch_artwork_s;
+
+typedef struct
+{
+	int row_count;
+	int capacity;
+	metadata_extractor_batch_column_s path;
+	metadata_extractor_batch_column_s columns[METADATA_EXTRACTOR_RECORD_ATTR_COUNT];
+	bool artwork_enabled;
+	metadata_extractor_batch_column_s artwork;	/* values: the unsigned long long digest per row */
+	metadata_extractor_batch_artwork_s *artworks;	/* open addressing by digest */
+	unsigned int artwork_mask;
+	int artwork_count;
+}metadata_extractor_batch_s;
+
+#define METADATA_EXTRACTOR_BATCH_IS_VALID(column, row)	(((column)->validity[(row) >> 3] >> ((row) & 7)) & 1)
+
+int __metadata_extractor_batch_append(metadata_extractor_batch_s *batch, const char *path, const metadata_extractor_record_value_s *values, const void *artwork, int artwork_size, const char *artwork_mime);
+
+int __metadata_extractor_text_normalize(const char *text, int length, char **normalized);
+
+unsigned long long __metadata_extractor_hash(const char *data, size_t length);
+
+typedef struct
+{
+	unsigned long long total;
+	unsigned long long v[4];
+	unsigned long long seed;
+	unsigned char buffer[32];
+	unsigned int buffered;
+}metadata_extractor_xxh64_s;
+
+void __metadata_extractor_xxh64_init(metadata_extractor_xxh64_s *state, unsigned long long seed);
+void __metadata_extractor_xxh64_update(metadata_extractor_xxh64_s *state, const void *data, size_t length);
+unsigned long long __metadata_extractor_xxh64_digest(const metadata_extractor_xxh64_s *state);
+unsigned long long __metadata_extractor_xxh64(const void *data, size_t length, unsigned long long seed);
+
+/* where an embedded picture is stored as plain bytes in the file, size 0 when it is not */
+#define METADATA_EXTRACTOR_ARTWORK_MIME_MAX	64
+
+typedef struct
+{
+	unsigned long long offset;
+	unsigned long long size;
+	char mime[METADATA_EXTRACTOR_ARTWORK_MIME_MAX];
+}metadata_extractor_artwork_location_s;
+
+int __metadata_extractor_artwork_locate(const char *path, metadata_extractor_artwork_location_s *location);
+
+typedef struct
+{
+	void *data;			/* malloc()ed */
+	size_t size;
+	int width;
+	int height;
+}metadata_extractor_image_s;
+
+int __metadata_extractor_scale_artwork(const void *artwork, size_t size, int max_dim, metadata_extractor_image_format_e format, metadata_extractor_image_s *image);
+int __metadata_extractor_scale_frame(const unsigned char *frame, int width, int height, unsigned char *slot, int max_width, int max_height, size_t stride);
+int __metadata_extractor_score_frame(const unsigned char *frame, int width, int height, double *score);
+
+int __metadata_extractor_mmap_format(const unsigned char *data, size_t size);
+int __metadata_extractor_mmap_open(const char *path, metadata_extractor_source_e source, void **map, size_t *size, int *format);
+void __metadata_extractor_mmap_close(void *map, size_t size);
+
+int __metadata_extractor_fingerprint_payload(const char *path, int *format, unsigned long long *digest);
+
+int __metadata_extractor_waveform(const char *path, int buckets, metadata_extractor_peak_s *peaks);
+bool __metadata_extractor_waveform_cache_load(const char *cache_dir, const char *path, int buckets, metadata_extractor_peak_s *peaks);
+void __metadata_extractor_waveform_cache_save(const char *cache_dir, const char *path, int buckets, const metadata_extractor_peak_s *peaks);
+
+typedef struct metadata_extractor_prefetch_s metadata_extractor_prefetch_s;
+
+metadata_extractor_prefetch_s *__metadata_extractor_prefetch_start(const char **paths, int count, int depth);
+void __metadata_extractor_prefetch_advance(metadata_extractor_prefetch_s *prefetch, int done);
+void __metadata_extractor_prefetch_stop(metadata_extractor_prefetch_s *prefetch);
+
+void *__metadata_extractor_allocator_malloc(const metadata_extractor_allocator_s *allocator, size_t size);
+void *__metadata_extractor_allocator_realloc(const metadata_extractor_allocator_s *allocator, void *ptr, size_t size);
+void __metadata_extractor_allocator_free(const metadata_extractor_allocator_s *allocator, void *ptr);
+
+void __metadata_extractor_arena_init(metadata_extractor_arena_s *arena, const metadata_extractor_allocator_s *allocator);
+void *__metadata_extractor_arena_alloc(metadata_extractor_arena_s *arena, size_t size);
+void __metadata_extractor_arena_reset(metadata_extractor_arena_s *arena);
+void __metadata_extractor_arena_release(metadata_extractor_arena_s *arena);
+
+unsigned long long __metadata_extractor_trace_begin(void);
+void __metadata_extractor_trace_end(const char *name, unsigned long long begin, const char *detail);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,170 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __TIZEN_MEDIA_METADATA_EXTRACTOR_SQLITE_H__
+#define __TIZEN_MEDIA_METADATA_EXTRACTOR_SQLITE_H__
+
+#include <metadata_extractor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @addtogroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @{
+ *
+ * @file metadata_extractor_sqlite.h
+ * @brief This file contains the SQLite sink of the metadata extractor. \n
+ *        The sink is built only when the library is configured with -DENABLE_SQLITE_SINK=ON. \n
+ *
+ * A sink writes extracted records into one table through prepared statements, many rows per transaction.
+ * Rows are keyed by path: a record replaces the row of its path only when the mtime differs.
+ * A sink must be used by one thread at a time.
+ */
+
+/**
+ * @brief The handle of SQLite sink
+ */
+typedef struct metadata_extractor_sqlite_s *metadata_extractor_sqlite_h;
+
+/**
+ * @brief The mapping of an attribute to a table column
+ */
+typedef struct
+{
+	metadata_extractor_attr_e attribute;	/**< Attribute to store */
+	const char *column;						/**< Column name, letters, digits and '_' only */
+} metadata_extractor_sqlite_column_s;
+
+/**
+ * @brief Open a database and create a sink writing to a table of it
+ *
+ * @remarks The table is created if it does not exist, with a "path" TEXT PRIMARY KEY, an "mtime" INTEGER and one column
+ * per mapping, typed INTEGER, REAL or TEXT after the attribute. An existing table must have a unique "path" column,
+ * an "mtime" column and the mapped columns.\n
+ * With @a columns NULL every attribute is stored, in a column named after it (for example "duration", "artist").\n
+ * @a sink must be released with metadata_extractor_sqlite_destroy() by you.
+ *
+ * @param [in] db_path The path of the database file
+ * @param [in] table The table name, letters, digits and '_' only
+ * @param [in] columns The attribute to column mapping, or NULL
+ * @param [in] column_count The number of @a columns
+ * @param [out] sink The sink handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY Not enough memory is available
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED The database can not be opened or the table does not match
+ * @see metadata_extractor_sqlite_destroy()
+ */
+int metadata_extractor_sqlite_create(const char *db_path, const char *table, const metadata_extractor_sqlite_column_s *columns, int column_count, metadata_extractor_sqlite_h *sink);
+
+/**
+ * @brief Set the number of rows written per transaction
+ *
+ * @remarks The default is 1000 rows.
+ *
+ * @param [in] sink The sink handle
+ * @param [in] rows The number of rows per transaction
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED The open transaction can not be committed
+ */
+int metadata_extractor_sqlite_set_batch_size(metadata_extractor_sqlite_h sink, int rows);
+
+/**
+ * @brief Check whether the table already holds a path with a given mtime
+ *
+ * @remarks Scanners call this before extracting a file, so that unchanged files are skipped.
+ *
+ * @param [in] sink The sink handle
+ * @param [in] path The path of the file
+ * @param [in] mtime The modification time of the file
+ * @param [out] is_current @a true when the row of @a path has @a mtime
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ */
+int metadata_extractor_sqlite_is_current(metadata_extractor_sqlite_h sink, const char *path, long long mtime, bool *is_current);
+
+/**
+ * @brief Write a serialized record into the table
+ *
+ * @remarks The row is inserted, or updated when the row of the same path has another mtime.
+ * It becomes durable when its transaction is committed, after the configured number of rows or by metadata_extractor_sqlite_flush().
+ *
+ * @param [in] sink The sink handle
+ * @param [in] record The record made by metadata_extractor_serialize()
+ * @param [in] mtime The modification time of the file
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ * @see metadata_extractor_serialize()
+ */
+int metadata_extractor_sqlite_write_record(metadata_extractor_sqlite_h sink, const void *record, long long mtime);
+
+/**
+ * @brief Write all rows of a batch into the table
+ *
+ * @remarks Each row is written like metadata_extractor_sqlite_write_record(). Rows of files that could not be extracted are skipped.
+ *
+ * @param [in] sink The sink handle
+ * @param [in] batch The batch filled by metadata_extractor_batch_extract()
+ * @param [in] mtimes The modification time of the file of each row
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail, the rows before the failing one are written
+ * @see metadata_extractor_batch_extract()
+ */
+int metadata_extractor_sqlite_write_batch(metadata_extractor_sqlite_h sink, metadata_extractor_batch_h batch, const long long *mtimes);
+
+/**
+ * @brief Commit the open transaction of the sink
+ *
+ * @param [in] sink The sink handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED Internal Operation Fail
+ */
+int metadata_extractor_sqlite_flush(metadata_extractor_sqlite_h sink);
+
+/**
+ * @brief Commit pending rows, close the database and release the sink
+ *
+ * @param [in] sink The sink handle
+ * @return 0 on success, otherwise a negative error value
+ * @retval #METADATA_EXTRACTOR_ERROR_NONE Successful
+ * @retval #METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #METADATA_EXTRACTOR_ERROR_OPERATION_FAILED The pending rows can not be committed
+ * @see metadata_extractor_sqlite_create()
+ */
+int metadata_extractor_sqlite_destroy(metadata_extractor_sqlite_h sink);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TIZEN_MEDIA_METADATA_EXTRACTOR_SQLITE_H__ */
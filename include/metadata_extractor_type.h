@@ -19,6 +19,7 @@
 #ifndef __TIZEN_MEDIA_METADATA_EXTRACTOR_TYPE_H__
 #define __TIZEN_MEDIA_METADATA_EXTRACTOR_TYPE_H__
 
+#include <stddef.h>
 #include <tizen.h>
 
 #ifdef __cplusplus
@@ -85,12 +86,178 @@ typedef enum
 } metadata_extractor_attr_e;
 
 
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The enumerations of how a handle reads its file
+ */
+typedef enum
+{
+	METADATA_EXTRACTOR_SOURCE_PATH = 0,			/**< The parsers open and read the file by path */
+	METADATA_EXTRACTOR_SOURCE_MMAP_SEQUENTIAL,	/**< The file is mapped once and read ahead aggressively, for scans through whole files */
+	METADATA_EXTRACTOR_SOURCE_MMAP_RANDOM,		/**< The file is mapped once without read-ahead, for index lookups in large files */
+} metadata_extractor_source_e;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The enumerations of image formats returned by the metadata extractor
+ */
+typedef enum
+{
+	METADATA_EXTRACTOR_IMAGE_FORMAT_RGB888 = 0,	/**< Raw pixels, 3 bytes per pixel, rows top to bottom without padding */
+	METADATA_EXTRACTOR_IMAGE_FORMAT_JPEG,		/**< A baseline JPEG file */
+} metadata_extractor_image_format_e;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The structure of per-handle phase timing and counters
+ * @remarks Times are in microseconds of monotonic clock. Counters are reset by metadata_extractor_set_path().
+ */
+typedef struct
+{
+	unsigned long long content_time;		/**< Time spent opening and probing the content */
+	unsigned long long content_attr_time;	/**< Time spent reading stream attributes */
+	unsigned long long tag_time;			/**< Time spent parsing tags */
+	unsigned long long artwork_time;		/**< Time spent fetching and copying artwork */
+	unsigned long long frame_time;			/**< Time spent decoding and copying frames */
+	unsigned int frame_count;				/**< Frames returned */
+	unsigned long long bytes_read;			/**< Bytes read from storage by the extracting thread */
+	unsigned int alloc_count;				/**< Buffers allocated for the caller */
+	unsigned long long alloc_size;			/**< Total size of buffers allocated for the caller */
+} metadata_extractor_stats_s;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The structure of a media fingerprint
+ * @remarks Two files are duplicates when both members are equal. Tags are left out of both, so copies that differ in their tags only compare equal.
+ * @see metadata_extractor_get_fingerprint()
+ */
+typedef struct
+{
+	unsigned long long params;		/**< Digest of the container format, the duration and the stream parameters */
+	unsigned long long payload;		/**< Digest of the audio and video payload */
+} metadata_extractor_fingerprint_s;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The structure of one bucket of a waveform overview
+ * @remarks Samples are in the range [-1, 1]; all channels of a bucket are folded together.
+ * @see metadata_extractor_get_waveform()
+ */
+typedef struct
+{
+	float min;		/**< The lowest sample of the bucket */
+	float max;		/**< The highest sample of the bucket */
+	float rms;		/**< The root mean square of the samples of the bucket */
+} metadata_extractor_peak_s;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The structure of one position of a sprite sheet
+ * @see metadata_extractor_get_sprite_sheet()
+ */
+typedef struct
+{
+	unsigned long timestamp;	/**< The position in the video, in milliseconds */
+	int x;						/**< The left edge of the tile of the position in the sheet, in pixels */
+	int y;						/**< The top edge of the tile of the position in the sheet, in pixels */
+} metadata_extractor_sprite_tile_s;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief Called to allocate a buffer returned by the metadata extractor
+ * @param[in] size The size to allocate
+ * @param[in] user_data The user data passed to metadata_extractor_set_allocator()
+ * @return The allocated buffer, or NULL on failure
+ * @see metadata_extractor_set_allocator()
+ */
+typedef void *(*metadata_extractor_malloc_cb)(size_t size, void *user_data);
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief Called to resize a buffer allocated by metadata_extractor_malloc_cb()
+ * @param[in] ptr The buffer to resize
+ * @param[in] size The new size
+ * @param[in] user_data The user data passed to metadata_extractor_set_allocator()
+ * @return The resized buffer, or NULL on failure
+ * @see metadata_extractor_set_allocator()
+ */
+typedef void *(*metadata_extractor_realloc_cb)(void *ptr, size_t size, void *user_data);
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief Called to release a buffer allocated by metadata_extractor_malloc_cb()
+ * @param[in] ptr The buffer to release
+ * @param[in] user_data The user data passed to metadata_extractor_set_allocator()
+ * @see metadata_extractor_set_allocator()
+ */
+typedef void (*metadata_extractor_free_cb)(void *ptr, void *user_data);
+
 /**
  * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
  * @brief The handle of metadata extractor
  */
 typedef struct metadata_extractor_s* metadata_extractor_h;
 
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The handle of a columnar batch of results, one row per file
+ * @see metadata_extractor_batch_create()
+ */
+typedef struct metadata_extractor_batch_s* metadata_extractor_batch_h;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The handle of a string intern table
+ * @see metadata_extractor_intern_create()
+ */
+typedef struct metadata_extractor_intern_s* metadata_extractor_intern_h;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The handle of a rescan journal
+ * @see metadata_extractor_journal_create()
+ */
+typedef struct metadata_extractor_journal_s* metadata_extractor_journal_h;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The enumerations of changes found by a journal scan or a watcher
+ */
+typedef enum
+{
+	METADATA_EXTRACTOR_JOURNAL_NEW = 0,		/**< The file is not in the journal or index */
+	METADATA_EXTRACTOR_JOURNAL_CHANGED,		/**< The file differs from the journal or index */
+	METADATA_EXTRACTOR_JOURNAL_DELETED,		/**< The file is in the journal or index but gone */
+} metadata_extractor_journal_change_e;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief Called for every file a journal scan finds new, changed or deleted
+ * @param[in] path The path of the file
+ * @param[in] change The kind of change
+ * @param[in] user_data The user data passed to metadata_extractor_journal_scan()
+ * @return @a true to record the change in the journal, @a false to leave the journal as it was so the next scan reports the file again
+ * @see metadata_extractor_journal_scan()
+ */
+typedef bool (*metadata_extractor_journal_cb)(const char *path, metadata_extractor_journal_change_e change, void *user_data);
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief The handle of a directory watcher
+ * @see metadata_extractor_watcher_create()
+ */
+typedef struct metadata_extractor_watcher_s* metadata_extractor_watcher_h;
+
+/**
+ * @ingroup CAPI_METADATA_EXTRACTOR_MODULE
+ * @brief Called on the watcher thread when the index of a watcher gains, updates or drops the record of a file
+ * @param[in] path The path of the file
+ * @param[in] change The kind of change
+ * @param[in] user_data The user data passed to metadata_extractor_watcher_create()
+ * @see metadata_extractor_watcher_create()
+ */
+typedef void (*metadata_extractor_watcher_cb)(const char *path, metadata_extractor_journal_change_e change, void *user_data);
+
 /**
  * @}
  */
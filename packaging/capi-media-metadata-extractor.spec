@@ -9,6 +9,9 @@ BuildRequires:  cmake
 BuildRequires:  pkgconfig(dlog)
 BuildRequires:  pkgconfig(mm-fileinfo)
 BuildRequires:  pkgconfig(capi-base-common)
+BuildRequires:  pkgconfig(libjpeg)
+BuildRequires:  pkgconfig(libpng)
+BuildRequires:  pkgconfig(sqlite3)
 Requires(post): /sbin/ldconfig
 Requires(postun): /sbin/ldconfig
 
@@ -29,7 +32,7 @@ A media metadata extractor  library in SLP C API
 
 %build
 MAJORVER=`echo %{version} | awk 'BEGIN {FS="."}{print $1}'`
-cmake . -DCMAKE_INSTALL_PREFIX=/usr -DFULLVER=%{version} -DMAJORVER=${MAJORVER}
+cmake . -DCMAKE_INSTALL_PREFIX=/usr -DFULLVER=%{version} -DMAJORVER=${MAJORVER} -DENABLE_SQLITE_SINK=ON
 
 
 make %{?jobs:-j%jobs}
@@ -45,6 +48,7 @@ rm -rf %{buildroot}
 
 %files
 /usr/lib/libcapi-media-metadata-extractor.so
+/usr/bin/metadata-extractor-dump
 
 %files devel
 /usr/include/media/*.h
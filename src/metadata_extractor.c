@@ -17,6 +17,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
 #include <mm_file.h>
 #include <mm_error.h>
 #include <dlog.h>
@@ -25,6 +30,11 @@
 
 #define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
 #define META_MAX_LEN	256
+#define SPRITE_MAX_TILES	1024
+#define BEST_FRAME_DEFAULT_BUDGET	5
+#define BEST_FRAME_MAX_BUDGET		32
+#define BEST_FRAME_GOOD_SCORE		9.0	/* detailed enough that decoding more is not worth it */
+#define WAVEFORM_MAX_BUCKETS	65536
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -66,34 +76,302 @@ static int __metadata_extractor_get_unsynclyrics(metadata_extractor_s *metadata,
 static int __metadata_extractor_get_recording_date(metadata_extractor_s *metadata, char **rec_date);
 static int __metadata_extractor_get_synclyrics_pair_num(metadata_extractor_s *metadata, int *synclyrics_num);
 static int __metadata_extractor_destroy_handle(metadata_extractor_s *metadata);
+static unsigned long long __metadata_extractor_get_time(void);
+static int __metadata_extractor_api_get_synclyrics(metadata_extractor_h metadata, int index, unsigned long *time_stamp, char **lyrics);
+static int __metadata_extractor_api_get_metadata(metadata_extractor_h metadata, metadata_extractor_attr_e attribute, char **value);
+static int __metadata_extractor_get_attr_value(metadata_extractor_s *metadata, metadata_extractor_attr_e attribute, int *i_value, double *d_value, char **s_value, int *is_string, int *is_double);
+static int __metadata_extractor_api_get_artwork(metadata_extractor_h metadata, void **artwork, int *size, char **mime_type);
+static int __metadata_extractor_api_get_artwork_view(metadata_extractor_h metadata, const void **artwork, int *size, const char **mime_type);
+static int __metadata_extractor_api_get_artwork_location(metadata_extractor_h metadata, long long *offset, int *size, char **mime_type);
+static int __metadata_extractor_api_get_artwork_digest(metadata_extractor_h metadata, unsigned long long *digest, int *size);
+static int __metadata_extractor_api_get_artwork_scaled(metadata_extractor_h metadata, int max_dim, metadata_extractor_image_format_e format, void **image, int *size, int *width, int *height);
+static int __metadata_extractor_api_get_frame(metadata_extractor_h metadata, void **frame, int *size);
+static int __metadata_extractor_api_get_frame_at_time(metadata_extractor_h metadata, unsigned long timestamp, bool is_accurate, void **frame, int *size);
+static int __metadata_extractor_api_get_sprite_sheet(metadata_extractor_h metadata, unsigned long interval, int count, int tile_width, int tile_height, bool is_accurate, void **sheet, int *width, int *height, metadata_extractor_sprite_tile_s **tiles, int *tile_count);
+static int __metadata_extractor_api_get_best_frame(metadata_extractor_h metadata, int budget, void **frame, int *size, unsigned long *timestamp);
+static int __metadata_extractor_api_get_fingerprint(metadata_extractor_h metadata, metadata_extractor_fingerprint_s *fingerprint);
+static int __metadata_extractor_api_get_waveform(metadata_extractor_h metadata, int buckets, metadata_extractor_peak_s **peaks);
+static int __metadata_extractor_api_serialize(metadata_extractor_h metadata, void **record, size_t *size);
+static int __metadata_extractor_api_batch_extract(metadata_extractor_h metadata, const char **paths, int count, metadata_extractor_batch_h batch);
+static int __metadata_extractor_get_values(metadata_extractor_s *metadata, metadata_extractor_record_value_s *values);
+static unsigned long long __metadata_extractor_get_read_bytes(void);
+static unsigned long long __metadata_extractor_stats_begin(metadata_extractor_s *metadata);
+static void __metadata_extractor_stats_end(metadata_extractor_s *metadata, unsigned long long *phase_time, unsigned long long begin);
+static void __metadata_extractor_stats_alloc(metadata_extractor_s *metadata, size_t size);
+static void *__metadata_extractor_alloc(metadata_extractor_s *metadata, size_t size);
+static char *__metadata_extractor_strdup(metadata_extractor_s *metadata, const char *str);
+static void __metadata_extractor_release(metadata_extractor_s *metadata, void *ptr);
+
+static unsigned long long __metadata_extractor_get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000ULL + (unsigned long long)(ts.tv_nsec / 1000);
+}
+
+/* rchar of the calling thread, i.e. bytes pulled through read()-like syscalls */
+static unsigned long long __metadata_extractor_get_read_bytes(void)
+{
+	char io_path[64] = {0, };
+	char line[128] = {0, };
+	unsigned long long rchar = 0;
+	FILE *fp = NULL;
+
+	snprintf(io_path, sizeof(io_path), "/proc/self/task/%ld/io", (long)syscall(SYS_gettid));
+
+	fp = fopen(io_path, "r");
+	if(fp == NULL)
+	{
+		return 0;
+	}
+
+	while(fgets(line, sizeof(line), fp) != NULL)
+	{
+		if(sscanf(line, "rchar: %llu", &rchar) == 1)
+		{
+			break;
+		}
+	}
+
+	fclose(fp);
+
+	return rchar;
+}
+
+static unsigned long long __metadata_extractor_stats_begin(metadata_extractor_s *metadata)
+{
+	if(!metadata->stats_enabled)
+	{
+		return 0;
+	}
+
+	return __metadata_extractor_get_time();
+}
+
+static void __metadata_extractor_stats_end(metadata_extractor_s *metadata, unsigned long long *phase_time, unsigned long long begin)
+{
+	if(!metadata->stats_enabled)
+	{
+		return;
+	}
+
+	__atomic_fetch_add(phase_time, __metadata_extractor_get_time() - begin, __ATOMIC_RELAXED);
+}
+
+static void __metadata_extractor_stats_alloc(metadata_extractor_s *metadata, size_t size)
+{
+	if(!metadata->stats_enabled)
+	{
+		return;
+	}
+
+	__atomic_fetch_add(&metadata->stats.alloc_count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&metadata->stats.alloc_size, size, __ATOMIC_RELAXED);
+}
+
+/* every buffer handed to the caller comes from here */
+static void *__metadata_extractor_alloc(metadata_extractor_s *metadata, size_t size)
+{
+	void *ptr = NULL;
+
+	if(metadata->arena_enabled)
+	{
+		ptr = __metadata_extractor_arena_alloc(&metadata->arena, size);
+	}
+	else
+	{
+		ptr = __metadata_extractor_allocator_malloc(&metadata->allocator, size);
+	}
+
+	if(ptr != NULL)
+	{
+		__metadata_extractor_stats_alloc(metadata, size);
+	}
+
+	return ptr;
+}
+
+static char *__metadata_extractor_strdup(metadata_extractor_s *metadata, const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *dup = (char *)__metadata_extractor_alloc(metadata, len);
+
+	if(dup != NULL)
+	{
+		memcpy(dup, str, len);
+	}
+
+	return dup;
+}
+
+/* for results dropped before they reach the caller; arena buffers go with the arena */
+static void __metadata_extractor_release(metadata_extractor_s *metadata, void *ptr)
+{
+	if(!metadata->arena_enabled)
+	{
+		__metadata_extractor_allocator_free(&metadata->allocator, ptr);
+	}
+}
+
+static const struct
+{
+	metadata_extractor_attr_e attribute;
+	const char *tag;
+} g_text_tag[] = {
+	{ METADATA_ARTIST, MM_FILE_TAG_ARTIST },
+	{ METADATA_TITLE, MM_FILE_TAG_TITLE },
+	{ METADATA_ALBUM, MM_FILE_TAG_ALBUM },
+	{ METADATA_GENRE, MM_FILE_TAG_GENRE },
+	{ METADATA_AUTHOR, MM_FILE_TAG_AUTHOR },
+	{ METADATA_COPYRIGHT, MM_FILE_TAG_COPYRIGHT },
+	{ METADATA_DATE, MM_FILE_TAG_DATE },
+	{ METADATA_DESCRIPTION, MM_FILE_TAG_DESCRIPTION },
+	{ METADATA_TRACK_NUM, MM_FILE_TAG_TRACK_NUM },
+	{ METADATA_CLASSIFICATION, MM_FILE_TAG_CLASSIFICATION },
+	{ METADATA_RATING, MM_FILE_TAG_RATING },
+	{ METADATA_CONDUCTOR, MM_FILE_TAG_CONDUCTOR },
+	{ METADATA_UNSYNCLYRICS, MM_FILE_TAG_UNSYNCLYRICS },
+	{ METADATA_RECDATE, MM_FILE_TAG_RECDATE },
+};
+
+/* every string attribute comes out as trimmed UTF-8; clean tag strings are used in place */
+static int __metadata_extractor_normalize_text(metadata_extractor_s *metadata)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned int idx = 0;
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	for(idx = 0; idx < sizeof(g_text_tag) / sizeof(g_text_tag[0]); idx++)
+	{
+		char *err_attr_name = NULL;
+		char *_text = NULL;
+		int _tag_len = 0;
+
+		if(mm_file_get_attrs(metadata->tag_h, &err_attr_name, g_text_tag[idx].tag, &_text, &_tag_len, NULL) != MM_ERROR_NONE)
+		{
+			/* the getter of the attribute reports it */
+			SAFE_FREE(err_attr_name);
+			continue;
+		}
+
+		if(_text == NULL)
+		{
+			continue;
+		}
+
+		ret = __metadata_extractor_text_normalize(_text, _tag_len, &metadata->text[g_text_tag[idx].attribute]);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			break;
+		}
+	}
+
+	__metadata_extractor_trace_end("normalize_text", trace_begin, NULL);
+
+	return ret;
+}
+
+/* maps the file in the mmap source modes, called with extract_lock held; without a mapping the parsers read by path */
+static void __metadata_extractor_map_source(metadata_extractor_s *metadata)
+{
+	if((metadata->source == METADATA_EXTRACTOR_SOURCE_PATH) || (metadata->map != NULL))
+	{
+		return;
+	}
+
+	if(__metadata_extractor_mmap_open(metadata->path, metadata->source, &metadata->map, &metadata->map_size, &metadata->map_format) != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		metadata_extractor_debug("[%s] reading [%s] by path \n", __FUNCTION__, metadata->path);
+		metadata->map = NULL;
+	}
+}
 
 static int __metadata_extractor_check_and_extract_meta(metadata_extractor_s *metadata)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long read_bytes = 0;
+	unsigned long long trace_begin = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	/* lock-free once the handle is extracted; the acquire pairs with the release below */
+	if(__atomic_load_n(&metadata->extract_meta, __ATOMIC_ACQUIRE))
+	{
+		metadata_extractor_info("[%s] metadata already extracted \n", __FUNCTION__);
+		__metadata_extractor_metrics_cache_hit();
+		return ret;
+	}
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	pthread_mutex_lock(&metadata->extract_lock);
 
 	if(metadata->extract_meta)
 	{
-		LOGI("[%s] metadata already extracted \n", __FUNCTION__);
+		/* another reader finished the extraction while we waited */
+		pthread_mutex_unlock(&metadata->extract_lock);
+		__metadata_extractor_metrics_cache_hit();
 		return ret;
 	}
 
+	if(metadata->stats_enabled)
+	{
+		read_bytes = __metadata_extractor_get_read_bytes();
+	}
+
+	trace_begin = __metadata_extractor_trace_begin();
+
+	__metadata_extractor_map_source(metadata);
+
 	ret = __metadata_extractor_create_content_attrs(metadata, metadata->path);
-	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
 	{
-		return ret;
+		ret = __metadata_extractor_create_tag_attr(metadata, metadata->path);
+	}
+	if((ret != METADATA_EXTRACTOR_ERROR_NONE) && (metadata->map != NULL) && (!metadata->map_rejected))
+	{
+		/*
+		 * The memory parsers take less than the path parsers, so parse by path once more. The mapping is only
+		 * left unused, not unmapped, as a frame may be decoded from it on another thread.
+		 */
+		metadata_extractor_debug("[%s] memory parsers failed, reading [%s] by path \n", __FUNCTION__, metadata->path);
+		__metadata_extractor_destroy_handle(metadata);
+		metadata->map_rejected = true;
+
+		ret = __metadata_extractor_create_content_attrs(metadata, metadata->path);
+		if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			ret = __metadata_extractor_create_tag_attr(metadata, metadata->path);
+		}
+	}
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		ret = __metadata_extractor_normalize_text(metadata);
+	}
+
+	__metadata_extractor_trace_end("check_and_extract_meta", trace_begin, metadata->path);
+
+	if(metadata->stats_enabled)
+	{
+		__atomic_fetch_add(&metadata->stats.bytes_read, __metadata_extractor_get_read_bytes() - read_bytes, __ATOMIC_RELAXED);
 	}
 
-	ret = __metadata_extractor_create_tag_attr(metadata, metadata->path);
+	__metadata_extractor_metrics_extraction(ret);
+
 	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
 	{
+		/* drop a half-built content handle so that the next call starts clean */
+		__metadata_extractor_destroy_handle(metadata);
+		pthread_mutex_unlock(&metadata->extract_lock);
 		return ret;
 	}
 
-	metadata->extract_meta = true;
+	__atomic_store_n(&metadata->extract_meta, true, __ATOMIC_RELEASE);
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	pthread_mutex_unlock(&metadata->extract_lock);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
@@ -106,10 +384,19 @@ static int __metadata_extractor_create_content_attrs(metadata_extractor_s *metad
 
 	int _audio_track_cnt = 0;
 	int _video_track_cnt = 0;
+	unsigned long long begin = 0;
+	unsigned long long trace_begin = 0;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
-	ret = mm_file_create_content_attrs(&content, path);
+	trace_begin = __metadata_extractor_trace_begin();
+	begin = __metadata_extractor_stats_begin(metadata);
+	if((metadata->map != NULL) && (!metadata->map_rejected))
+		ret = mm_file_create_content_attrs_from_memory(&content, metadata->map, metadata->map_size, metadata->map_format);
+	else
+		ret = mm_file_create_content_attrs(&content, path);
+	__metadata_extractor_stats_end(metadata, &metadata->stats.content_time, begin);
+	__metadata_extractor_trace_end("create_content_attrs", trace_begin, NULL);
 
 	if(ret != MM_ERROR_NONE)
 	{
@@ -125,10 +412,12 @@ static int __metadata_extractor_create_content_attrs(metadata_extractor_s *metad
 		}
 	}
 
+	begin = __metadata_extractor_stats_begin(metadata);
 	ret = mm_file_get_attrs(content, &err_attr_name,
 							MM_FILE_CONTENT_VIDEO_TRACK_COUNT, &_video_track_cnt,
 							MM_FILE_CONTENT_AUDIO_TRACK_COUNT, &_audio_track_cnt,
 							NULL);
+	__metadata_extractor_stats_end(metadata, &metadata->stats.content_attr_time, begin);
 
 	if(ret != MM_ERROR_NONE)
 	{
@@ -142,7 +431,7 @@ static int __metadata_extractor_create_content_attrs(metadata_extractor_s *metad
 	metadata->audio_track_cnt = _audio_track_cnt;
 	metadata->video_track_cnt = _video_track_cnt;
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 
@@ -153,9 +442,18 @@ static int __metadata_extractor_create_tag_attr(metadata_extractor_s *metadata,
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	MMHandleType tag = 0;
-
-	LOGI("[%s] enter \n", __FUNCTION__);
-	ret = mm_file_create_tag_attrs(&tag, path);
+	unsigned long long begin = 0;
+	unsigned long long trace_begin = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+	trace_begin = __metadata_extractor_trace_begin();
+	begin = __metadata_extractor_stats_begin(metadata);
+	if((metadata->map != NULL) && (!metadata->map_rejected))
+		ret = mm_file_create_tag_attrs_from_memory(&tag, metadata->map, metadata->map_size, metadata->map_format);
+	else
+		ret = mm_file_create_tag_attrs(&tag, path);
+	__metadata_extractor_stats_end(metadata, &metadata->stats.tag_time, begin);
+	__metadata_extractor_trace_end("create_tag_attrs", trace_begin, NULL);
 
 	if(ret != MM_ERROR_NONE)
 	{
@@ -173,7 +471,7 @@ static int __metadata_extractor_create_tag_attr(metadata_extractor_s *metadata,
 
 	metadata->tag_h= tag;
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 	return ret;
 
 }
@@ -870,8 +1168,14 @@ static int __metadata_extractor_get_synclyrics_pair_num(metadata_extractor_s *me
 static int __metadata_extractor_destroy_handle(metadata_extractor_s *metadata)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned int idx = 0;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	for(idx = 0; idx < sizeof(metadata->text) / sizeof(metadata->text[0]); idx++)
+	{
+		SAFE_FREE(metadata->text[idx]);
+	}
 
 	if(metadata->attr_h)
 	{
@@ -881,6 +1185,7 @@ static int __metadata_extractor_destroy_handle(metadata_extractor_s *metadata)
 			LOGE("[%s]ERROR_UNKNOWN(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED);
 			return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
 		}
+		metadata->attr_h = 0;
 	}
 
 	if(metadata->tag_h)
@@ -891,9 +1196,10 @@ static int __metadata_extractor_destroy_handle(metadata_extractor_s *metadata)
 			LOGE("[%s]ERROR_UNKNOWN(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED);
 			return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
 		}
+		metadata->tag_h = 0;
 	}
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
@@ -903,7 +1209,7 @@ int metadata_extractor_create(metadata_extractor_h *metadata)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
 	if(metadata == NULL)
 	{
@@ -922,10 +1228,15 @@ int metadata_extractor_create(metadata_extractor_h *metadata)
 	_metadata->extract_meta = false;
 	_metadata->audio_track_cnt = 0;
 	_metadata->video_track_cnt = 0;
+	_metadata->stats_enabled = false;
+	_metadata->arena_enabled = false;
+	_metadata->source = METADATA_EXTRACTOR_SOURCE_PATH;
+	pthread_mutex_init(&_metadata->extract_lock, NULL);
+	__metadata_extractor_arena_init(&_metadata->arena, &_metadata->allocator);
 
 	*metadata = (metadata_extractor_h)_metadata;
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
@@ -935,7 +1246,7 @@ int metadata_extractor_set_path(metadata_extractor_h metadata, const char *path)
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
 	if((_metadata == NULL) || (path == NULL))
 	{
@@ -943,17 +1254,32 @@ int metadata_extractor_set_path(metadata_extractor_h metadata, const char *path)
 		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
 	}
 
-	LOGI("[%s] path [%s] \n", __FUNCTION__, path);
+	metadata_extractor_info("[%s] path [%s] \n", __FUNCTION__, path);
 
 	if(_metadata->path != NULL)
 	{
 		SAFE_FREE(_metadata->path);
 		_metadata->extract_meta = false;
+
+		ret = __metadata_extractor_destroy_handle(_metadata);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			return ret;
+		}
+
+		/* results of the previous path are gone from here on */
+		__metadata_extractor_arena_reset(&_metadata->arena);
+
+		/* kept over failed extractions, since a frame may be decoded from it meanwhile */
+		__metadata_extractor_mmap_close(_metadata->map, _metadata->map_size);
+		_metadata->map = NULL;
+		_metadata->map_rejected = false;
 	}
 
 	_metadata->path = strdup(path);
+	memset(&_metadata->stats, 0, sizeof(_metadata->stats));
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
@@ -963,7 +1289,7 @@ int metadata_extractor_destroy(metadata_extractor_h metadata)
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
 	if(!_metadata)
 	{
@@ -973,16 +1299,21 @@ int metadata_extractor_destroy(metadata_extractor_h metadata)
 
 	ret = __metadata_extractor_destroy_handle(_metadata);
 
+	__metadata_extractor_mmap_close(_metadata->map, _metadata->map_size);
 	SAFE_FREE(_metadata->path);
+	SAFE_FREE(_metadata->waveform_cache);
+
+	pthread_mutex_destroy(&_metadata->extract_lock);
+	__metadata_extractor_arena_release(&_metadata->arena);
 
 	SAFE_FREE(_metadata);
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
 
-int metadata_extractor_get_synclyrics(metadata_extractor_h metadata, int index, unsigned long *time_stamp, char **lyrics)
+static int __metadata_extractor_api_get_synclyrics(metadata_extractor_h metadata, int index, unsigned long *time_stamp, char **lyrics)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
@@ -1017,7 +1348,20 @@ int metadata_extractor_get_synclyrics(metadata_extractor_h metadata, int index,
 			return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
 		}
 
-		*lyrics = _lyrics;
+		if(_lyrics != NULL)
+		{
+			/* the tag handle owns _lyrics, hand out a copy */
+			*lyrics = __metadata_extractor_strdup(_metadata, _lyrics);
+			if(*lyrics == NULL)
+			{
+				LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+				return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+			}
+		}
+		else
+		{
+			*lyrics = NULL;
+		}
 		*time_stamp = _time_info;
 	}
 	else
@@ -1029,195 +1373,181 @@ int metadata_extractor_get_synclyrics(metadata_extractor_h metadata, int index,
 	return ret;
 }
 
-int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extractor_attr_e attribute, char **value)
+/* raw value of one attribute; s_value points into the tag handle */
+static int __metadata_extractor_get_attr_value(metadata_extractor_s *metadata, metadata_extractor_attr_e attribute, int *i_value, double *d_value, char **s_value, int *is_string, int *is_double)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
-	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
-	int i_value = 0;
-	double d_value = 0;
-	char *s_value = NULL;
-	int is_string = 0;
-	int is_double = 0;
-
-	if((!_metadata) || (!_metadata->path))
-	{
-		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
-		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
-	}
 
-	ret = __metadata_extractor_check_and_extract_meta(_metadata);
-	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
-	{
-		return ret;
-	}
+	*is_string = 0;
+	*is_double = 0;
 
 	switch (attribute) {
 		case METADATA_DURATION:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_duration(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_duration(metadata, i_value);
 			break;
 		}
 		case METADATA_VIDEO_BITRATE:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_video_bitrate(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_video_bitrate(metadata, i_value);
 			break;
 		}
 		case METADATA_VIDEO_FPS:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_video_FPS(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_video_FPS(metadata, i_value);
 			break;
 		}
 		case METADATA_VIDEO_WIDTH:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_video_width(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_video_width(metadata, i_value);
 			break;
 		}
 		case METADATA_VIDEO_HEIGHT:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_video_height(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_video_height(metadata, i_value);
 			break;
 		}
 		case METADATA_HAS_VIDEO:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_video_track_count(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_video_track_count(metadata, i_value);
 			break;
 		}
 		case METADATA_AUDIO_BITRATE:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_audio_bitrate(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_audio_bitrate(metadata, i_value);
 			break;
 		}
 		case METADATA_AUDIO_CHANNELS:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_audio_channel(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_audio_channel(metadata, i_value);
 			break;
 		}
 		case METADATA_AUDIO_SAMPLERATE:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_audio_samplerate(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_audio_samplerate(metadata, i_value);
 			break;
 		}
 		case METADATA_HAS_AUDIO:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_audio_track_count(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_audio_track_count(metadata, i_value);
 			break;
 		}
 		case METADATA_ARTIST:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_artist(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_artist(metadata, s_value);
 			break;
 		}
 		case METADATA_TITLE:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_title(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_title(metadata, s_value);
 			break;
 		}
 		case METADATA_ALBUM:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_album(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_album(metadata, s_value);
 			break;
 		}
 		case METADATA_GENRE:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_genre(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_genre(metadata, s_value);
 			break;
 		}
 		case METADATA_AUTHOR:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_author(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_author(metadata, s_value);
 			break;
 		}
 		case METADATA_COPYRIGHT:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_copyright(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_copyright(metadata, s_value);
 			break;
 		}
 		case METADATA_DATE:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_date(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_date(metadata, s_value);
 			break;
 		}
 		case METADATA_DESCRIPTION:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_description(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_description(metadata, s_value);
 			break;
 		}
 		case METADATA_TRACK_NUM:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_track_num(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_track_num(metadata, s_value);
 			break;
 		}
 		case METADATA_CLASSIFICATION:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_classification(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_classification(metadata, s_value);
 			break;
 		}
 		case METADATA_RATING:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_rating(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_rating(metadata, s_value);
 			break;
 		}
 		case METADATA_LONGITUDE:
 		{
-			is_double = 1;
-			ret = __metadata_extractor_get_longitude(_metadata, &d_value);
+			*is_double = 1;
+			ret = __metadata_extractor_get_longitude(metadata, d_value);
 			break;
 		}
 		case METADATA_LATITUDE:
 		{
-			is_double = 1;
-			ret = __metadata_extractor_get_latitude(_metadata, &d_value);
+			*is_double = 1;
+			ret = __metadata_extractor_get_latitude(metadata, d_value);
 			break;
 		}
 		case METADATA_ALTITUDE:
 		{
-			is_double = 1;
-			ret = __metadata_extractor_get_altitude(_metadata, &d_value);
+			*is_double = 1;
+			ret = __metadata_extractor_get_altitude(metadata, d_value);
 			break;
 		}
 		case METADATA_CONDUCTOR:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_conductor(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_conductor(metadata, s_value);
 			break;
 		}
 		case METADATA_UNSYNCLYRICS:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_unsynclyrics(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_unsynclyrics(metadata, s_value);
 			break;
 		}
 		case METADATA_SYNCLYRICS_NUM:
 		{
-			is_string = 0;
-			ret = __metadata_extractor_get_synclyrics_pair_num(_metadata, &i_value);
+			*is_string = 0;
+			ret = __metadata_extractor_get_synclyrics_pair_num(metadata, i_value);
 			break;
 		}
 		case METADATA_RECDATE:
 		{
-			is_string = 1;
-			ret = __metadata_extractor_get_recording_date(_metadata, &s_value);
+			*is_string = 1;
+			ret = __metadata_extractor_get_recording_date(metadata, s_value);
 			break;
 		}
 		default:
@@ -1227,6 +1557,38 @@ int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extr
 		}
 	}
 
+	if((*is_string) && (ret == METADATA_EXTRACTOR_ERROR_NONE) && (metadata->text[attribute] != NULL))
+	{
+		*s_value = metadata->text[attribute];
+	}
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_metadata(metadata_extractor_h metadata, metadata_extractor_attr_e attribute, char **value)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	int i_value = 0;
+	double d_value = 0;
+	char *s_value = NULL;
+	int is_string = 0;
+	int is_double = 0;
+
+	if((!_metadata) || (!_metadata->path))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	ret = __metadata_extractor_get_attr_value(_metadata, attribute, &i_value, &d_value, &s_value, &is_string, &is_double);
+
 	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
 	{
 		*value = NULL;
@@ -1237,7 +1599,7 @@ int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extr
 	{
 		if((s_value != NULL) && (strlen(s_value) > 0))
 		{
-			*value = strdup(s_value);
+			*value = __metadata_extractor_strdup(_metadata, s_value);
 			if(*value == NULL)
 			{
 				LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
@@ -1262,21 +1624,22 @@ int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extr
 			snprintf(metadata, sizeof(metadata), "%d", i_value);
 		}
 
-		*value = strdup(metadata);
+		*value = __metadata_extractor_strdup(_metadata, metadata);
 	}
 
 	return ret;
 }
 
-int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork, int *size, char **mime_type)
+static int __metadata_extractor_api_get_artwork(metadata_extractor_h metadata, void **artwork, int *size, char **mime_type)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
 	void *_artwork = NULL;
 	int _artwork_size = 0;
 	char *_artwork_mime = NULL;
+	unsigned long long begin = 0;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
 	if((!_metadata) || (!_metadata->path))
 	{
@@ -1290,6 +1653,8 @@ int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork
 		return ret;
 	}
 
+	begin = __metadata_extractor_stats_begin(_metadata);
+
 	ret = __metadata_extractor_get_artwork(_metadata, &_artwork, &_artwork_size);
 	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
 	{
@@ -1307,13 +1672,18 @@ int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork
 			return ret;
 		}
 
-		*artwork = calloc(1, _artwork_size);
+		*artwork = __metadata_extractor_alloc(_metadata, _artwork_size);
+		if(*artwork == NULL)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
 		memcpy(*artwork, _artwork, _artwork_size);
 		*size = _artwork_size;
 
 		if((_artwork_mime != NULL) && (strlen(_artwork_mime) > 0))
 		{
-			*mime_type = strdup(_artwork_mime);
+			*mime_type = __metadata_extractor_strdup(_metadata, _artwork_mime);
 			if(*mime_type == NULL)
 			{
 				LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
@@ -1333,21 +1703,25 @@ int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork
 		*size = 0;
 	}
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	__metadata_extractor_stats_end(_metadata, &_metadata->stats.artwork_time, begin);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
 
-int metadata_extractor_get_frame(metadata_extractor_h metadata, void **frame, int *size)
+static int __metadata_extractor_api_get_artwork_view(metadata_extractor_h metadata, const void **artwork, int *size, const char **mime_type)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
-	void *_frame = NULL;
-	int _frame_size = 0;
+	void *_artwork = NULL;
+	int _artwork_size = 0;
+	char *_artwork_mime = NULL;
+	unsigned long long begin = 0;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
-	if((!_metadata) || (!_metadata->path) || (!size))
+	if((!_metadata) || (!_metadata->path) || (!artwork) || (!size) || (!mime_type))
 	{
 		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
 		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
@@ -1359,79 +1733,1238 @@ int metadata_extractor_get_frame(metadata_extractor_h metadata, void **frame, in
 		return ret;
 	}
 
-	ret = __metadata_extractor_get_video_thumbnail(_metadata, &_frame, &_frame_size);
+	begin = __metadata_extractor_stats_begin(_metadata);
+
+	ret = __metadata_extractor_get_artwork(_metadata, &_artwork, &_artwork_size);
 	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
 	{
 		return ret;
 	}
 
-	if((_frame_size > 0) && (_frame != NULL))
+	if((_artwork_size > 0) && (_artwork != NULL))
 	{
-		*frame = calloc(1, _frame_size);
-		if(*frame == NULL)
+		ret = __metadata_extractor_get_artwork_mime(_metadata, &_artwork_mime);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
 		{
-			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
-			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+			return ret;
 		}
-		memcpy(*frame, _frame, _frame_size);
-		*size = _frame_size;
+
+		/* owned by the tag handle, nothing is copied */
+		*artwork = _artwork;
+		*size = _artwork_size;
+		*mime_type = ((_artwork_mime != NULL) && (_artwork_mime[0] != '\0')) ? _artwork_mime : NULL;
 	}
 	else
 	{
-		*frame = NULL;
+		*artwork = NULL;
+		*mime_type = NULL;
 		*size = 0;
 	}
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	__metadata_extractor_stats_end(_metadata, &_metadata->stats.artwork_time, begin);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
 
 	return ret;
 }
 
-int metadata_extractor_get_frame_at_time(metadata_extractor_h metadata, unsigned long timestamp, bool is_accurate, void **frame, int *size)
+static int __metadata_extractor_api_get_artwork_digest(metadata_extractor_h metadata, unsigned long long *digest, int *size)
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
-	void *_frame = NULL;
-	int _frame_size = 0;
-	int width = 0;
-	int height = 0;
-	long micro_timestamp = 0;
+	void *_artwork = NULL;
+	int _artwork_size = 0;
+	unsigned long long begin = 0;
 
-	LOGI("[%s] enter \n", __FUNCTION__);
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
 
-	if((!_metadata) || (!_metadata->path) || (timestamp < 0) || (!size))
+	if((!_metadata) || (!_metadata->path) || (!digest) || (!size))
 	{
 		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
 		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
 	}
 
-	micro_timestamp = timestamp * 1000;
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	begin = __metadata_extractor_stats_begin(_metadata);
 
-	ret = mm_file_get_video_frame(_metadata->path, micro_timestamp, is_accurate, (unsigned char **)&_frame, &_frame_size, &width, &height);
-	if(ret != MM_ERROR_NONE)
+	ret = __metadata_extractor_get_artwork(_metadata, &_artwork, &_artwork_size);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
 	{
-		LOGE("[%s]ERROR_UNKNOWN(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED);
-		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+		return ret;
 	}
 
-	if((_frame_size > 0) && (_frame != NULL))
+	if((_artwork_size > 0) && (_artwork != NULL))
 	{
-		*frame = calloc(1, _frame_size);
-		if(*frame == NULL)
-		{
-			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
-			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
-		}
-		memcpy(*frame, _frame, _frame_size);
-		*size = _frame_size;
+		/* hashed where the tag handle holds it */
+		*digest = __metadata_extractor_xxh64(_artwork, _artwork_size, 0);
+		*size = _artwork_size;
 	}
 	else
 	{
-		*frame = NULL;
+		*digest = 0;
 		*size = 0;
 	}
 
-	LOGI("[%s] leave \n", __FUNCTION__);
+	__metadata_extractor_stats_end(_metadata, &_metadata->stats.artwork_time, begin);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_artwork_location(metadata_extractor_h metadata, long long *offset, int *size, char **mime_type)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	metadata_extractor_artwork_location_s location;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (!offset) || (!size) || (!mime_type))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	/* the tags are parsed here, the picture itself is never read */
+	ret = __metadata_extractor_artwork_locate(_metadata->path, &location);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if((location.size > 0) && (location.size <= INT_MAX))
+	{
+		*mime_type = NULL;
+		if(location.mime[0] != '\0')
+		{
+			*mime_type = __metadata_extractor_strdup(_metadata, location.mime);
+			if(*mime_type == NULL)
+			{
+				LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+				return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+			}
+		}
+		*offset = (long long)location.offset;
+		*size = (int)location.size;
+	}
+	else
+	{
+		*offset = 0;
+		*size = 0;
+		*mime_type = NULL;
+	}
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_artwork_scaled(metadata_extractor_h metadata, int max_dim, metadata_extractor_image_format_e format, void **image, int *size, int *width, int *height)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	void *_artwork = NULL;
+	int _artwork_size = 0;
+	metadata_extractor_image_s _image;
+	unsigned long long begin = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (max_dim <= 0) || (!image) || (!size) || (!width) || (!height))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if((format != METADATA_EXTRACTOR_IMAGE_FORMAT_RGB888) && (format != METADATA_EXTRACTOR_IMAGE_FORMAT_JPEG))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	begin = __metadata_extractor_stats_begin(_metadata);
+
+	ret = __metadata_extractor_get_artwork(_metadata, &_artwork, &_artwork_size);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if((_artwork_size > 0) && (_artwork != NULL))
+	{
+		/* decoded straight from the tag handle, the full-size picture is never copied */
+		memset(&_image, 0, sizeof(_image));
+		ret = __metadata_extractor_scale_artwork(_artwork, _artwork_size, max_dim, format, &_image);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			return ret;
+		}
+
+		*image = __metadata_extractor_alloc(_metadata, _image.size);
+		if(*image == NULL)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			free(_image.data);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		memcpy(*image, _image.data, _image.size);
+		free(_image.data);
+		*size = (int)_image.size;
+		*width = _image.width;
+		*height = _image.height;
+	}
+	else
+	{
+		*image = NULL;
+		*size = 0;
+		*width = 0;
+		*height = 0;
+	}
+
+	__metadata_extractor_stats_end(_metadata, &_metadata->stats.artwork_time, begin);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_frame(metadata_extractor_h metadata, void **frame, int *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	void *_frame = NULL;
+	int _frame_size = 0;
+	unsigned long long begin = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (!size))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	begin = __metadata_extractor_stats_begin(_metadata);
+
+	ret = __metadata_extractor_get_video_thumbnail(_metadata, &_frame, &_frame_size);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if((_frame_size > 0) && (_frame != NULL))
+	{
+		*frame = __metadata_extractor_alloc(_metadata, _frame_size);
+		if(*frame == NULL)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		memcpy(*frame, _frame, _frame_size);
+		*size = _frame_size;
+	}
+	else
+	{
+		*frame = NULL;
+		*size = 0;
+	}
+
+	if(_metadata->stats_enabled)
+	{
+		__metadata_extractor_stats_end(_metadata, &_metadata->stats.frame_time, begin);
+		__atomic_fetch_add(&_metadata->stats.frame_count, 1, __ATOMIC_RELAXED);
+	}
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+/*
+ * decodes the frame at micro_timestamp of the current path; the RGB888 frame is malloc()ed and belongs to the caller.
+ * Microseconds overflow a 32 bit long after 35 minutes, mm-fileinfo takes them as a double.
+ */
+static int __metadata_extractor_decode_video_frame(metadata_extractor_s *metadata, long long micro_timestamp, bool is_accurate, void **frame, int *size, int *width, int *height)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long read_bytes = 0;
+	unsigned long long trace_begin = 0;
+	void *map = NULL;
+
+	if(metadata->stats_enabled)
+	{
+		read_bytes = __metadata_extractor_get_read_bytes();
+	}
+
+	if(metadata->source != METADATA_EXTRACTOR_SOURCE_PATH)
+	{
+		pthread_mutex_lock(&metadata->extract_lock);
+		__metadata_extractor_map_source(metadata);
+		map = metadata->map_rejected ? NULL : metadata->map;
+		pthread_mutex_unlock(&metadata->extract_lock);
+	}
+
+	trace_begin = __metadata_extractor_trace_begin();
+	if(map != NULL)
+		ret = mm_file_get_video_frame_from_memory(map, metadata->map_size, (double)micro_timestamp, is_accurate, (unsigned char **)frame, size, width, height);
+	/* as for extraction, what the memory decoder refuses may still decode by path */
+	if((map == NULL) || (ret != MM_ERROR_NONE))
+		ret = mm_file_get_video_frame(metadata->path, (double)micro_timestamp, is_accurate, (unsigned char **)frame, size, width, height);
+	__metadata_extractor_trace_end("decode_video_frame", trace_begin, NULL);
+
+	if(metadata->stats_enabled)
+	{
+		__atomic_fetch_add(&metadata->stats.bytes_read, __metadata_extractor_get_read_bytes() - read_bytes, __ATOMIC_RELAXED);
+	}
+
+	if(ret != MM_ERROR_NONE)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_api_get_frame_at_time(metadata_extractor_h metadata, unsigned long timestamp, bool is_accurate, void **frame, int *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	void *_frame = NULL;
+	int _frame_size = 0;
+	int width = 0;
+	int height = 0;
+	long long micro_timestamp = 0;
+	unsigned long long begin = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (timestamp < 0) || (!size))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	micro_timestamp = (long long)timestamp * 1000;
+
+	begin = __metadata_extractor_stats_begin(_metadata);
+
+	ret = __metadata_extractor_decode_video_frame(_metadata, micro_timestamp, is_accurate, &_frame, &_frame_size, &width, &height);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if((_frame_size > 0) && (_frame != NULL))
+	{
+		*frame = __metadata_extractor_alloc(_metadata, _frame_size);
+		if(*frame == NULL)
+		{
+			SAFE_FREE(_frame);
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		memcpy(*frame, _frame, _frame_size);
+		*size = _frame_size;
+	}
+	else
+	{
+		*frame = NULL;
+		*size = 0;
+	}
+
+	/* the decoded frame belongs to us, not to a content handle */
+	SAFE_FREE(_frame);
+
+	if(_metadata->stats_enabled)
+	{
+		__metadata_extractor_stats_end(_metadata, &_metadata->stats.frame_time, begin);
+		__atomic_fetch_add(&_metadata->stats.frame_count, 1, __ATOMIC_RELAXED);
+	}
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_best_frame(metadata_extractor_h metadata, int budget, void **frame, int *size, unsigned long *timestamp)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	void *best_frame = NULL;
+	int best_size = 0;
+	unsigned long best_timestamp = 0;
+	double best_score = -1;
+	unsigned long long begin = 0;
+	int video_track_cnt = 0;
+	int duration = 0;
+	int idx = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (budget < 0) || (!frame) || (!size))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	ret = __metadata_extractor_get_video_track_count(_metadata, &video_track_cnt);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_duration(_metadata, &duration);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if(budget == 0)
+		budget = BEST_FRAME_DEFAULT_BUDGET;
+	if(budget > BEST_FRAME_MAX_BUDGET)
+		budget = BEST_FRAME_MAX_BUDGET;
+
+	/* keyframes spread over the file, away from the intro at 0 and the fade out at the end */
+	for(idx = 0; (idx < budget) && (video_track_cnt > 0) && (best_score < BEST_FRAME_GOOD_SCORE); idx++)
+	{
+		unsigned long position = (unsigned long)(((unsigned long long)(idx + 1) * duration) / (budget + 1));
+		void *_frame = NULL;
+		int _frame_size = 0;
+		int width = 0;
+		int height = 0;
+		double score = 0;
+
+		begin = __metadata_extractor_stats_begin(_metadata);
+
+		if((__metadata_extractor_decode_video_frame(_metadata, (long long)position * 1000, false, &_frame, &_frame_size, &width, &height) != METADATA_EXTRACTOR_ERROR_NONE) ||
+			(_frame == NULL) || ((long long)width * height * 3 > _frame_size) ||
+			(__metadata_extractor_score_frame((const unsigned char *)_frame, width, height, &score) != METADATA_EXTRACTOR_ERROR_NONE))
+		{
+			SAFE_FREE(_frame);
+			continue;
+		}
+
+		if(_metadata->stats_enabled)
+		{
+			__metadata_extractor_stats_end(_metadata, &_metadata->stats.frame_time, begin);
+			__atomic_fetch_add(&_metadata->stats.frame_count, 1, __ATOMIC_RELAXED);
+		}
+
+		metadata_extractor_debug("[%s] %lu ms scores %.2f", __FUNCTION__, position, score);
+
+		/* at most the best so far and the candidate are held */
+		if(score > best_score)
+		{
+			SAFE_FREE(best_frame);
+			best_frame = _frame;
+			best_size = _frame_size;
+			best_timestamp = position;
+			best_score = score;
+		}
+		else
+		{
+			SAFE_FREE(_frame);
+		}
+	}
+
+	if(best_frame == NULL)
+	{
+		/* no video, or no keyframe could be decoded: the thumbnail of the content handle it is */
+		ret = __metadata_extractor_api_get_frame(metadata, frame, size);
+		if((ret == METADATA_EXTRACTOR_ERROR_NONE) && (timestamp != NULL))
+			*timestamp = 0;
+		return ret;
+	}
+
+	*frame = __metadata_extractor_alloc(_metadata, best_size);
+	if(*frame == NULL)
+	{
+		SAFE_FREE(best_frame);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+	memcpy(*frame, best_frame, best_size);
+	*size = best_size;
+	if(timestamp != NULL)
+		*timestamp = best_timestamp;
+
+	SAFE_FREE(best_frame);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_sprite_sheet(metadata_extractor_h metadata, unsigned long interval, int count, int tile_width, int tile_height, bool is_accurate, void **sheet, int *width, int *height, metadata_extractor_sprite_tile_s **tiles, int *tile_count)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	metadata_extractor_sprite_tile_s *_tiles = NULL;
+	unsigned char *_sheet = NULL;
+	unsigned long long sheet_size = 0;
+	unsigned long long prev_digest = 0;
+	unsigned long long begin = 0;
+	int video_track_cnt = 0;
+	int duration = 0;
+	int samples = 0;
+	int columns = 0;
+	int rows = 0;
+	int used = 0;
+	int idx = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (count < 0) || ((interval == 0) && (count == 0)) || (tile_width <= 0) || (tile_height <= 0) ||
+		(!sheet) || (!width) || (!height) || (!tiles) || (!tile_count))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	ret = __metadata_extractor_get_video_track_count(_metadata, &video_track_cnt);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_duration(_metadata, &duration);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if(video_track_cnt <= 0)
+	{
+		*sheet = NULL;
+		*width = 0;
+		*height = 0;
+		*tiles = NULL;
+		*tile_count = 0;
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	/* every interval up to the end, or count times spread over the file */
+	if(interval == 0)
+		samples = count;
+	else if(duration > 0)
+		samples = (int)(((unsigned long long)duration + interval - 1) / interval);
+	else
+		samples = 1;
+	if((count > 0) && (samples > count))
+		samples = count;
+	if(samples > SPRITE_MAX_TILES)
+		samples = SPRITE_MAX_TILES;
+
+	/* a near-square grid */
+	for(columns = 1; columns * columns < samples; columns++)
+		;
+	rows = (samples + columns - 1) / columns;
+
+	sheet_size = (unsigned long long)columns * tile_width * rows * tile_height * 3;
+	if(((unsigned long long)columns * tile_width > INT_MAX) || ((unsigned long long)rows * tile_height > INT_MAX) || (sheet_size > INT_MAX))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) sheet too large", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_tiles = (metadata_extractor_sprite_tile_s *)__metadata_extractor_alloc(_metadata, samples * sizeof(metadata_extractor_sprite_tile_s));
+	_sheet = (unsigned char *)__metadata_extractor_alloc(_metadata, sheet_size);
+	if((_tiles == NULL) || (_sheet == NULL))
+	{
+		__metadata_extractor_release(_metadata, _tiles);
+		__metadata_extractor_release(_metadata, _sheet);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+	/* black letterbox around tiles of another aspect ratio */
+	memset(_sheet, 0, sheet_size);
+
+	for(idx = 0; (idx < samples) && (ret == METADATA_EXTRACTOR_ERROR_NONE); idx++)
+	{
+		unsigned long timestamp = (interval > 0) ? idx * interval : (unsigned long)(((2ULL * idx + 1) * duration) / (2ULL * samples));
+		void *frame = NULL;
+		int frame_size = 0;
+		int frame_width = 0;
+		int frame_height = 0;
+		unsigned long long digest = 0;
+
+		begin = __metadata_extractor_stats_begin(_metadata);
+
+		_tiles[idx].timestamp = timestamp;
+
+		ret = __metadata_extractor_decode_video_frame(_metadata, (long long)timestamp * 1000, is_accurate, &frame, &frame_size, &frame_width, &frame_height);
+		if((ret != METADATA_EXTRACTOR_ERROR_NONE) || (frame == NULL) || ((long long)frame_width * frame_height * 3 > frame_size))
+		{
+			SAFE_FREE(frame);
+			if(used == 0)
+			{
+				ret = METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+				break;
+			}
+			/* past the last keyframe the previous tile stands in */
+			_tiles[idx].x = _tiles[idx - 1].x;
+			_tiles[idx].y = _tiles[idx - 1].y;
+			ret = METADATA_EXTRACTOR_ERROR_NONE;
+			continue;
+		}
+
+		/* positions within one GOP decode to the same keyframe, which gets one tile only */
+		digest = __metadata_extractor_xxh64(frame, frame_size, 0);
+		if((used > 0) && (digest == prev_digest))
+		{
+			_tiles[idx].x = _tiles[idx - 1].x;
+			_tiles[idx].y = _tiles[idx - 1].y;
+		}
+		else
+		{
+			_tiles[idx].x = (used % columns) * tile_width;
+			_tiles[idx].y = (used / columns) * tile_height;
+			ret = __metadata_extractor_scale_frame((const unsigned char *)frame, frame_width, frame_height,
+				_sheet + ((size_t)_tiles[idx].y * columns * tile_width + _tiles[idx].x) * 3, tile_width, tile_height, (size_t)columns * tile_width * 3);
+			used++;
+		}
+		prev_digest = digest;
+
+		/* one full-size frame at a time */
+		SAFE_FREE(frame);
+
+		if(_metadata->stats_enabled)
+		{
+			__metadata_extractor_stats_end(_metadata, &_metadata->stats.frame_time, begin);
+			__atomic_fetch_add(&_metadata->stats.frame_count, 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_release(_metadata, _tiles);
+		__metadata_extractor_release(_metadata, _sheet);
+		return ret;
+	}
+
+	*sheet = _sheet;
+	*width = columns * tile_width;
+	/* rows left empty by repeated keyframes are cut off */
+	*height = ((used + columns - 1) / columns) * tile_height;
+	*tiles = _tiles;
+	*tile_count = samples;
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+/* all attributes of the current path; strings point into the tag handle */
+static int __metadata_extractor_get_values(metadata_extractor_s *metadata, metadata_extractor_record_value_s *values)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int attr = 0;
+
+	ret = __metadata_extractor_check_and_extract_meta(metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	memset(values, 0, sizeof(metadata_extractor_record_value_s) * METADATA_EXTRACTOR_RECORD_ATTR_COUNT);
+
+	for(attr = 0; attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT; attr++)
+	{
+		char *s_value = NULL;
+		int is_string = 0;
+		int is_double = 0;
+
+		ret = __metadata_extractor_get_attr_value(metadata, (metadata_extractor_attr_e)attr, &values[attr].i_value, &values[attr].d_value, &s_value, &is_string, &is_double);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			return ret;
+		}
+
+		/* same as metadata_extractor_get_metadata(): an empty string is no value */
+		if((s_value != NULL) && (s_value[0] != '\0'))
+		{
+			values[attr].s_value = s_value;
+		}
+	}
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_fingerprint(metadata_extractor_h metadata, metadata_extractor_fingerprint_s *fingerprint)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	int params[9] = {0, };
+	int format = -1;
+	unsigned long long payload = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (!fingerprint))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_check_and_extract_meta(_metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	/* the content handle only; bitrates are left out as some parsers derive them from the file size */
+	ret = __metadata_extractor_get_duration(_metadata, &params[1]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_audio_track_count(_metadata, &params[2]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_audio_channel(_metadata, &params[3]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_audio_samplerate(_metadata, &params[4]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_video_track_count(_metadata, &params[5]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_video_width(_metadata, &params[6]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_video_height(_metadata, &params[7]);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_get_video_FPS(_metadata, &params[8]);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	ret = __metadata_extractor_fingerprint_payload(_metadata->path, &format, &payload);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+	params[0] = format;
+
+	fingerprint->params = __metadata_extractor_xxh64(params, sizeof(params), 0);
+	fingerprint->payload = payload;
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_get_waveform(metadata_extractor_h metadata, int buckets, metadata_extractor_peak_s **peaks)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	metadata_extractor_peak_s *_peaks = NULL;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (buckets <= 0) || (buckets > WAVEFORM_MAX_BUCKETS) || (!peaks))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_peaks = (metadata_extractor_peak_s *)__metadata_extractor_alloc(_metadata, buckets * sizeof(metadata_extractor_peak_s));
+	if(_peaks == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	if((_metadata->waveform_cache != NULL) && __metadata_extractor_waveform_cache_load(_metadata->waveform_cache, _metadata->path, buckets, _peaks))
+	{
+		__metadata_extractor_metrics_waveform_cache_hit();
+		*peaks = _peaks;
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	ret = __metadata_extractor_waveform(_metadata->path, buckets, _peaks);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_release(_metadata, _peaks);
+		return ret;
+	}
+
+	/* a cache that cannot be written costs the next caller a pass over the file, nothing more */
+	if(_metadata->waveform_cache != NULL)
+		__metadata_extractor_waveform_cache_save(_metadata->waveform_cache, _metadata->path, buckets, _peaks);
+
+	*peaks = _peaks;
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_serialize(metadata_extractor_h metadata, void **record, size_t *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	metadata_extractor_record_value_s values[METADATA_EXTRACTOR_RECORD_ATTR_COUNT];
+	size_t _size = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!_metadata->path) || (!record) || (!size))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_get_values(_metadata, values);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	_size = __metadata_extractor_record_size(_metadata->path, values);
+
+	*record = __metadata_extractor_alloc(_metadata, _size);
+	if(*record == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	__metadata_extractor_record_write(_metadata->path, values, *record, _size);
+	*size = _size;
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+static int __metadata_extractor_api_batch_extract(metadata_extractor_h metadata, const char **paths, int count, metadata_extractor_batch_h batch)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	metadata_extractor_record_value_s values[METADATA_EXTRACTOR_RECORD_ATTR_COUNT];
+	metadata_extractor_prefetch_s *prefetch = NULL;
+	bool artwork_enabled = false;
+	int idx = 0;
+
+	metadata_extractor_info("[%s] enter \n", __FUNCTION__);
+
+	if((!_metadata) || (!paths) || (count < 0) || (!batch))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	for(idx = 0; idx < count; idx++)
+	{
+		if(paths[idx] == NULL)
+		{
+			LOGE("[%s]INVALID_PARAMETER(0x%08x) path [%d]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER, idx);
+			return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+		}
+	}
+
+	artwork_enabled = ((metadata_extractor_batch_s *)batch)->artwork_enabled;
+	prefetch = __metadata_extractor_prefetch_start(paths, count, _metadata->prefetch_depth);
+
+	for(idx = 0; idx < count; idx++)
+	{
+		void *artwork = NULL;
+		int artwork_size = 0;
+		char *artwork_mime = NULL;
+
+		__metadata_extractor_prefetch_advance(prefetch, idx);
+
+		ret = metadata_extractor_set_path(metadata, paths[idx]);
+		if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			ret = __metadata_extractor_get_values(_metadata, values);
+		}
+
+		/* handed over as the tag handle holds it, the batch copies only artwork it has not seen */
+		if((ret == METADATA_EXTRACTOR_ERROR_NONE) && artwork_enabled &&
+			(__metadata_extractor_get_artwork(_metadata, &artwork, &artwork_size) == METADATA_EXTRACTOR_ERROR_NONE) && (artwork_size > 0))
+		{
+			/* the picture is still worth keeping, its row just reports no mime type */
+			if(__metadata_extractor_get_artwork_mime(_metadata, &artwork_mime) != METADATA_EXTRACTOR_ERROR_NONE)
+			{
+				LOGW("[%s]no artwork mime for [%s], artwork kept without it", __FUNCTION__, paths[idx]);
+				artwork_mime = NULL;
+			}
+		}
+
+		/* a file that can not be extracted still gets its row, without values */
+		ret = __metadata_extractor_batch_append((metadata_extractor_batch_s *)batch, paths[idx], (ret == METADATA_EXTRACTOR_ERROR_NONE) ? values : NULL,
+			artwork, artwork_size, artwork_mime);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			break;
+		}
+	}
+
+	__metadata_extractor_prefetch_stop(prefetch);
+
+	metadata_extractor_info("[%s] leave \n", __FUNCTION__);
+
+	return ret;
+}
+
+int metadata_extractor_set_stats_enabled(metadata_extractor_h metadata, bool enable)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+
+	if(!_metadata)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_metadata->stats_enabled = enable;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_set_arena_enabled(metadata_extractor_h metadata, bool enable)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+
+	if(!_metadata)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_metadata->arena_enabled = enable;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_set_source(metadata_extractor_h metadata, metadata_extractor_source_e source)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+
+	if((!_metadata) || (source < METADATA_EXTRACTOR_SOURCE_PATH) || (source > METADATA_EXTRACTOR_SOURCE_MMAP_RANDOM))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_metadata->source = source;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_set_prefetch_depth(metadata_extractor_h metadata, int depth)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+
+	if((!_metadata) || (depth < 0))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_metadata->prefetch_depth = depth;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_set_waveform_cache(metadata_extractor_h metadata, const char *path)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+	char *_path = NULL;
+
+	if(!_metadata)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(path != NULL)
+	{
+		_path = strdup(path);
+		if(_path == NULL)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	SAFE_FREE(_metadata->waveform_cache);
+	_metadata->waveform_cache = _path;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_set_allocator(metadata_extractor_h metadata, metadata_extractor_malloc_cb malloc_cb, metadata_extractor_realloc_cb realloc_cb, metadata_extractor_free_cb free_cb, void *user_data)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+
+	if((!_metadata) || ((malloc_cb == NULL) != (free_cb == NULL)) || ((malloc_cb == NULL) != (realloc_cb == NULL)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	/* arena chunks must go back to the allocator they came from */
+	__metadata_extractor_arena_release(&_metadata->arena);
+
+	_metadata->allocator.malloc_cb = malloc_cb;
+	_metadata->allocator.realloc_cb = realloc_cb;
+	_metadata->allocator.free_cb = free_cb;
+	_metadata->allocator.user_data = user_data;
+
+	__metadata_extractor_arena_init(&_metadata->arena, &_metadata->allocator);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_get_stats(metadata_extractor_h metadata, metadata_extractor_stats_s *stats)
+{
+	metadata_extractor_s *_metadata = (metadata_extractor_s*)metadata;
+
+	if((!_metadata) || (!stats))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	stats->content_time = __atomic_load_n(&_metadata->stats.content_time, __ATOMIC_RELAXED);
+	stats->content_attr_time = __atomic_load_n(&_metadata->stats.content_attr_time, __ATOMIC_RELAXED);
+	stats->tag_time = __atomic_load_n(&_metadata->stats.tag_time, __ATOMIC_RELAXED);
+	stats->artwork_time = __atomic_load_n(&_metadata->stats.artwork_time, __ATOMIC_RELAXED);
+	stats->frame_time = __atomic_load_n(&_metadata->stats.frame_time, __ATOMIC_RELAXED);
+	stats->frame_count = __atomic_load_n(&_metadata->stats.frame_count, __ATOMIC_RELAXED);
+	stats->bytes_read = __atomic_load_n(&_metadata->stats.bytes_read, __ATOMIC_RELAXED);
+	stats->alloc_count = __atomic_load_n(&_metadata->stats.alloc_count, __ATOMIC_RELAXED);
+	stats->alloc_size = __atomic_load_n(&_metadata->stats.alloc_size, __ATOMIC_RELAXED);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_get_synclyrics(metadata_extractor_h metadata, int index, unsigned long *time_stamp, char **lyrics)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_synclyrics(metadata, index, time_stamp, lyrics);
+
+	__metadata_extractor_trace_end("get_synclyrics", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_SYNCLYRICS, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_metadata(metadata_extractor_h metadata, metadata_extractor_attr_e attribute, char **value)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_metadata(metadata, attribute, value);
+
+	__metadata_extractor_trace_end("get_metadata", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_METADATA, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_artwork(metadata_extractor_h metadata, void **artwork, int *size, char **mime_type)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_artwork(metadata, artwork, size, mime_type);
+
+	__metadata_extractor_trace_end("get_artwork", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_ARTWORK, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_artwork_view(metadata_extractor_h metadata, const void **artwork, int *size, const char **mime_type)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_artwork_view(metadata, artwork, size, mime_type);
+
+	__metadata_extractor_trace_end("get_artwork_view", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_ARTWORK_VIEW, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_artwork_digest(metadata_extractor_h metadata, unsigned long long *digest, int *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_artwork_digest(metadata, digest, size);
+
+	__metadata_extractor_trace_end("get_artwork_digest", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_ARTWORK_DIGEST, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_artwork_location(metadata_extractor_h metadata, long long *offset, int *size, char **mime_type)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_artwork_location(metadata, offset, size, mime_type);
+
+	__metadata_extractor_trace_end("get_artwork_location", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_ARTWORK_LOCATION, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_artwork_scaled(metadata_extractor_h metadata, int max_dim, metadata_extractor_image_format_e format, void **image, int *size, int *width, int *height)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_artwork_scaled(metadata, max_dim, format, image, size, width, height);
+
+	__metadata_extractor_trace_end("get_artwork_scaled", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_ARTWORK_SCALED, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_frame(metadata_extractor_h metadata, void **frame, int *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_frame(metadata, frame, size);
+
+	__metadata_extractor_trace_end("get_frame", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_FRAME, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_frame_at_time(metadata_extractor_h metadata, unsigned long timestamp, bool is_accurate, void **frame, int *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_frame_at_time(metadata, timestamp, is_accurate, frame, size);
+
+	__metadata_extractor_trace_end("get_frame_at_time", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_FRAME_AT_TIME, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_serialize(metadata_extractor_h metadata, void **record, size_t *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_serialize(metadata, record, size);
+
+	__metadata_extractor_trace_end("serialize", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_SERIALIZE, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_best_frame(metadata_extractor_h metadata, int budget, void **frame, int *size, unsigned long *timestamp)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_best_frame(metadata, budget, frame, size, timestamp);
+
+	__metadata_extractor_trace_end("get_best_frame", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_BEST_FRAME, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_sprite_sheet(metadata_extractor_h metadata, unsigned long interval, int count, int tile_width, int tile_height, bool is_accurate, void **sheet, int *width, int *height, metadata_extractor_sprite_tile_s **tiles, int *tile_count)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_sprite_sheet(metadata, interval, count, tile_width, tile_height, is_accurate, sheet, width, height, tiles, tile_count);
+
+	__metadata_extractor_trace_end("get_sprite_sheet", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_SPRITE_SHEET, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_waveform(metadata_extractor_h metadata, int buckets, metadata_extractor_peak_s **peaks)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_waveform(metadata, buckets, peaks);
+
+	__metadata_extractor_trace_end("get_waveform", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_WAVEFORM, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_get_fingerprint(metadata_extractor_h metadata, metadata_extractor_fingerprint_s *fingerprint)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_get_fingerprint(metadata, fingerprint);
+
+	__metadata_extractor_trace_end("get_fingerprint", trace_begin, (metadata != NULL) ? ((metadata_extractor_s*)metadata)->path : NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_GET_FINGERPRINT, begin, ret);
+
+	return ret;
+}
+
+int metadata_extractor_batch_extract(metadata_extractor_h metadata, const char **paths, int count, metadata_extractor_batch_h batch)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned long long begin = __metadata_extractor_metrics_begin();
+	unsigned long long trace_begin = __metadata_extractor_trace_begin();
+
+	ret = __metadata_extractor_api_batch_extract(metadata, paths, count, batch);
+
+	__metadata_extractor_trace_end("batch_extract", trace_begin, NULL);
+	__metadata_extractor_metrics_end(METADATA_EXTRACTOR_METRIC_BATCH_EXTRACT, begin, ret);
 
 	return ret;
 }
@@ -0,0 +1,226 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <metadata_extractor_private.h>
+
+#define ARENA_CHUNK_SIZE	(16 * 1024)
+#define ARENA_ALIGN			16
+#define ARENA_ALIGN_UP(x)	(((x) + (ARENA_ALIGN - 1)) & ~((size_t)ARENA_ALIGN - 1))
+
+/*
+ * Bump allocator for the results of one path. Small results are carved from the head chunk;
+ * results larger than a quarter chunk (artwork, frames) get a chunk of their own, linked behind
+ * the head so that the free space of the head is not thrown away. A reset keeps one standard
+ * chunk for the next path and releases the rest; it runs from set_path/destroy, never next to an alloc.
+ */
+struct metadata_extractor_arena_chunk_s
+{
+	struct metadata_extractor_arena_chunk_s *next;
+	size_t size;
+	size_t used;
+};
+
+#define ARENA_CHUNK_HEADER	ARENA_ALIGN_UP(sizeof(metadata_extractor_arena_chunk_s))
+
+void *__metadata_extractor_allocator_malloc(const metadata_extractor_allocator_s *allocator, size_t size)
+{
+	if(allocator->malloc_cb != NULL)
+	{
+		return allocator->malloc_cb(size, allocator->user_data);
+	}
+
+	return malloc(size);
+}
+
+void *__metadata_extractor_allocator_realloc(const metadata_extractor_allocator_s *allocator, void *ptr, size_t size)
+{
+	if(allocator->realloc_cb != NULL)
+	{
+		return allocator->realloc_cb(ptr, size, allocator->user_data);
+	}
+
+	return realloc(ptr, size);
+}
+
+void __metadata_extractor_allocator_free(const metadata_extractor_allocator_s *allocator, void *ptr)
+{
+	if(ptr == NULL)
+	{
+		return;
+	}
+
+	if(allocator->free_cb != NULL)
+	{
+		allocator->free_cb(ptr, allocator->user_data);
+		return;
+	}
+
+	free(ptr);
+}
+
+static metadata_extractor_arena_chunk_s *__metadata_extractor_arena_new_chunk(metadata_extractor_arena_s *arena, size_t size)
+{
+	metadata_extractor_arena_chunk_s *chunk = (metadata_extractor_arena_chunk_s *)__metadata_extractor_allocator_malloc(arena->allocator, ARENA_CHUNK_HEADER + size);
+
+	if(chunk == NULL)
+	{
+		return NULL;
+	}
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	return chunk;
+}
+
+void __metadata_extractor_arena_init(metadata_extractor_arena_s *arena, const metadata_extractor_allocator_s *allocator)
+{
+	arena->chunk = NULL;
+	arena->allocator = allocator;
+	pthread_mutex_init(&arena->lock, NULL);
+}
+
+static void *__metadata_extractor_arena_bump(metadata_extractor_arena_chunk_s *chunk, size_t size)
+{
+	size_t used = __atomic_load_n(&chunk->used, __ATOMIC_RELAXED);
+
+	do
+	{
+		if(chunk->size - used < size)
+		{
+			return NULL;
+		}
+	} while(!__atomic_compare_exchange_n(&chunk->used, &used, used + size, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	return (char *)chunk + ARENA_CHUNK_HEADER + used;
+}
+
+void *__metadata_extractor_arena_alloc(metadata_extractor_arena_s *arena, size_t size)
+{
+	metadata_extractor_arena_chunk_s *chunk = NULL;
+	void *ptr = NULL;
+
+	size = ARENA_ALIGN_UP((size > 0) ? size : 1);
+
+	/* concurrent readers bump the head chunk without the lock; the lock only guards the chunk list */
+	if(size <= ARENA_CHUNK_SIZE / 4)
+	{
+		chunk = __atomic_load_n(&arena->chunk, __ATOMIC_ACQUIRE);
+		if(chunk != NULL)
+		{
+			ptr = __metadata_extractor_arena_bump(chunk, size);
+			if(ptr != NULL)
+			{
+				return ptr;
+			}
+		}
+	}
+
+	pthread_mutex_lock(&arena->lock);
+
+	if(size > ARENA_CHUNK_SIZE / 4)
+	{
+		chunk = __metadata_extractor_arena_new_chunk(arena, size);
+		if(chunk != NULL)
+		{
+			chunk->used = size;
+			if(arena->chunk != NULL)
+			{
+				chunk->next = arena->chunk->next;
+				arena->chunk->next = chunk;
+			}
+			else
+			{
+				__atomic_store_n(&arena->chunk, chunk, __ATOMIC_RELEASE);
+			}
+			ptr = (char *)chunk + ARENA_CHUNK_HEADER;
+		}
+
+		pthread_mutex_unlock(&arena->lock);
+		return ptr;
+	}
+
+	/* another thread may have added a chunk while we waited */
+	chunk = arena->chunk;
+	if(chunk != NULL)
+	{
+		ptr = __metadata_extractor_arena_bump(chunk, size);
+	}
+
+	if(ptr == NULL)
+	{
+		chunk = __metadata_extractor_arena_new_chunk(arena, ARENA_CHUNK_SIZE);
+		if(chunk != NULL)
+		{
+			chunk->used = size;
+			chunk->next = arena->chunk;
+			ptr = (char *)chunk + ARENA_CHUNK_HEADER;
+			__atomic_store_n(&arena->chunk, chunk, __ATOMIC_RELEASE);
+		}
+	}
+
+	pthread_mutex_unlock(&arena->lock);
+
+	return ptr;
+}
+
+void __metadata_extractor_arena_reset(metadata_extractor_arena_s *arena)
+{
+	metadata_extractor_arena_chunk_s *chunk = NULL;
+	metadata_extractor_arena_chunk_s *keep = NULL;
+
+	pthread_mutex_lock(&arena->lock);
+
+	chunk = arena->chunk;
+	while(chunk != NULL)
+	{
+		metadata_extractor_arena_chunk_s *next = chunk->next;
+
+		if((keep == NULL) && (chunk->size == ARENA_CHUNK_SIZE))
+		{
+			keep = chunk;
+			keep->next = NULL;
+			keep->used = 0;
+		}
+		else
+		{
+			__metadata_extractor_allocator_free(arena->allocator, chunk);
+		}
+		chunk = next;
+	}
+	arena->chunk = keep;
+
+	pthread_mutex_unlock(&arena->lock);
+}
+
+void __metadata_extractor_arena_release(metadata_extractor_arena_s *arena)
+{
+	metadata_extractor_arena_chunk_s *chunk = arena->chunk;
+
+	while(chunk != NULL)
+	{
+		metadata_extractor_arena_chunk_s *next = chunk->next;
+		__metadata_extractor_allocator_free(arena->allocator, chunk);
+		chunk = next;
+	}
+	arena->chunk = NULL;
+
+	pthread_mutex_destroy(&arena->lock);
+}
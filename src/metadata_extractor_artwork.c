@@ -0,0 +1,561 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define ARTWORK_FRAME_PREFIX	1024	/* APIC header read to find the picture: encoding, mime, type, description */
+#define ARTWORK_FRONT_COVER		3		/* picture type shared by ID3v2 APIC and FLAC PICTURE */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * Finds where the embedded picture lies in the file, for the pictures stored as plain bytes: ID3v2 APIC/PIC frames
+ * without unsynchronisation, compression or encryption, FLAC PICTURE blocks and MP4 covr atoms. Only the headers are
+ * read, with pread(), never the picture itself. A front cover is preferred over the other pictures of a tag.
+ */
+typedef struct
+{
+	int fd;
+	unsigned long long size;
+}metadata_extractor_artwork_file_s;
+
+typedef struct
+{
+	unsigned long long offset;
+	unsigned long long size;
+	int type;					/* picture type, -1 when the format has none */
+	char mime[METADATA_EXTRACTOR_ARTWORK_MIME_MAX];
+	bool found;
+}metadata_extractor_artwork_candidate_s;
+
+static bool __metadata_extractor_artwork_read(const metadata_extractor_artwork_file_s *file, unsigned long long offset, void *buffer, size_t length)
+{
+	size_t done = 0;
+
+	if((offset > file->size) || (length > file->size - offset))
+	{
+		return false;
+	}
+
+	while(done < length)
+	{
+		ssize_t read_size = pread(file->fd, (char *)buffer + done, length - done, offset + done);
+
+		if(read_size <= 0)
+		{
+			return false;
+		}
+		done += read_size;
+	}
+
+	return true;
+}
+
+static unsigned int __metadata_extractor_artwork_be32(const unsigned char *data)
+{
+	return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) | ((unsigned int)data[2] << 8) | data[3];
+}
+
+static unsigned int __metadata_extractor_artwork_syncsafe(const unsigned char *data)
+{
+	return ((unsigned int)(data[0] & 0x7f) << 21) | ((unsigned int)(data[1] & 0x7f) << 14) | ((unsigned int)(data[2] & 0x7f) << 7) | (data[3] & 0x7f);
+}
+
+/* mime type from the first bytes of the picture, for tags that do not give one */
+static void __metadata_extractor_artwork_sniff(const metadata_extractor_artwork_file_s *file, metadata_extractor_artwork_candidate_s *candidate)
+{
+	unsigned char magic[8];
+
+	if(!__metadata_extractor_artwork_read(file, candidate->offset, magic, (candidate->size < sizeof(magic)) ? candidate->size : sizeof(magic)))
+	{
+		return;
+	}
+
+	if((candidate->size >= 3) && (magic[0] == 0xff) && (magic[1] == 0xd8) && (magic[2] == 0xff))
+		snprintf(candidate->mime, sizeof(candidate->mime), "image/jpeg");
+	else if((candidate->size >= 8) && (memcmp(magic, "\x89PNG\r\n\x1a\n", 8) == 0))
+		snprintf(candidate->mime, sizeof(candidate->mime), "image/png");
+	else if((candidate->size >= 4) && (memcmp(magic, "GIF8", 4) == 0))
+		snprintf(candidate->mime, sizeof(candidate->mime), "image/gif");
+	else if((candidate->size >= 2) && (memcmp(magic, "BM", 2) == 0))
+		snprintf(candidate->mime, sizeof(candidate->mime), "image/bmp");
+}
+
+/* "JPG", "jpg" and "image/jpg" as written by various taggers all become image/jpeg */
+static void __metadata_extractor_artwork_set_mime(metadata_extractor_artwork_candidate_s *candidate, const char *mime, size_t length)
+{
+	char lower[METADATA_EXTRACTOR_ARTWORK_MIME_MAX];
+	size_t idx = 0;
+
+	if(length >= sizeof(lower))
+	{
+		candidate->mime[0] = '\0';
+		return;
+	}
+
+	for(idx = 0; idx < length; idx++)
+	{
+		lower[idx] = (char)tolower((unsigned char)mime[idx]);
+	}
+	lower[length] = '\0';
+
+	if((strcmp(lower, "jpg") == 0) || (strcmp(lower, "jpeg") == 0) || (strcmp(lower, "image/jpg") == 0))
+		snprintf(candidate->mime, sizeof(candidate->mime), "image/jpeg");
+	else if((length > 0) && (strchr(lower, '/') == NULL) && (length + 6 < sizeof(candidate->mime)))
+	{
+		memcpy(candidate->mime, "image/", 6);
+		memcpy(candidate->mime + 6, lower, length + 1);
+	}
+	else
+		snprintf(candidate->mime, sizeof(candidate->mime), "%s", lower);
+}
+
+/* keeps the first picture, or the front cover once one is found */
+static void __metadata_extractor_artwork_offer(metadata_extractor_artwork_candidate_s *best, const metadata_extractor_artwork_candidate_s *candidate)
+{
+	if(!best->found || ((best->type != ARTWORK_FRONT_COVER) && (candidate->type == ARTWORK_FRONT_COVER)))
+	{
+		*best = *candidate;
+		best->found = true;
+	}
+}
+
+/* body is the start of the APIC (or v2.2 PIC) frame content, length the bytes of it in prefix */
+static bool __metadata_extractor_artwork_parse_apic(const unsigned char *prefix, size_t length, unsigned long long body, unsigned long long body_size, int version, metadata_extractor_artwork_candidate_s *candidate)
+{
+	size_t pos = 1;
+	size_t mime_start = 0;
+	unsigned char encoding = 0;
+
+	if(length < 4)
+	{
+		return false;
+	}
+
+	encoding = prefix[0];
+
+	if(version == 2)
+	{
+		/* three letter image format */
+		__metadata_extractor_artwork_set_mime(candidate, (const char *)prefix + 1, 3);
+		pos = 4;
+	}
+	else
+	{
+		mime_start = pos;
+		while((pos < length) && (prefix[pos] != '\0'))
+			pos++;
+		if(pos == length)
+			return false;
+
+		/* "-->" marks a link to the picture, not the picture */
+		if((pos - mime_start == 3) && (memcmp(prefix + mime_start, "-->", 3) == 0))
+			return false;
+
+		__metadata_extractor_artwork_set_mime(candidate, (const char *)prefix + mime_start, pos - mime_start);
+		pos++;
+	}
+
+	if(pos >= length)
+	{
+		return false;
+	}
+	candidate->type = prefix[pos++];
+
+	/* description, terminated by one NUL in ISO-8859-1 and UTF-8, by two in UTF-16 */
+	if((encoding == 1) || (encoding == 2))
+	{
+		while((pos + 1 < length) && ((prefix[pos] != '\0') || (prefix[pos + 1] != '\0')))
+			pos += 2;
+		if(pos + 1 >= length)
+			return false;
+		pos += 2;
+	}
+	else
+	{
+		while((pos < length) && (prefix[pos] != '\0'))
+			pos++;
+		if(pos >= length)
+			return false;
+		pos++;
+	}
+
+	if(pos >= body_size)
+	{
+		return false;
+	}
+
+	candidate->offset = body + pos;
+	candidate->size = body_size - pos;
+
+	return true;
+}
+
+/* *tag_end is set to the end of the tag, also when it holds no usable picture */
+static void __metadata_extractor_artwork_locate_id3v2(const metadata_extractor_artwork_file_s *file, metadata_extractor_artwork_candidate_s *best, unsigned long long *tag_end)
+{
+	unsigned char header[10];
+	unsigned char prefix[ARTWORK_FRAME_PREFIX];
+	unsigned long long pos = 10;
+	unsigned long long end = 0;
+	int version = 0;
+	unsigned char flags = 0;
+
+	*tag_end = 0;
+
+	if(!__metadata_extractor_artwork_read(file, 0, header, sizeof(header)) || (memcmp(header, "ID3", 3) != 0))
+	{
+		return;
+	}
+
+	version = header[3];
+	flags = header[5];
+	end = 10 + (unsigned long long)__metadata_extractor_artwork_syncsafe(header + 6);
+	*tag_end = end + (((version == 4) && (flags & 0x10)) ? 10 : 0);
+
+	/* unsynchronisation of the whole tag changes the picture bytes; v2.2 compression has no defined scheme */
+	if((version < 2) || (version > 4) || (flags & 0x80) || ((version == 2) && (flags & 0x40)))
+	{
+		return;
+	}
+
+	if(end > file->size)
+	{
+		end = file->size;
+	}
+
+	if(flags & 0x40)
+	{
+		unsigned char extended[4];
+
+		if(!__metadata_extractor_artwork_read(file, pos, extended, sizeof(extended)))
+			return;
+		/* v2.3 gives the size without these 4 bytes, v2.4 as syncsafe with them */
+		pos += (version == 3) ? 4 + (unsigned long long)__metadata_extractor_artwork_be32(extended) : __metadata_extractor_artwork_syncsafe(extended);
+	}
+
+	while(pos + ((version == 2) ? 6 : 10) <= end)
+	{
+		unsigned char frame[10];
+		unsigned long long frame_size = 0;
+		unsigned long long body = 0;
+		unsigned long long body_size = 0;
+		size_t header_size = (version == 2) ? 6 : 10;
+		bool picture = false;
+		bool plain = true;
+
+		if(!__metadata_extractor_artwork_read(file, pos, frame, header_size) || (frame[0] == '\0'))
+		{
+			/* padding */
+			break;
+		}
+
+		if(version == 2)
+		{
+			frame_size = ((unsigned int)frame[3] << 16) | ((unsigned int)frame[4] << 8) | frame[5];
+			picture = (memcmp(frame, "PIC", 3) == 0);
+		}
+		else
+		{
+			frame_size = (version == 3) ? __metadata_extractor_artwork_be32(frame + 4) : __metadata_extractor_artwork_syncsafe(frame + 4);
+			picture = (memcmp(frame, "APIC", 4) == 0);
+		}
+
+		if((frame_size == 0) || (pos + header_size + frame_size > end))
+		{
+			break;
+		}
+
+		body = pos + header_size;
+		body_size = frame_size;
+
+		if(version == 3)
+		{
+			/* compression, encryption; a group id byte precedes the content */
+			plain = !(frame[9] & 0xc0);
+			if(frame[9] & 0x20)
+			{
+				body++;
+				body_size--;
+			}
+		}
+		else if(version == 4)
+		{
+			/* compression, encryption, unsynchronisation; group id and data length indicator precede the content */
+			plain = !(frame[9] & 0x0e);
+			if(frame[9] & 0x40)
+			{
+				body++;
+				body_size--;
+			}
+			if((frame[9] & 0x01) && (body_size >= 4))
+			{
+				body += 4;
+				body_size -= 4;
+			}
+		}
+
+		if(picture && plain && (body_size > 0))
+		{
+			metadata_extractor_artwork_candidate_s candidate;
+			size_t length = (body_size < sizeof(prefix)) ? (size_t)body_size : sizeof(prefix);
+
+			memset(&candidate, 0, sizeof(candidate));
+			if(__metadata_extractor_artwork_read(file, body, prefix, length) &&
+				__metadata_extractor_artwork_parse_apic(prefix, length, body, body_size, version, &candidate))
+			{
+				__metadata_extractor_artwork_offer(best, &candidate);
+				if(best->type == ARTWORK_FRONT_COVER)
+					return;
+			}
+		}
+
+		pos += header_size + frame_size;
+	}
+}
+
+static void __metadata_extractor_artwork_locate_flac(const metadata_extractor_artwork_file_s *file, unsigned long long pos, metadata_extractor_artwork_candidate_s *best)
+{
+	unsigned char magic[4];
+	bool last = false;
+
+	if(!__metadata_extractor_artwork_read(file, pos, magic, sizeof(magic)) || (memcmp(magic, "fLaC", 4) != 0))
+	{
+		return;
+	}
+	pos += 4;
+
+	while(!last)
+	{
+		unsigned char header[4];
+		unsigned long long block_size = 0;
+
+		if(!__metadata_extractor_artwork_read(file, pos, header, sizeof(header)))
+			return;
+
+		last = (header[0] & 0x80);
+		block_size = ((unsigned int)header[1] << 16) | ((unsigned int)header[2] << 8) | header[3];
+		pos += 4;
+
+		if(pos + block_size > file->size)
+			return;
+
+		if((header[0] & 0x7f) == 6)
+		{
+			/* picture type, mime length, mime, description length, description, width, height, depth, colors, data length */
+			metadata_extractor_artwork_candidate_s candidate;
+			unsigned char field[8];
+			char mime[METADATA_EXTRACTOR_ARTWORK_MIME_MAX];
+			unsigned long long field_pos = pos;
+			unsigned int mime_length = 0;
+			unsigned int description_length = 0;
+			unsigned int data_length = 0;
+
+			memset(&candidate, 0, sizeof(candidate));
+
+			if(!__metadata_extractor_artwork_read(file, field_pos, field, 8))
+				return;
+			candidate.type = __metadata_extractor_artwork_be32(field);
+			mime_length = __metadata_extractor_artwork_be32(field + 4);
+			field_pos += 8;
+
+			if((mime_length < sizeof(mime)) && __metadata_extractor_artwork_read(file, field_pos, mime, mime_length) &&
+				__metadata_extractor_artwork_read(file, field_pos + mime_length, field, 4))
+			{
+				__metadata_extractor_artwork_set_mime(&candidate, mime, mime_length);
+				description_length = __metadata_extractor_artwork_be32(field);
+				field_pos += mime_length + 4 + (unsigned long long)description_length + 16;
+
+				if(__metadata_extractor_artwork_read(file, field_pos, field, 4))
+				{
+					data_length = __metadata_extractor_artwork_be32(field);
+					field_pos += 4;
+
+					if((data_length > 0) && (field_pos + data_length <= pos + block_size))
+					{
+						candidate.offset = field_pos;
+						candidate.size = data_length;
+						__metadata_extractor_artwork_offer(best, &candidate);
+						if(best->type == ARTWORK_FRONT_COVER)
+							return;
+					}
+				}
+			}
+		}
+
+		pos += block_size;
+	}
+}
+
+/* the child atom of the given type in [start, end), by its payload range */
+static bool __metadata_extractor_artwork_find_atom(const metadata_extractor_artwork_file_s *file, unsigned long long start, unsigned long long end, const char *type, unsigned long long *payload, unsigned long long *payload_end)
+{
+	unsigned long long pos = start;
+
+	while(pos + 8 <= end)
+	{
+		unsigned char header[16];
+		unsigned long long size = 0;
+		unsigned int header_size = 8;
+
+		if(!__metadata_extractor_artwork_read(file, pos, header, 8))
+			return false;
+
+		size = __metadata_extractor_artwork_be32(header);
+		if(size == 1)
+		{
+			if(!__metadata_extractor_artwork_read(file, pos + 8, header + 8, 8))
+				return false;
+			size = ((unsigned long long)__metadata_extractor_artwork_be32(header + 8) << 32) | __metadata_extractor_artwork_be32(header + 12);
+			header_size = 16;
+		}
+		else if(size == 0)
+		{
+			/* up to the end of the enclosing atom */
+			size = end - pos;
+		}
+
+		if((size < header_size) || (size > end - pos))
+			return false;
+
+		if(memcmp(header + 4, type, 4) == 0)
+		{
+			*payload = pos + header_size;
+			*payload_end = pos + size;
+			return true;
+		}
+
+		pos += size;
+	}
+
+	return false;
+}
+
+static void __metadata_extractor_artwork_locate_mp4(const metadata_extractor_artwork_file_s *file, metadata_extractor_artwork_candidate_s *best)
+{
+	static const char *path[] = { "moov", "udta", "meta", "ilst", "covr", "data" };
+	unsigned long long start = 0;
+	unsigned long long end = file->size;
+	unsigned char data[8];
+	unsigned int idx = 0;
+	metadata_extractor_artwork_candidate_s candidate;
+
+	if(!__metadata_extractor_artwork_read(file, 4, data, 4) || (memcmp(data, "ftyp", 4) != 0))
+	{
+		return;
+	}
+
+	for(idx = 0; idx < sizeof(path) / sizeof(path[0]); idx++)
+	{
+		if(!__metadata_extractor_artwork_find_atom(file, start, end, path[idx], &start, &end))
+			return;
+
+		if(strcmp(path[idx], "meta") == 0)
+		{
+			/* a full box in MP4, a plain atom in QuickTime: its first child is hdlr either way */
+			if(!__metadata_extractor_artwork_read(file, start + 4, data, 4))
+				return;
+			if(memcmp(data, "hdlr", 4) != 0)
+				start += 4;
+		}
+	}
+
+	/* data: type indicator, locale, then the picture */
+	if((end - start <= 8) || !__metadata_extractor_artwork_read(file, start, data, 8))
+	{
+		return;
+	}
+
+	memset(&candidate, 0, sizeof(candidate));
+	candidate.type = -1;
+	candidate.offset = start + 8;
+	candidate.size = end - start - 8;
+
+	switch(__metadata_extractor_artwork_be32(data) & 0xffffff)
+	{
+		case 13: snprintf(candidate.mime, sizeof(candidate.mime), "image/jpeg"); break;
+		case 14: snprintf(candidate.mime, sizeof(candidate.mime), "image/png"); break;
+		case 27: snprintf(candidate.mime, sizeof(candidate.mime), "image/bmp"); break;
+		default: break;
+	}
+
+	__metadata_extractor_artwork_offer(best, &candidate);
+}
+
+int __metadata_extractor_artwork_locate(const char *path, metadata_extractor_artwork_location_s *location)
+{
+	metadata_extractor_artwork_file_s file;
+	metadata_extractor_artwork_candidate_s best;
+	struct stat st;
+	unsigned long long tag_end = 0;
+
+	memset(location, 0, sizeof(metadata_extractor_artwork_location_s));
+	memset(&best, 0, sizeof(best));
+
+	file.fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(file.fd < 0)
+	{
+		LOGE("[%s]FILE_NOT_EXISTS(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_FILE_EXISTS);
+		return METADATA_EXTRACTOR_ERROR_FILE_EXISTS;
+	}
+
+	if(fstat(file.fd, &st) != 0)
+	{
+		close(file.fd);
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+	file.size = st.st_size;
+
+	__metadata_extractor_artwork_locate_id3v2(&file, &best, &tag_end);
+	if(!best.found)
+	{
+		/* FLAC may follow an ID3v2 tag */
+		__metadata_extractor_artwork_locate_flac(&file, tag_end, &best);
+	}
+	if(!best.found)
+	{
+		__metadata_extractor_artwork_locate_mp4(&file, &best);
+	}
+
+	if(best.found)
+	{
+		if(best.mime[0] == '\0')
+		{
+			__metadata_extractor_artwork_sniff(&file, &best);
+		}
+
+		location->offset = best.offset;
+		location->size = best.size;
+		memcpy(location->mime, best.mime, sizeof(location->mime));
+	}
+
+	close(file.fd);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
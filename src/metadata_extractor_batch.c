@@ -0,0 +1,677 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define BATCH_INITIAL_ROWS		64
+#define BATCH_INITIAL_DATA		1024
+#define BATCH_INITIAL_ARTWORKS	16
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/* grow an aligned buffer, the new tail is zeroed */
+static int __metadata_extractor_batch_grow_aligned(void **buffer, size_t old_size, size_t new_size)
+{
+	void *new_buffer = NULL;
+
+	if(posix_memalign(&new_buffer, METADATA_EXTRACTOR_BATCH_ALIGN, new_size) != 0)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	if(*buffer != NULL)
+	{
+		memcpy(new_buffer, *buffer, old_size);
+		free(*buffer);
+	}
+	else
+	{
+		old_size = 0;
+	}
+	memset((char *)new_buffer + old_size, 0, new_size - old_size);
+	*buffer = new_buffer;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_batch_grow_column(metadata_extractor_batch_column_s *column, metadata_extractor_record_type_e type, int old_rows, int new_rows)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	void *buffer = NULL;
+
+	/* validity is padded to the alignment, as Arrow expects */
+	buffer = column->validity;
+	ret = __metadata_extractor_batch_grow_aligned(&buffer, old_rows / 8, new_rows / 8);
+	column->validity = (unsigned char *)buffer;
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if(type == METADATA_EXTRACTOR_RECORD_STRING)
+	{
+		buffer = column->offsets;
+		ret = __metadata_extractor_batch_grow_aligned(&buffer, (old_rows + 1) * sizeof(int), (new_rows + 1) * sizeof(int));
+		column->offsets = (int *)buffer;
+		if((ret != METADATA_EXTRACTOR_ERROR_NONE) || (column->ids == NULL))
+		{
+			return ret;
+		}
+
+		buffer = column->ids;
+		ret = __metadata_extractor_batch_grow_aligned(&buffer, old_rows * sizeof(int), new_rows * sizeof(int));
+		column->ids = (int *)buffer;
+		return ret;
+	}
+
+	buffer = column->values;
+	ret = __metadata_extractor_batch_grow_aligned(&buffer,
+		old_rows * ((type == METADATA_EXTRACTOR_RECORD_DOUBLE) ? sizeof(double) : sizeof(int)),
+		new_rows * ((type == METADATA_EXTRACTOR_RECORD_DOUBLE) ? sizeof(double) : sizeof(int)));
+	column->values = buffer;
+
+	return ret;
+}
+
+static int __metadata_extractor_batch_reserve(metadata_extractor_batch_s *batch, int rows)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int capacity = (batch->capacity > 0) ? batch->capacity : BATCH_INITIAL_ROWS;
+	int attr = 0;
+
+	if(rows <= batch->capacity)
+	{
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	while(capacity < rows)
+	{
+		if(capacity > INT_MAX / 2)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		capacity *= 2;
+	}
+
+	/* a failure leaves some columns larger than the capacity, which the next try copes with */
+	ret = __metadata_extractor_batch_grow_column(&batch->path, METADATA_EXTRACTOR_RECORD_STRING, batch->capacity, capacity);
+	for(attr = 0; (ret == METADATA_EXTRACTOR_ERROR_NONE) && (attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT); attr++)
+	{
+		ret = __metadata_extractor_batch_grow_column(&batch->columns[attr], __metadata_extractor_record_attr_type((metadata_extractor_attr_e)attr), batch->capacity, capacity);
+	}
+
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		void *buffer = batch->artwork.validity;
+
+		ret = __metadata_extractor_batch_grow_aligned(&buffer, batch->capacity / 8, capacity / 8);
+		batch->artwork.validity = (unsigned char *)buffer;
+	}
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		ret = __metadata_extractor_batch_grow_aligned(&batch->artwork.values,
+			batch->capacity * sizeof(unsigned long long), capacity * sizeof(unsigned long long));
+	}
+
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		batch->capacity = capacity;
+	}
+
+	return ret;
+}
+
+/* the slot of digest, or the empty slot where it goes */
+static metadata_extractor_batch_artwork_s *__metadata_extractor_batch_find_artwork(metadata_extractor_batch_s *batch, unsigned long long digest)
+{
+	unsigned int slot = (unsigned int)digest & batch->artwork_mask;
+
+	while((batch->artworks[slot].data != NULL) && (batch->artworks[slot].digest != digest))
+	{
+		slot = (slot + 1) & batch->artwork_mask;
+	}
+
+	return &batch->artworks[slot];
+}
+
+static int __metadata_extractor_batch_grow_artworks(metadata_extractor_batch_s *batch)
+{
+	metadata_extractor_batch_artwork_s *old_artworks = batch->artworks;
+	unsigned int old_size = (old_artworks != NULL) ? batch->artwork_mask + 1 : 0;
+	unsigned int new_size = (old_size > 0) ? old_size * 2 : BATCH_INITIAL_ARTWORKS;
+	unsigned int idx = 0;
+
+	batch->artworks = (metadata_extractor_batch_artwork_s *)calloc(new_size, sizeof(metadata_extractor_batch_artwork_s));
+	if(batch->artworks == NULL)
+	{
+		batch->artworks = old_artworks;
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+	batch->artwork_mask = new_size - 1;
+
+	for(idx = 0; idx < old_size; idx++)
+	{
+		if(old_artworks[idx].data != NULL)
+			*__metadata_extractor_batch_find_artwork(batch, old_artworks[idx].digest) = old_artworks[idx];
+	}
+	free(old_artworks);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* the tracks of an album mostly carry the same cover, it is copied for the first one only */
+static int __metadata_extractor_batch_add_artwork(metadata_extractor_batch_s *batch, const void *artwork, int size, const char *mime, unsigned long long *digest)
+{
+	metadata_extractor_batch_artwork_s *slot = NULL;
+	unsigned long long _digest = __metadata_extractor_xxh64(artwork, size, 0);
+
+	if((batch->artworks == NULL) || ((unsigned int)(batch->artwork_count + 1) * 2 > batch->artwork_mask + 1))
+	{
+		if(__metadata_extractor_batch_grow_artworks(batch) != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	slot = __metadata_extractor_batch_find_artwork(batch, _digest);
+	if(slot->data == NULL)
+	{
+		slot->data = malloc(size);
+		if(slot->data == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		memcpy(slot->data, artwork, size);
+		slot->mime = ((mime != NULL) && (mime[0] != '\0')) ? strdup(mime) : NULL;
+		slot->digest = _digest;
+		slot->size = size;
+		batch->artwork_count++;
+	}
+
+	*digest = _digest;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static void __metadata_extractor_batch_release_artworks(metadata_extractor_batch_s *batch)
+{
+	unsigned int idx = 0;
+
+	if(batch->artworks == NULL)
+	{
+		return;
+	}
+
+	for(idx = 0; idx <= batch->artwork_mask; idx++)
+	{
+		SAFE_FREE(batch->artworks[idx].data);
+		SAFE_FREE(batch->artworks[idx].mime);
+	}
+	batch->artwork_count = 0;
+}
+
+static void __metadata_extractor_batch_set_valid(metadata_extractor_batch_column_s *column, int row, bool valid)
+{
+	if(valid)
+		column->validity[row >> 3] |= (unsigned char)(1 << (row & 7));
+	else
+		column->validity[row >> 3] &= (unsigned char)~(1 << (row & 7));
+}
+
+static int __metadata_extractor_batch_append_string(metadata_extractor_batch_column_s *column, int row, const char *value)
+{
+	size_t length = (value != NULL) ? strlen(value) : 0;
+	size_t capacity = column->data_capacity;
+
+	if(column->intern != NULL)
+	{
+		int id = -1;
+
+		if((value != NULL) && (metadata_extractor_intern_add(column->intern, value, -1, &id) != METADATA_EXTRACTOR_ERROR_NONE))
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+
+		column->ids[row] = id;
+		column->offsets[row + 1] = (int)column->data_size;
+		__metadata_extractor_batch_set_valid(column, row, value != NULL);
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	if(length > (size_t)INT_MAX - column->data_size)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	if((column->data == NULL) || (column->data_size + length > capacity))
+	{
+		char *data = NULL;
+
+		if(capacity == 0)
+			capacity = BATCH_INITIAL_DATA;
+		while(capacity < column->data_size + length)
+			capacity *= 2;
+
+		data = (char *)realloc(column->data, capacity);
+		if(data == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		column->data = data;
+		column->data_capacity = capacity;
+	}
+
+	if(length > 0)
+	{
+		memcpy(column->data + column->data_size, value, length);
+	}
+	column->data_size += length;
+	column->offsets[row + 1] = (int)column->data_size;
+	__metadata_extractor_batch_set_valid(column, row, value != NULL);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* values NULL appends a row for a file that could not be extracted; artwork is only kept with artwork enabled */
+int __metadata_extractor_batch_append(metadata_extractor_batch_s *batch, const char *path, const metadata_extractor_record_value_s *values, const void *artwork, int artwork_size, const char *artwork_mime)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int row = batch->row_count;
+	int attr = 0;
+	unsigned long long digest = 0;
+
+	ret = __metadata_extractor_batch_reserve(batch, row + 1);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return ret;
+	}
+
+	if(batch->artwork_enabled && (artwork != NULL) && (artwork_size > 0))
+	{
+		ret = __metadata_extractor_batch_add_artwork(batch, artwork, artwork_size, artwork_mime, &digest);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return ret;
+		}
+		((unsigned long long *)batch->artwork.values)[row] = digest;
+		__metadata_extractor_batch_set_valid(&batch->artwork, row, true);
+	}
+	else
+	{
+		((unsigned long long *)batch->artwork.values)[row] = 0;
+		__metadata_extractor_batch_set_valid(&batch->artwork, row, false);
+	}
+
+	ret = __metadata_extractor_batch_append_string(&batch->path, row, path);
+
+	for(attr = 0; (ret == METADATA_EXTRACTOR_ERROR_NONE) && (attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT); attr++)
+	{
+		metadata_extractor_batch_column_s *column = &batch->columns[attr];
+
+		switch(__metadata_extractor_record_attr_type((metadata_extractor_attr_e)attr))
+		{
+			case METADATA_EXTRACTOR_RECORD_INT:
+				((int *)column->values)[row] = (values != NULL) ? values[attr].i_value : 0;
+				__metadata_extractor_batch_set_valid(column, row, values != NULL);
+				break;
+			case METADATA_EXTRACTOR_RECORD_DOUBLE:
+				((double *)column->values)[row] = (values != NULL) ? values[attr].d_value : 0;
+				__metadata_extractor_batch_set_valid(column, row, values != NULL);
+				break;
+			case METADATA_EXTRACTOR_RECORD_STRING:
+				ret = __metadata_extractor_batch_append_string(column, row, (values != NULL) ? values[attr].s_value : NULL);
+				break;
+		}
+	}
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		/* the string data of the partial row is dropped by the next append, which starts from the previous offsets */
+		batch->path.data_size = batch->path.offsets[row];
+		for(attr = 0; attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT; attr++)
+		{
+			if(batch->columns[attr].offsets != NULL)
+				batch->columns[attr].data_size = batch->columns[attr].offsets[row];
+		}
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return ret;
+	}
+
+	batch->row_count++;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static void __metadata_extractor_batch_release_column(metadata_extractor_batch_column_s *column)
+{
+	SAFE_FREE(column->values);
+	SAFE_FREE(column->offsets);
+	SAFE_FREE(column->data);
+	SAFE_FREE(column->validity);
+	SAFE_FREE(column->ids);
+}
+
+int metadata_extractor_batch_create(metadata_extractor_batch_h *batch)
+{
+	metadata_extractor_batch_s *_batch = NULL;
+
+	if(!batch)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_batch = (metadata_extractor_batch_s *)calloc(1, sizeof(metadata_extractor_batch_s));
+	if(_batch == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	if(__metadata_extractor_batch_reserve(_batch, BATCH_INITIAL_ROWS) != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		metadata_extractor_batch_destroy((metadata_extractor_batch_h)_batch);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	*batch = (metadata_extractor_batch_h)_batch;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_clear(metadata_extractor_batch_h batch)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+	int attr = 0;
+
+	if(!_batch)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	/* buffers are kept for the next files; every slot is rewritten by its append */
+	_batch->row_count = 0;
+	_batch->path.data_size = 0;
+	for(attr = 0; attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT; attr++)
+	{
+		_batch->columns[attr].data_size = 0;
+	}
+	/* the table is kept, the artworks go with their rows */
+	__metadata_extractor_batch_release_artworks(_batch);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_destroy(metadata_extractor_batch_h batch)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+	int attr = 0;
+
+	if(!_batch)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	__metadata_extractor_batch_release_column(&_batch->path);
+	for(attr = 0; attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT; attr++)
+	{
+		__metadata_extractor_batch_release_column(&_batch->columns[attr]);
+	}
+	__metadata_extractor_batch_release_column(&_batch->artwork);
+	__metadata_extractor_batch_release_artworks(_batch);
+	SAFE_FREE(_batch->artworks);
+	SAFE_FREE(_batch);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_row_count(metadata_extractor_batch_h batch, int *row_count)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+
+	if((!_batch) || (!row_count))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*row_count = _batch->row_count;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static metadata_extractor_batch_column_s *__metadata_extractor_batch_column(metadata_extractor_batch_s *batch, metadata_extractor_attr_e attribute, metadata_extractor_record_type_e type)
+{
+	if((batch == NULL) || (attribute < 0) || (attribute >= METADATA_EXTRACTOR_RECORD_ATTR_COUNT) ||
+		(__metadata_extractor_record_attr_type(attribute) != type))
+	{
+		return NULL;
+	}
+
+	return &batch->columns[attribute];
+}
+
+int metadata_extractor_batch_get_int_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const int **values, const unsigned char **validity)
+{
+	metadata_extractor_batch_column_s *column = __metadata_extractor_batch_column((metadata_extractor_batch_s *)batch, attribute, METADATA_EXTRACTOR_RECORD_INT);
+
+	if((!column) || (!values))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*values = (const int *)column->values;
+	if(validity != NULL)
+		*validity = column->validity;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_double_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const double **values, const unsigned char **validity)
+{
+	metadata_extractor_batch_column_s *column = __metadata_extractor_batch_column((metadata_extractor_batch_s *)batch, attribute, METADATA_EXTRACTOR_RECORD_DOUBLE);
+
+	if((!column) || (!values))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*values = (const double *)column->values;
+	if(validity != NULL)
+		*validity = column->validity;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_string_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const int **offsets, const char **data, const unsigned char **validity)
+{
+	metadata_extractor_batch_column_s *column = __metadata_extractor_batch_column((metadata_extractor_batch_s *)batch, attribute, METADATA_EXTRACTOR_RECORD_STRING);
+
+	if((!column) || (!offsets) || (!data))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*offsets = column->offsets;
+	*data = column->data;
+	if(validity != NULL)
+		*validity = column->validity;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_set_intern(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, metadata_extractor_intern_h intern)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+	metadata_extractor_batch_column_s *column = __metadata_extractor_batch_column(_batch, attribute, METADATA_EXTRACTOR_RECORD_STRING);
+	void *ids = NULL;
+
+	if((!column) || (_batch->row_count > 0))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(intern == NULL)
+	{
+		SAFE_FREE(column->ids);
+		column->intern = NULL;
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	if(column->ids == NULL)
+	{
+		if(__metadata_extractor_batch_grow_aligned(&ids, 0, _batch->capacity * sizeof(int)) != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		column->ids = (int *)ids;
+	}
+	column->intern = intern;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_id_column(metadata_extractor_batch_h batch, metadata_extractor_attr_e attribute, const int **ids, const unsigned char **validity)
+{
+	metadata_extractor_batch_column_s *column = __metadata_extractor_batch_column((metadata_extractor_batch_s *)batch, attribute, METADATA_EXTRACTOR_RECORD_STRING);
+
+	if((!column) || (!column->intern) || (!ids))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*ids = column->ids;
+	if(validity != NULL)
+		*validity = column->validity;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_path_column(metadata_extractor_batch_h batch, const int **offsets, const char **data)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+
+	if((!_batch) || (!offsets) || (!data))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*offsets = _batch->path.offsets;
+	*data = _batch->path.data;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_set_artwork_enabled(metadata_extractor_batch_h batch, bool enable)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+
+	if((!_batch) || (_batch->row_count > 0))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_batch->artwork_enabled = enable;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_artwork_column(metadata_extractor_batch_h batch, const unsigned long long **digests, const unsigned char **validity)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+
+	if((!_batch) || (!digests))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*digests = (const unsigned long long *)_batch->artwork.values;
+	if(validity != NULL)
+		*validity = _batch->artwork.validity;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_artwork_count(metadata_extractor_batch_h batch, int *artwork_count)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+
+	if((!_batch) || (!artwork_count))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*artwork_count = _batch->artwork_count;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_batch_get_artwork(metadata_extractor_batch_h batch, unsigned long long digest, const void **artwork, int *size, const char **mime_type)
+{
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+	metadata_extractor_batch_artwork_s *slot = NULL;
+
+	if((!_batch) || (!artwork) || (!size) || (!mime_type))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(_batch->artworks != NULL)
+	{
+		slot = __metadata_extractor_batch_find_artwork(_batch, digest);
+	}
+
+	if((slot != NULL) && (slot->data != NULL))
+	{
+		*artwork = slot->data;
+		*size = slot->size;
+		*mime_type = slot->mime;
+	}
+	else
+	{
+		*artwork = NULL;
+		*size = 0;
+		*mime_type = NULL;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
@@ -0,0 +1,275 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define FINGERPRINT_READ_SIZE	(1024 * 1024)
+
+/* MMFileFormatType values, as returned by __metadata_extractor_mmap_format() */
+#define FINGERPRINT_FORMAT_3GP	0
+#define FINGERPRINT_FORMAT_MP4	4
+#define FINGERPRINT_FORMAT_QT	7
+#define FINGERPRINT_FORMAT_FLAC	24
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+typedef struct
+{
+	int fd;
+	unsigned char *buffer;		/* FINGERPRINT_READ_SIZE */
+	metadata_extractor_xxh64_s state;
+}metadata_extractor_fingerprint_reader_s;
+
+static bool __metadata_extractor_fingerprint_read(int fd, unsigned long long offset, void *buffer, size_t size)
+{
+	return pread(fd, buffer, size, (off_t)offset) == (ssize_t)size;
+}
+
+static unsigned int __metadata_extractor_fingerprint_syncsafe(const unsigned char *p)
+{
+	return ((unsigned int)(p[0] & 0x7f) << 21) | ((unsigned int)(p[1] & 0x7f) << 14) | ((unsigned int)(p[2] & 0x7f) << 7) | (p[3] & 0x7f);
+}
+
+/* narrows [start, end) to what lies between the leading and trailing tag blocks */
+static void __metadata_extractor_fingerprint_strip_tags(int fd, unsigned long long *start, unsigned long long *end)
+{
+	unsigned char header[32];
+	bool stripped = true;
+
+	/* ID3v2, possibly more than one */
+	while((*end - *start >= 10) && __metadata_extractor_fingerprint_read(fd, *start, header, 10) && (memcmp(header, "ID3", 3) == 0))
+	{
+		unsigned long long tag_size = 10 + (unsigned long long)__metadata_extractor_fingerprint_syncsafe(header + 6);
+
+		if(header[5] & 0x10)
+			tag_size += 10;		/* footer */
+		if(tag_size > *end - *start)
+			break;
+		*start += tag_size;
+	}
+
+	/* ID3v1, APEv2 and an appended ID3v2, in whatever order the taggers left them */
+	while(stripped)
+	{
+		stripped = false;
+
+		if((*end - *start >= 128) && __metadata_extractor_fingerprint_read(fd, *end - 128, header, 3) && (memcmp(header, "TAG", 3) == 0))
+		{
+			*end -= 128;
+			stripped = true;
+		}
+
+		if((*end - *start >= 32) && __metadata_extractor_fingerprint_read(fd, *end - 32, header, 32) && (memcmp(header, "APETAGEX", 8) == 0))
+		{
+			/* the size counts the items and the footer; bit 31 of the flags tells whether a header precedes them */
+			unsigned long long tag_size = (unsigned long long)header[12] | ((unsigned long long)header[13] << 8) |
+				((unsigned long long)header[14] << 16) | ((unsigned long long)header[15] << 24);
+
+			if(header[23] & 0x80)
+				tag_size += 32;
+			if((tag_size >= 32) && (tag_size <= *end - *start))
+			{
+				*end -= tag_size;
+				stripped = true;
+			}
+		}
+
+		if((*end - *start >= 10) && __metadata_extractor_fingerprint_read(fd, *end - 10, header, 10) && (memcmp(header, "3DI", 3) == 0))
+		{
+			unsigned long long tag_size = 20 + (unsigned long long)__metadata_extractor_fingerprint_syncsafe(header + 6);
+
+			if(tag_size <= *end - *start)
+			{
+				*end -= tag_size;
+				stripped = true;
+			}
+		}
+	}
+}
+
+/* the audio frames after the metadata blocks, where the Vorbis comments and pictures live */
+static void __metadata_extractor_fingerprint_skip_flac_metadata(int fd, unsigned long long *start, unsigned long long end)
+{
+	unsigned long long position = *start + 4;
+	unsigned char header[4];
+
+	while((position + 4 <= end) && __metadata_extractor_fingerprint_read(fd, position, header, 4))
+	{
+		position += 4 + (((unsigned long long)header[1] << 16) | ((unsigned long long)header[2] << 8) | header[3]);
+		if(header[0] & 0x80)
+		{
+			*start = (position < end) ? position : end;
+			return;
+		}
+	}
+}
+
+static int __metadata_extractor_fingerprint_hash(metadata_extractor_fingerprint_reader_s *reader, unsigned long long offset, unsigned long long size)
+{
+	unsigned long long position = offset;
+	unsigned long long end = offset + size;
+
+	while(position < end)
+	{
+		size_t length = (end - position < FINGERPRINT_READ_SIZE) ? (size_t)(end - position) : FINGERPRINT_READ_SIZE;
+		ssize_t done = pread(reader->fd, reader->buffer, length, (off_t)position);
+
+		if(done <= 0)
+		{
+			LOGE("[%s]read failed at %llu", __FUNCTION__, position);
+			return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+		}
+
+		__metadata_extractor_xxh64_update(&reader->state, reader->buffer, done);
+		position += done;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/*
+ * The mdat boxes only: moov carries udta and ilst, and its chunk offsets move whenever a tagger
+ * grows it in front of mdat, so nothing of it survives retagging.
+ */
+static int __metadata_extractor_fingerprint_hash_mdat(metadata_extractor_fingerprint_reader_s *reader, unsigned long long end)
+{
+	unsigned long long position = 0;
+	unsigned char header[16];
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+
+	while((ret == METADATA_EXTRACTOR_ERROR_NONE) && (position + 8 <= end) && __metadata_extractor_fingerprint_read(reader->fd, position, header, 8))
+	{
+		unsigned long long box_size = ((unsigned long long)header[0] << 24) | ((unsigned long long)header[1] << 16) |
+			((unsigned long long)header[2] << 8) | header[3];
+		unsigned long long header_size = 8;
+		int idx = 0;
+
+		if(box_size == 1)
+		{
+			if((position + 16 > end) || !__metadata_extractor_fingerprint_read(reader->fd, position + 8, header + 8, 8))
+				break;
+			box_size = 0;
+			for(idx = 8; idx < 16; idx++)
+				box_size = (box_size << 8) | header[idx];
+			header_size = 16;
+		}
+		else if(box_size == 0)
+		{
+			box_size = end - position;
+		}
+
+		if(box_size < header_size)
+			break;
+		/* a truncated file still gets the rest of its last box hashed */
+		if(box_size > end - position)
+			box_size = end - position;
+
+		if(memcmp(header + 4, "mdat", 4) == 0)
+			ret = __metadata_extractor_fingerprint_hash(reader, position + header_size, box_size - header_size);
+
+		position += box_size;
+	}
+
+	return ret;
+}
+
+int __metadata_extractor_fingerprint_payload(const char *path, int *format, unsigned long long *digest)
+{
+	metadata_extractor_fingerprint_reader_s reader;
+	unsigned char head[16];
+	unsigned long long start = 0;
+	unsigned long long end = 0;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int _format = -1;
+	struct stat st;
+
+	memset(&reader, 0, sizeof(reader));
+
+	reader.fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(reader.fd < 0)
+	{
+		LOGE("[%s]FILE_NOT_EXISTS(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_FILE_EXISTS);
+		return METADATA_EXTRACTOR_ERROR_FILE_EXISTS;
+	}
+
+	if((fstat(reader.fd, &st) != 0) || !S_ISREG(st.st_mode))
+	{
+		close(reader.fd);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+	end = st.st_size;
+
+	reader.buffer = (unsigned char *)malloc(FINGERPRINT_READ_SIZE);
+	if(reader.buffer == NULL)
+	{
+		close(reader.fd);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	/* one pass front to back, the kernel reads ahead in large chunks */
+	posix_fadvise(reader.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	__metadata_extractor_xxh64_init(&reader.state, 0);
+
+	if((end >= 12) && __metadata_extractor_fingerprint_read(reader.fd, 0, head, 12))
+	{
+		_format = __metadata_extractor_mmap_format(head, 12);
+	}
+
+	if((_format == FINGERPRINT_FORMAT_MP4) || (_format == FINGERPRINT_FORMAT_3GP) || (_format == FINGERPRINT_FORMAT_QT))
+	{
+		ret = __metadata_extractor_fingerprint_hash_mdat(&reader, end);
+	}
+	else
+	{
+		__metadata_extractor_fingerprint_strip_tags(reader.fd, &start, &end);
+
+		/* the stream itself, so that a tagged and an untagged copy agree */
+		if((end - start >= 12) && __metadata_extractor_fingerprint_read(reader.fd, start, head, 12))
+		{
+			_format = __metadata_extractor_mmap_format(head, 12);
+		}
+		if(_format == FINGERPRINT_FORMAT_FLAC)
+		{
+			__metadata_extractor_fingerprint_skip_flac_metadata(reader.fd, &start, end);
+		}
+
+		ret = __metadata_extractor_fingerprint_hash(&reader, start, end - start);
+	}
+
+	free(reader.buffer);
+	close(reader.fd);
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	*format = _format;
+	*digest = __metadata_extractor_xxh64_digest(&reader.state);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
@@ -0,0 +1,426 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define INTERN_BLOCK_SIZE		(64 * 1024)
+#define INTERN_INITIAL_SLOTS	1024
+
+#define FNV_OFFSET_BASIS		0xcbf29ce484222325ULL
+#define FNV_PRIME				0x100000001b3ULL
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * Strings live in blocks that are never moved or freed before the table, so the pointers handed out stay valid.
+ * Lookup is open addressing with linear probing over ids, kept at most half full; the hash of each entry is
+ * kept so that growing the slot array does not touch the strings.
+ */
+typedef struct metadata_extractor_intern_block_s
+{
+	struct metadata_extractor_intern_block_s *next;
+	size_t size;
+	size_t used;
+	char data[];
+}metadata_extractor_intern_block_s;
+
+typedef struct
+{
+	const char *value;
+	int length;
+	uint64_t hash;
+}metadata_extractor_intern_entry_s;
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	metadata_extractor_intern_block_s *block;
+	metadata_extractor_intern_entry_s *entries;
+	int count;
+	int capacity;
+	int *slots;					/* id per slot, -1 when empty */
+	unsigned int slot_mask;
+	int *dict_offsets;			/* contiguous copy for metadata_extractor_intern_get_dictionary() */
+	char *dict_data;
+	int dict_count;
+}metadata_extractor_intern_s;
+
+/* FNV-1a, also used for the path keys of the scan journal */
+unsigned long long __metadata_extractor_hash(const char *data, size_t length)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	size_t idx = 0;
+
+	for(idx = 0; idx < length; idx++)
+	{
+		hash ^= (unsigned char)data[idx];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static char *__metadata_extractor_intern_store(metadata_extractor_intern_s *intern, const char *value, int length)
+{
+	metadata_extractor_intern_block_s *block = intern->block;
+	size_t size = (size_t)length + 1;
+	char *str = NULL;
+
+	if((block == NULL) || (block->size - block->used < size))
+	{
+		size_t block_size = (size > INTERN_BLOCK_SIZE / 4) ? size : INTERN_BLOCK_SIZE;
+
+		block = (metadata_extractor_intern_block_s *)malloc(sizeof(metadata_extractor_intern_block_s) + block_size);
+		if(block == NULL)
+		{
+			return NULL;
+		}
+		block->size = block_size;
+		block->used = 0;
+
+		/* a string with a block of its own goes behind the current block, whose free space is kept */
+		if((block_size != INTERN_BLOCK_SIZE) && (intern->block != NULL))
+		{
+			block->next = intern->block->next;
+			intern->block->next = block;
+		}
+		else
+		{
+			block->next = intern->block;
+			intern->block = block;
+		}
+	}
+
+	str = block->data + block->used;
+	memcpy(str, value, length);
+	str[length] = '\0';
+	block->used += size;
+
+	return str;
+}
+
+static int __metadata_extractor_intern_grow_slots(metadata_extractor_intern_s *intern)
+{
+	unsigned int slot_count = (intern->slots != NULL) ? (intern->slot_mask + 1) * 2 : INTERN_INITIAL_SLOTS;
+	int *slots = NULL;
+	int id = 0;
+
+	if(slot_count > INT_MAX / sizeof(int))
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	slots = (int *)malloc(slot_count * sizeof(int));
+	if(slots == NULL)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+	memset(slots, 0xff, slot_count * sizeof(int));
+
+	for(id = 0; id < intern->count; id++)
+	{
+		unsigned int slot = (unsigned int)intern->entries[id].hash & (slot_count - 1);
+
+		while(slots[slot] >= 0)
+		{
+			slot = (slot + 1) & (slot_count - 1);
+		}
+		slots[slot] = id;
+	}
+
+	SAFE_FREE(intern->slots);
+	intern->slots = slots;
+	intern->slot_mask = slot_count - 1;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_intern_add_entry(metadata_extractor_intern_s *intern, const char *value, int length, uint64_t hash, unsigned int slot, int *id)
+{
+	const char *str = NULL;
+
+	if(intern->count == intern->capacity)
+	{
+		int capacity = (intern->capacity > 0) ? intern->capacity * 2 : INTERN_INITIAL_SLOTS / 2;
+		metadata_extractor_intern_entry_s *entries = NULL;
+
+		if(intern->capacity > INT_MAX / 2)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+
+		entries = (metadata_extractor_intern_entry_s *)realloc(intern->entries, capacity * sizeof(metadata_extractor_intern_entry_s));
+		if(entries == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		intern->entries = entries;
+		intern->capacity = capacity;
+	}
+
+	str = __metadata_extractor_intern_store(intern, value, length);
+	if(str == NULL)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	intern->entries[intern->count].value = str;
+	intern->entries[intern->count].length = length;
+	intern->entries[intern->count].hash = hash;
+	intern->slots[slot] = intern->count;
+	*id = intern->count++;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_intern_create(metadata_extractor_intern_h *intern)
+{
+	metadata_extractor_intern_s *_intern = NULL;
+
+	if(!intern)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_intern = (metadata_extractor_intern_s *)calloc(1, sizeof(metadata_extractor_intern_s));
+	if((_intern == NULL) || (__metadata_extractor_intern_grow_slots(_intern) != METADATA_EXTRACTOR_ERROR_NONE))
+	{
+		SAFE_FREE(_intern);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	pthread_mutex_init(&_intern->lock, NULL);
+
+	*intern = (metadata_extractor_intern_h)_intern;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_intern_destroy(metadata_extractor_intern_h intern)
+{
+	metadata_extractor_intern_s *_intern = (metadata_extractor_intern_s *)intern;
+	metadata_extractor_intern_block_s *block = NULL;
+
+	if(!_intern)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	block = _intern->block;
+	while(block != NULL)
+	{
+		metadata_extractor_intern_block_s *next = block->next;
+		free(block);
+		block = next;
+	}
+
+	SAFE_FREE(_intern->entries);
+	SAFE_FREE(_intern->slots);
+	SAFE_FREE(_intern->dict_offsets);
+	SAFE_FREE(_intern->dict_data);
+	pthread_mutex_destroy(&_intern->lock);
+	SAFE_FREE(_intern);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_intern_add(metadata_extractor_intern_h intern, const char *value, int length, int *id)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_intern_s *_intern = (metadata_extractor_intern_s *)intern;
+	uint64_t hash = 0;
+	unsigned int slot = 0;
+
+	if((!_intern) || (!value) || (!id))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(length < 0)
+	{
+		size_t _length = strlen(value);
+
+		if(_length > INT_MAX - 1)
+		{
+			LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+			return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+		}
+		length = (int)_length;
+	}
+
+	hash = __metadata_extractor_hash(value, length);
+
+	pthread_mutex_lock(&_intern->lock);
+
+	/* keep the table at most half full, also when the string turns out to be there already */
+	if((unsigned int)(_intern->count + 1) * 2 > _intern->slot_mask + 1)
+	{
+		if(__metadata_extractor_intern_grow_slots(_intern) != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			pthread_mutex_unlock(&_intern->lock);
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	slot = (unsigned int)hash & _intern->slot_mask;
+	while(_intern->slots[slot] >= 0)
+	{
+		const metadata_extractor_intern_entry_s *entry = &_intern->entries[_intern->slots[slot]];
+
+		if((entry->hash == hash) && (entry->length == length) && (memcmp(entry->value, value, length) == 0))
+		{
+			*id = _intern->slots[slot];
+			pthread_mutex_unlock(&_intern->lock);
+			return METADATA_EXTRACTOR_ERROR_NONE;
+		}
+		slot = (slot + 1) & _intern->slot_mask;
+	}
+
+	ret = __metadata_extractor_intern_add_entry(_intern, value, length, hash, slot, id);
+
+	pthread_mutex_unlock(&_intern->lock);
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+	}
+
+	return ret;
+}
+
+int metadata_extractor_intern_get_string(metadata_extractor_intern_h intern, int id, const char **value, int *length)
+{
+	metadata_extractor_intern_s *_intern = (metadata_extractor_intern_s *)intern;
+
+	if((!_intern) || (!value))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&_intern->lock);
+
+	if((id < 0) || (id >= _intern->count))
+	{
+		pthread_mutex_unlock(&_intern->lock);
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) id [%d]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER, id);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*value = _intern->entries[id].value;
+	if(length != NULL)
+		*length = _intern->entries[id].length;
+
+	pthread_mutex_unlock(&_intern->lock);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_intern_get_count(metadata_extractor_intern_h intern, int *count)
+{
+	metadata_extractor_intern_s *_intern = (metadata_extractor_intern_s *)intern;
+
+	if((!_intern) || (!count))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&_intern->lock);
+	*count = _intern->count;
+	pthread_mutex_unlock(&_intern->lock);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_intern_get_dictionary(metadata_extractor_intern_h intern, const int **offsets, const char **data, int *count)
+{
+	metadata_extractor_intern_s *_intern = (metadata_extractor_intern_s *)intern;
+	size_t data_size = 0;
+	int id = 0;
+
+	if((!_intern) || (!offsets) || (!data) || (!count))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&_intern->lock);
+
+	/* the copy is rebuilt only when strings were added since the last call */
+	if((_intern->dict_offsets == NULL) || (_intern->dict_count != _intern->count))
+	{
+		int *dict_offsets = NULL;
+		char *dict_data = NULL;
+
+		for(id = 0; id < _intern->count; id++)
+		{
+			data_size += _intern->entries[id].length;
+		}
+
+		if(data_size <= INT_MAX)
+		{
+			dict_offsets = (int *)malloc((_intern->count + 1) * sizeof(int));
+			dict_data = (char *)malloc(data_size + 1);
+		}
+		if((dict_offsets == NULL) || (dict_data == NULL))
+		{
+			SAFE_FREE(dict_offsets);
+			SAFE_FREE(dict_data);
+			pthread_mutex_unlock(&_intern->lock);
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+
+		dict_offsets[0] = 0;
+		for(id = 0; id < _intern->count; id++)
+		{
+			memcpy(dict_data + dict_offsets[id], _intern->entries[id].value, _intern->entries[id].length);
+			dict_offsets[id + 1] = dict_offsets[id] + _intern->entries[id].length;
+		}
+
+		SAFE_FREE(_intern->dict_offsets);
+		SAFE_FREE(_intern->dict_data);
+		_intern->dict_offsets = dict_offsets;
+		_intern->dict_data = dict_data;
+		_intern->dict_count = _intern->count;
+	}
+
+	*offsets = _intern->dict_offsets;
+	*data = _intern->dict_data;
+	*count = _intern->dict_count;
+
+	pthread_mutex_unlock(&_intern->lock);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
@@ -0,0 +1,918 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define JOURNAL_MAGIC			0x524a584d	/* "MXJR" */
+#define JOURNAL_VERSION			1
+#define JOURNAL_HEADER_SIZE		16
+#define JOURNAL_INITIAL_SLOTS	1024
+#define JOURNAL_DIRENT_BUFFER	(64 * 1024)
+#define JOURNAL_MAX_THREADS		64
+#define JOURNAL_STAT_CHUNK		256
+
+#define JOURNAL_FLAG_SEEN		0x01
+#define JOURNAL_FLAG_REMOVED	0x02
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * Journal file, a machine-local cache in host byte order:
+ *
+ *   0  uint32 magic "MXJR", uint32 version, uint32 entry count, uint32 string table size
+ *  16  one 48 byte entry per file: path hash, inode, size, mtime in ns, digest (64 bit each),
+ *      path offset and length (32 bit each)
+ *  ..  string table, every path null-terminated
+ *
+ * A scan lists the tree with getdents64(), which reports the type of most entries so that only
+ * files are stat()ed, then stats the files from several threads and compares them with the journal.
+ */
+typedef struct
+{
+	uint64_t path_hash;
+	uint64_t ino;
+	uint64_t size;
+	int64_t mtime;
+	uint64_t digest;
+	uint32_t path_offset;
+	uint32_t path_length;
+}metadata_extractor_journal_entry_s;
+
+typedef struct
+{
+	char *path;
+	metadata_extractor_journal_entry_s *entries;
+	unsigned char *flags;
+	int count;
+	int capacity;
+	char *strings;
+	size_t strings_size;
+	size_t strings_capacity;
+	int *slots;					/* entry per slot, -1 when empty */
+	unsigned int slot_mask;
+}metadata_extractor_journal_s;
+
+struct linux_dirent64
+{
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+};
+
+typedef struct
+{
+	uint64_t ino;
+	uint64_t size;
+	int64_t mtime;
+	bool valid;
+}metadata_extractor_journal_stat_s;
+
+/* files found by the walk */
+typedef struct
+{
+	char *paths;
+	size_t paths_size;
+	size_t paths_capacity;
+	size_t *offsets;
+	metadata_extractor_journal_stat_s *stats;
+	int count;
+	int capacity;
+	int next;					/* next chunk to stat, shared by the stat threads */
+}metadata_extractor_journal_list_s;
+
+static int __metadata_extractor_journal_grow_slots(metadata_extractor_journal_s *journal)
+{
+	unsigned int slot_count = JOURNAL_INITIAL_SLOTS;
+	int *slots = NULL;
+	int idx = 0;
+
+	while(slot_count < (unsigned int)journal->count * 2 + 2)
+	{
+		if(slot_count > INT_MAX / sizeof(int) / 2)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		slot_count *= 2;
+	}
+
+	slots = (int *)malloc(slot_count * sizeof(int));
+	if(slots == NULL)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+	memset(slots, 0xff, slot_count * sizeof(int));
+
+	for(idx = 0; idx < journal->count; idx++)
+	{
+		unsigned int slot = (unsigned int)journal->entries[idx].path_hash & (slot_count - 1);
+
+		while(slots[slot] >= 0)
+		{
+			slot = (slot + 1) & (slot_count - 1);
+		}
+		slots[slot] = idx;
+	}
+
+	SAFE_FREE(journal->slots);
+	journal->slots = slots;
+	journal->slot_mask = slot_count - 1;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_journal_find(metadata_extractor_journal_s *journal, const char *path, size_t length, uint64_t hash)
+{
+	unsigned int slot = (unsigned int)hash & journal->slot_mask;
+
+	while(journal->slots[slot] >= 0)
+	{
+		int idx = journal->slots[slot];
+		const metadata_extractor_journal_entry_s *entry = &journal->entries[idx];
+
+		if(!(journal->flags[idx] & JOURNAL_FLAG_REMOVED) && (entry->path_hash == hash) && (entry->path_length == length) &&
+			(memcmp(journal->strings + entry->path_offset, path, length) == 0))
+		{
+			return idx;
+		}
+		slot = (slot + 1) & journal->slot_mask;
+	}
+
+	return -1;
+}
+
+static int __metadata_extractor_journal_add(metadata_extractor_journal_s *journal, const char *path, size_t length, uint64_t hash, int *index)
+{
+	metadata_extractor_journal_entry_s *entry = NULL;
+	unsigned int slot = 0;
+
+	if((length > UINT32_MAX) || (journal->strings_size + length + 1 > UINT32_MAX) || (journal->count == INT_MAX))
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	if((unsigned int)(journal->count + 1) * 2 > journal->slot_mask + 1)
+	{
+		if(__metadata_extractor_journal_grow_slots(journal) != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	if(journal->count == journal->capacity)
+	{
+		int capacity = (journal->capacity > 0) ? journal->capacity * 2 : JOURNAL_INITIAL_SLOTS / 2;
+		metadata_extractor_journal_entry_s *entries = NULL;
+		unsigned char *flags = NULL;
+
+		if(journal->capacity > INT_MAX / 2)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+
+		entries = (metadata_extractor_journal_entry_s *)realloc(journal->entries, capacity * sizeof(metadata_extractor_journal_entry_s));
+		if(entries == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		journal->entries = entries;
+
+		flags = (unsigned char *)realloc(journal->flags, capacity);
+		if(flags == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		journal->flags = flags;
+		journal->capacity = capacity;
+	}
+
+	if(journal->strings_size + length + 1 > journal->strings_capacity)
+	{
+		size_t capacity = (journal->strings_capacity > 0) ? journal->strings_capacity : 64 * 1024;
+		char *strings = NULL;
+
+		while(capacity < journal->strings_size + length + 1)
+		{
+			capacity *= 2;
+		}
+
+		strings = (char *)realloc(journal->strings, capacity);
+		if(strings == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		journal->strings = strings;
+		journal->strings_capacity = capacity;
+	}
+
+	entry = &journal->entries[journal->count];
+	memset(entry, 0, sizeof(metadata_extractor_journal_entry_s));
+	entry->path_hash = hash;
+	entry->path_offset = (uint32_t)journal->strings_size;
+	entry->path_length = (uint32_t)length;
+	memcpy(journal->strings + journal->strings_size, path, length);
+	journal->strings[journal->strings_size + length] = '\0';
+	journal->strings_size += length + 1;
+	journal->flags[journal->count] = 0;
+
+	slot = (unsigned int)hash & journal->slot_mask;
+	while(journal->slots[slot] >= 0)
+	{
+		slot = (slot + 1) & journal->slot_mask;
+	}
+	journal->slots[slot] = journal->count;
+
+	*index = journal->count++;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* a missing or unreadable journal is not an error, the first scan then reports every file as new */
+static void __metadata_extractor_journal_load(metadata_extractor_journal_s *journal)
+{
+	FILE *fp = NULL;
+	unsigned char header[JOURNAL_HEADER_SIZE];
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t count = 0;
+	uint32_t strings_size = 0;
+	metadata_extractor_journal_entry_s *entries = NULL;
+	char *strings = NULL;
+	uint32_t idx = 0;
+
+	fp = fopen(journal->path, "rb");
+	if(fp == NULL)
+	{
+		return;
+	}
+
+	if(fread(header, 1, sizeof(header), fp) != sizeof(header))
+	{
+		goto invalid;
+	}
+
+	memcpy(&magic, header, 4);
+	memcpy(&version, header + 4, 4);
+	memcpy(&count, header + 8, 4);
+	memcpy(&strings_size, header + 12, 4);
+
+	if((magic != JOURNAL_MAGIC) || (version != JOURNAL_VERSION) || (count > INT_MAX / 2) || (strings_size == 0 && count > 0))
+	{
+		goto invalid;
+	}
+
+	entries = (metadata_extractor_journal_entry_s *)malloc((size_t)count * sizeof(metadata_extractor_journal_entry_s) + 1);
+	strings = (char *)malloc((size_t)strings_size + 1);
+	if((entries == NULL) || (strings == NULL))
+	{
+		goto invalid;
+	}
+
+	if((fread(entries, sizeof(metadata_extractor_journal_entry_s), count, fp) != count) ||
+		(fread(strings, 1, strings_size, fp) != strings_size) || (fgetc(fp) != EOF))
+	{
+		goto invalid;
+	}
+
+	for(idx = 0; idx < count; idx++)
+	{
+		int index = 0;
+		const metadata_extractor_journal_entry_s *entry = &entries[idx];
+
+		if((entry->path_offset >= strings_size) || (entry->path_length >= strings_size - entry->path_offset) ||
+			(strings[entry->path_offset + entry->path_length] != '\0'))
+		{
+			goto invalid;
+		}
+
+		if(__metadata_extractor_journal_add(journal, strings + entry->path_offset, entry->path_length,
+			__metadata_extractor_hash(strings + entry->path_offset, entry->path_length), &index) != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			goto invalid;
+		}
+
+		journal->entries[index].ino = entry->ino;
+		journal->entries[index].size = entry->size;
+		journal->entries[index].mtime = entry->mtime;
+		journal->entries[index].digest = entry->digest;
+	}
+
+	SAFE_FREE(entries);
+	SAFE_FREE(strings);
+	fclose(fp);
+
+	return;
+
+invalid:
+	LOGE("[%s]ERROR_UNKNOWN(0x%08x) ignoring [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, journal->path);
+	SAFE_FREE(entries);
+	SAFE_FREE(strings);
+	fclose(fp);
+	journal->count = 0;
+	journal->strings_size = 0;
+	memset(journal->slots, 0xff, (journal->slot_mask + 1) * sizeof(int));
+}
+
+static int __metadata_extractor_journal_list_add(metadata_extractor_journal_list_s *list, const char *path, size_t length)
+{
+	if(list->count == list->capacity)
+	{
+		int capacity = (list->capacity > 0) ? list->capacity * 2 : 4096;
+		size_t *offsets = NULL;
+
+		if(list->capacity > INT_MAX / 2)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+
+		offsets = (size_t *)realloc(list->offsets, capacity * sizeof(size_t));
+		if(offsets == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		list->offsets = offsets;
+		list->capacity = capacity;
+	}
+
+	if(list->paths_size + length + 1 > list->paths_capacity)
+	{
+		size_t capacity = (list->paths_capacity > 0) ? list->paths_capacity : 256 * 1024;
+		char *paths = NULL;
+
+		while(capacity < list->paths_size + length + 1)
+		{
+			capacity *= 2;
+		}
+
+		paths = (char *)realloc(list->paths, capacity);
+		if(paths == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		list->paths = paths;
+		list->paths_capacity = capacity;
+	}
+
+	list->offsets[list->count++] = list->paths_size;
+	memcpy(list->paths + list->paths_size, path, length);
+	list->paths[list->paths_size + length] = '\0';
+	list->paths_size += length + 1;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* path holds the directory, length its length, 0 for "/"; path is PATH_MAX long and reused for the children */
+static int __metadata_extractor_journal_walk(metadata_extractor_journal_list_s *list, char *path, size_t length, char *buffer)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int fd = -1;
+	long read_size = 0;
+
+	fd = open((length > 0) ? path : "/", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if(fd < 0)
+	{
+		/* an unreadable directory is skipped, as if it were empty */
+		metadata_extractor_debug("[%s] can not open [%s]", __FUNCTION__, path);
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	while((ret == METADATA_EXTRACTOR_ERROR_NONE) && ((read_size = syscall(SYS_getdents64, fd, buffer, JOURNAL_DIRENT_BUFFER)) > 0))
+	{
+		long pos = 0;
+
+		while((ret == METADATA_EXTRACTOR_ERROR_NONE) && (pos < read_size))
+		{
+			struct linux_dirent64 *dirent = (struct linux_dirent64 *)(buffer + pos);
+			size_t name_length = strlen(dirent->d_name);
+			unsigned char type = dirent->d_type;
+
+			pos += dirent->d_reclen;
+
+			if((strcmp(dirent->d_name, ".") == 0) || (strcmp(dirent->d_name, "..") == 0))
+			{
+				continue;
+			}
+
+			if(length + 1 + name_length >= PATH_MAX)
+			{
+				continue;
+			}
+
+			if(type == DT_UNKNOWN)
+			{
+				struct stat st;
+
+				if(fstatat(fd, dirent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+					continue;
+				type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+			}
+
+			if((type != DT_DIR) && (type != DT_REG))
+			{
+				continue;
+			}
+
+			path[length] = '/';
+			memcpy(path + length + 1, dirent->d_name, name_length + 1);
+
+			if(type == DT_REG)
+			{
+				ret = __metadata_extractor_journal_list_add(list, path, length + 1 + name_length);
+			}
+			else
+			{
+				/* buffer still holds the rest of this directory's entries */
+				char *child_buffer = (char *)malloc(JOURNAL_DIRENT_BUFFER);
+
+				if(child_buffer == NULL)
+				{
+					ret = METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+				}
+				else
+				{
+					ret = __metadata_extractor_journal_walk(list, path, length + 1 + name_length, child_buffer);
+					free(child_buffer);
+				}
+			}
+
+			path[length] = '\0';
+		}
+	}
+
+	close(fd);
+
+	return ret;
+}
+
+static void __metadata_extractor_journal_stat(const char *path, metadata_extractor_journal_stat_s *stat_info)
+{
+#ifdef STATX_BASIC_STATS
+	struct statx stx;
+
+	/* only the fields compared, and no sync with remote file systems */
+	stat_info->valid = (statx(AT_FDCWD, path, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, STATX_TYPE | STATX_INO | STATX_SIZE | STATX_MTIME, &stx) == 0) &&
+		S_ISREG(stx.stx_mode);
+	stat_info->ino = stx.stx_ino;
+	stat_info->size = stx.stx_size;
+	stat_info->mtime = (int64_t)stx.stx_mtime.tv_sec * 1000000000LL + stx.stx_mtime.tv_nsec;
+#else
+	struct stat st;
+
+	stat_info->valid = (lstat(path, &st) == 0) && S_ISREG(st.st_mode);
+	stat_info->ino = st.st_ino;
+	stat_info->size = st.st_size;
+	stat_info->mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+}
+
+static void *__metadata_extractor_journal_stat_thread(void *data)
+{
+	metadata_extractor_journal_list_s *list = (metadata_extractor_journal_list_s *)data;
+	int begin = 0;
+
+	while((begin = __atomic_fetch_add(&list->next, JOURNAL_STAT_CHUNK, __ATOMIC_RELAXED)) < list->count)
+	{
+		int end = (list->count - begin > JOURNAL_STAT_CHUNK) ? begin + JOURNAL_STAT_CHUNK : list->count;
+		int idx = 0;
+
+		for(idx = begin; idx < end; idx++)
+		{
+			__metadata_extractor_journal_stat(list->paths + list->offsets[idx], &list->stats[idx]);
+		}
+	}
+
+	return NULL;
+}
+
+static void __metadata_extractor_journal_stat_all(metadata_extractor_journal_list_s *list, int threads)
+{
+	pthread_t thread[JOURNAL_MAX_THREADS];
+	int started = 0;
+	int idx = 0;
+
+	if(threads > JOURNAL_MAX_THREADS)
+		threads = JOURNAL_MAX_THREADS;
+
+	list->next = 0;
+
+	/* the calling thread is one of the workers */
+	for(idx = 1; idx < threads; idx++)
+	{
+		if(pthread_create(&thread[started], NULL, __metadata_extractor_journal_stat_thread, list) != 0)
+			break;
+		started++;
+	}
+
+	__metadata_extractor_journal_stat_thread(list);
+
+	for(idx = 0; idx < started; idx++)
+	{
+		pthread_join(thread[idx], NULL);
+	}
+}
+
+static int __metadata_extractor_journal_compare(metadata_extractor_journal_s *journal, const metadata_extractor_journal_list_s *list, metadata_extractor_journal_cb callback, void *user_data)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int idx = 0;
+
+	for(idx = 0; idx < list->count; idx++)
+	{
+		const char *path = list->paths + list->offsets[idx];
+		const metadata_extractor_journal_stat_s *stat_info = &list->stats[idx];
+		size_t length = strlen(path);
+		uint64_t hash = 0;
+		int index = 0;
+
+		if(!stat_info->valid)
+		{
+			/* gone since the walk, it is reported as deleted if the journal has it */
+			continue;
+		}
+
+		hash = __metadata_extractor_hash(path, length);
+		index = __metadata_extractor_journal_find(journal, path, length, hash);
+
+		if(index < 0)
+		{
+			ret = __metadata_extractor_journal_add(journal, path, length, hash, &index);
+			if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+			{
+				LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+				return ret;
+			}
+
+			journal->entries[index].ino = stat_info->ino;
+			journal->entries[index].size = stat_info->size;
+			journal->entries[index].mtime = stat_info->mtime;
+			journal->flags[index] = JOURNAL_FLAG_SEEN;
+
+			if(!callback(path, METADATA_EXTRACTOR_JOURNAL_NEW, user_data))
+			{
+				journal->flags[index] = JOURNAL_FLAG_REMOVED;
+			}
+		}
+		else
+		{
+			metadata_extractor_journal_entry_s old = journal->entries[index];
+
+			journal->flags[index] |= JOURNAL_FLAG_SEEN;
+
+			if((old.ino == stat_info->ino) && (old.size == stat_info->size) && (old.mtime == stat_info->mtime))
+			{
+				continue;
+			}
+
+			journal->entries[index].ino = stat_info->ino;
+			journal->entries[index].size = stat_info->size;
+			journal->entries[index].mtime = stat_info->mtime;
+			journal->entries[index].digest = 0;
+
+			if(!callback(path, METADATA_EXTRACTOR_JOURNAL_CHANGED, user_data))
+			{
+				journal->entries[index] = old;
+			}
+		}
+	}
+
+	return ret;
+}
+
+static void __metadata_extractor_journal_report_deleted(metadata_extractor_journal_s *journal, const char *root, size_t root_length, metadata_extractor_journal_cb callback, void *user_data)
+{
+	int idx = 0;
+
+	for(idx = 0; idx < journal->count; idx++)
+	{
+		const char *path = journal->strings + journal->entries[idx].path_offset;
+		unsigned char flags = journal->flags[idx];
+
+		journal->flags[idx] &= ~JOURNAL_FLAG_SEEN;
+
+		if((flags & (JOURNAL_FLAG_SEEN | JOURNAL_FLAG_REMOVED)) || (strncmp(path, root, root_length) != 0) || (path[root_length] != '/'))
+		{
+			continue;
+		}
+
+		if(callback(path, METADATA_EXTRACTOR_JOURNAL_DELETED, user_data))
+		{
+			journal->flags[idx] |= JOURNAL_FLAG_REMOVED;
+		}
+	}
+}
+
+int metadata_extractor_journal_create(const char *path, metadata_extractor_journal_h *journal)
+{
+	metadata_extractor_journal_s *_journal = NULL;
+
+	if((!path) || (!journal))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_journal = (metadata_extractor_journal_s *)calloc(1, sizeof(metadata_extractor_journal_s));
+	if(_journal != NULL)
+	{
+		_journal->path = strdup(path);
+	}
+	if((_journal == NULL) || (_journal->path == NULL) || (__metadata_extractor_journal_grow_slots(_journal) != METADATA_EXTRACTOR_ERROR_NONE))
+	{
+		if(_journal != NULL)
+		{
+			SAFE_FREE(_journal->path);
+			SAFE_FREE(_journal);
+		}
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	__metadata_extractor_journal_load(_journal);
+
+	*journal = (metadata_extractor_journal_h)_journal;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_journal_scan(metadata_extractor_journal_h journal, const char *root, int threads, metadata_extractor_journal_cb callback, void *user_data)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_journal_s *_journal = (metadata_extractor_journal_s *)journal;
+	metadata_extractor_journal_list_s list;
+	char *path = NULL;
+	char *buffer = NULL;
+	size_t root_length = 0;
+	unsigned long long trace_begin = 0;
+
+	if((!_journal) || (!root) || (root[0] == '\0') || (threads < 1) || (!callback))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	root_length = strlen(root);
+	while((root_length > 0) && (root[root_length - 1] == '/'))
+	{
+		root_length--;
+	}
+	if(root_length >= PATH_MAX)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	memset(&list, 0, sizeof(list));
+	path = (char *)malloc(PATH_MAX);
+	buffer = (char *)malloc(JOURNAL_DIRENT_BUFFER);
+	if((path == NULL) || (buffer == NULL))
+	{
+		ret = METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	/* "/" is kept as the empty prefix, so that its children are "/name" */
+	memcpy(path, root, root_length);
+	path[root_length] = '\0';
+
+	trace_begin = __metadata_extractor_trace_begin();
+	ret = __metadata_extractor_journal_walk(&list, path, root_length, buffer);
+	__metadata_extractor_trace_end("journal_walk", trace_begin, root);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		goto out;
+	}
+
+	if(list.count > 0)
+	{
+		list.stats = (metadata_extractor_journal_stat_s *)calloc(list.count, sizeof(metadata_extractor_journal_stat_s));
+		if(list.stats == NULL)
+		{
+			ret = METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+			goto out;
+		}
+
+		trace_begin = __metadata_extractor_trace_begin();
+		__metadata_extractor_journal_stat_all(&list, threads);
+		__metadata_extractor_trace_end("journal_stat", trace_begin, root);
+	}
+
+	ret = __metadata_extractor_journal_compare(_journal, &list, callback, user_data);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_journal_report_deleted(_journal, path, root_length, callback, user_data);
+	}
+
+out:
+	if(ret == METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+	}
+	SAFE_FREE(list.paths);
+	SAFE_FREE(list.offsets);
+	SAFE_FREE(list.stats);
+	SAFE_FREE(path);
+	SAFE_FREE(buffer);
+
+	return ret;
+}
+
+int metadata_extractor_journal_set_digest(metadata_extractor_journal_h journal, const char *path, unsigned long long digest)
+{
+	metadata_extractor_journal_s *_journal = (metadata_extractor_journal_s *)journal;
+	size_t length = 0;
+	int index = 0;
+
+	if((!_journal) || (!path))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	length = strlen(path);
+	index = __metadata_extractor_journal_find(_journal, path, length, __metadata_extractor_hash(path, length));
+	if(index < 0)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) not in journal", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_journal->entries[index].digest = digest;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_journal_get_digest(metadata_extractor_journal_h journal, const char *path, unsigned long long *digest)
+{
+	metadata_extractor_journal_s *_journal = (metadata_extractor_journal_s *)journal;
+	size_t length = 0;
+	int index = 0;
+
+	if((!_journal) || (!path) || (!digest))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	length = strlen(path);
+	index = __metadata_extractor_journal_find(_journal, path, length, __metadata_extractor_hash(path, length));
+	if(index < 0)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) not in journal", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*digest = _journal->entries[index].digest;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_journal_save(metadata_extractor_journal_h journal)
+{
+	metadata_extractor_journal_s *_journal = (metadata_extractor_journal_s *)journal;
+	FILE *fp = NULL;
+	char *tmp_path = NULL;
+	uint32_t header[4];
+	uint32_t count = 0;
+	uint32_t strings_size = 0;
+	bool failed = false;
+	int idx = 0;
+	int fd = -1;
+
+	if(!_journal)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	for(idx = 0; idx < _journal->count; idx++)
+	{
+		if(!(_journal->flags[idx] & JOURNAL_FLAG_REMOVED))
+		{
+			count++;
+			strings_size += _journal->entries[idx].path_length + 1;
+		}
+	}
+
+	if(asprintf(&tmp_path, "%s.XXXXXX", _journal->path) < 0)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	/* written aside under a unique name and renamed over, so that a crash leaves the old journal
+	 * and two savers of the same journal never write into one file */
+	fd = mkstemp(tmp_path);
+	if((fd >= 0) && ((fchmod(fd, 0644) != 0) || ((fp = fdopen(fd, "wb")) == NULL)))
+	{
+		close(fd);
+		unlink(tmp_path);
+	}
+	if(fp == NULL)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not open [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, tmp_path);
+		SAFE_FREE(tmp_path);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	header[0] = JOURNAL_MAGIC;
+	header[1] = JOURNAL_VERSION;
+	header[2] = count;
+	header[3] = strings_size;
+	failed = (fwrite(header, sizeof(header), 1, fp) != 1);
+
+	strings_size = 0;
+	for(idx = 0; (!failed) && (idx < _journal->count); idx++)
+	{
+		metadata_extractor_journal_entry_s entry = _journal->entries[idx];
+
+		if(_journal->flags[idx] & JOURNAL_FLAG_REMOVED)
+			continue;
+
+		entry.path_offset = strings_size;
+		strings_size += entry.path_length + 1;
+		failed = (fwrite(&entry, sizeof(entry), 1, fp) != 1);
+	}
+
+	for(idx = 0; (!failed) && (idx < _journal->count); idx++)
+	{
+		if(_journal->flags[idx] & JOURNAL_FLAG_REMOVED)
+			continue;
+
+		failed = (fwrite(_journal->strings + _journal->entries[idx].path_offset, _journal->entries[idx].path_length + 1, 1, fp) != 1);
+	}
+
+	if((fflush(fp) != 0) || (fsync(fileno(fp)) != 0))
+	{
+		failed = true;
+	}
+	if(fclose(fp) != 0)
+	{
+		failed = true;
+	}
+
+	if(failed || (rename(tmp_path, _journal->path) != 0))
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not write [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, _journal->path);
+		unlink(tmp_path);
+		SAFE_FREE(tmp_path);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	SAFE_FREE(tmp_path);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_journal_destroy(metadata_extractor_journal_h journal)
+{
+	metadata_extractor_journal_s *_journal = (metadata_extractor_journal_s *)journal;
+
+	if(!_journal)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	SAFE_FREE(_journal->path);
+	SAFE_FREE(_journal->entries);
+	SAFE_FREE(_journal->flags);
+	SAFE_FREE(_journal->strings);
+	SAFE_FREE(_journal->slots);
+	SAFE_FREE(_journal);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
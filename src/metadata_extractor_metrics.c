@@ -0,0 +1,459 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define METRICS_SHARD_NUM		16
+#define METRICS_BUCKET_NUM		16
+#define METRICS_ERROR_NUM		5
+#define METRICS_PATH_MAX		4096
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * Counters are split into cache line aligned shards. A thread picks a shard once and keeps
+ * updating it with relaxed atomics, so threads only share a line when there are more threads
+ * than shards. Readers sum all shards; a snapshot is not atomic across counters.
+ */
+typedef struct
+{
+	unsigned long long count;
+	unsigned long long sum_usec;
+	unsigned long long bucket[METRICS_BUCKET_NUM];
+	unsigned long long error[METRICS_ERROR_NUM];
+} metrics_api_s;
+
+typedef struct
+{
+	unsigned long long extractions;
+	unsigned long long extraction_error[METRICS_ERROR_NUM];
+	unsigned long long cache_hits;
+	unsigned long long waveform_cache_hits;
+	metrics_api_s api[METADATA_EXTRACTOR_METRIC_API_MAX];
+} __attribute__((aligned(64))) metrics_shard_s;
+
+typedef struct
+{
+	char *data;
+	size_t len;
+	size_t cap;
+	bool failed;
+} metrics_text_s;
+
+static metrics_shard_s g_metrics_shard[METRICS_SHARD_NUM];
+static unsigned int g_metrics_next_shard = 0;
+static __thread metrics_shard_s *g_metrics_thread_shard = NULL;
+
+/* upper bounds in microseconds, the last bucket is +Inf */
+static const unsigned long long g_metrics_bucket_bound[METRICS_BUCKET_NUM - 1] = {
+	50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000,
+};
+
+static const char *g_metrics_api_name[METADATA_EXTRACTOR_METRIC_API_MAX] = {
+	"get_metadata",
+	"get_artwork",
+	"get_frame",
+	"get_frame_at_time",
+	"get_synclyrics",
+	"serialize",
+	"batch_extract",
+	"get_artwork_location",
+	"get_artwork_scaled",
+	"get_fingerprint",
+	"get_sprite_sheet",
+	"get_best_frame",
+	"get_waveform",
+	"get_artwork_view",
+	"get_artwork_digest",
+};
+
+static const char *g_metrics_error_name[METRICS_ERROR_NUM] = {
+	"invalid_parameter",
+	"out_of_memory",
+	"file_exists",
+	"operation_failed",
+	"other",
+};
+
+static metrics_shard_s *__metadata_extractor_metrics_shard(void)
+{
+	if(g_metrics_thread_shard == NULL)
+	{
+		unsigned int idx = __atomic_fetch_add(&g_metrics_next_shard, 1, __ATOMIC_RELAXED);
+		g_metrics_thread_shard = &g_metrics_shard[idx % METRICS_SHARD_NUM];
+	}
+
+	return g_metrics_thread_shard;
+}
+
+static void __metadata_extractor_metrics_add(unsigned long long *counter, unsigned long long value)
+{
+	__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static unsigned long long __metadata_extractor_metrics_load(const unsigned long long *counter)
+{
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static int __metadata_extractor_metrics_error_index(int error)
+{
+	switch(error)
+	{
+		case METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER:
+			return 0;
+		case METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY:
+			return 1;
+		case METADATA_EXTRACTOR_ERROR_FILE_EXISTS:
+			return 2;
+		case METADATA_EXTRACTOR_ERROR_OPERATION_FAILED:
+			return 3;
+		default:
+			return 4;
+	}
+}
+
+static int __metadata_extractor_metrics_bucket_index(unsigned long long usec)
+{
+	int idx = 0;
+
+	for(idx = 0; idx < METRICS_BUCKET_NUM - 1; idx++)
+	{
+		if(usec <= g_metrics_bucket_bound[idx])
+		{
+			return idx;
+		}
+	}
+
+	return METRICS_BUCKET_NUM - 1;
+}
+
+unsigned long long __metadata_extractor_metrics_begin(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000ULL + (unsigned long long)(ts.tv_nsec / 1000);
+}
+
+void __metadata_extractor_metrics_end(metadata_extractor_metric_api_e api, unsigned long long begin, int error)
+{
+	metrics_shard_s *shard = __metadata_extractor_metrics_shard();
+	metrics_api_s *api_metrics = &shard->api[api];
+	unsigned long long usec = __metadata_extractor_metrics_begin() - begin;
+
+	__metadata_extractor_metrics_add(&api_metrics->count, 1);
+	__metadata_extractor_metrics_add(&api_metrics->sum_usec, usec);
+	__metadata_extractor_metrics_add(&api_metrics->bucket[__metadata_extractor_metrics_bucket_index(usec)], 1);
+
+	if(error != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_metrics_add(&api_metrics->error[__metadata_extractor_metrics_error_index(error)], 1);
+	}
+}
+
+void __metadata_extractor_metrics_extraction(int error)
+{
+	metrics_shard_s *shard = __metadata_extractor_metrics_shard();
+
+	__metadata_extractor_metrics_add(&shard->extractions, 1);
+
+	if(error != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_metrics_add(&shard->extraction_error[__metadata_extractor_metrics_error_index(error)], 1);
+	}
+}
+
+void __metadata_extractor_metrics_cache_hit(void)
+{
+	__metadata_extractor_metrics_add(&__metadata_extractor_metrics_shard()->cache_hits, 1);
+}
+
+void __metadata_extractor_metrics_waveform_cache_hit(void)
+{
+	__metadata_extractor_metrics_add(&__metadata_extractor_metrics_shard()->waveform_cache_hits, 1);
+}
+
+static void __metadata_extractor_metrics_printf(metrics_text_s *text, const char *fmt, ...)
+{
+	va_list ap;
+	int len = 0;
+
+	if(text->failed)
+	{
+		return;
+	}
+
+	va_start(ap, fmt);
+	len = vsnprintf(text->data + text->len, text->cap - text->len, fmt, ap);
+	va_end(ap);
+
+	if((len >= 0) && (text->len + len >= text->cap))
+	{
+		size_t cap = text->cap * 2;
+		char *data = NULL;
+
+		while(text->len + len >= cap)
+		{
+			cap *= 2;
+		}
+
+		data = (char *)realloc(text->data, cap);
+		if(data == NULL)
+		{
+			text->failed = true;
+			return;
+		}
+
+		text->data = data;
+		text->cap = cap;
+
+		va_start(ap, fmt);
+		len = vsnprintf(text->data + text->len, text->cap - text->len, fmt, ap);
+		va_end(ap);
+	}
+
+	if(len < 0)
+	{
+		text->failed = true;
+		return;
+	}
+
+	text->len += len;
+}
+
+static int __metadata_extractor_metrics_render(metrics_text_s *text)
+{
+	metrics_shard_s total;
+	int shard_idx = 0;
+	int api = 0;
+	int idx = 0;
+
+	memset(&total, 0, sizeof(total));
+
+	for(shard_idx = 0; shard_idx < METRICS_SHARD_NUM; shard_idx++)
+	{
+		metrics_shard_s *shard = &g_metrics_shard[shard_idx];
+
+		total.extractions += __metadata_extractor_metrics_load(&shard->extractions);
+		total.cache_hits += __metadata_extractor_metrics_load(&shard->cache_hits);
+		total.waveform_cache_hits += __metadata_extractor_metrics_load(&shard->waveform_cache_hits);
+		for(idx = 0; idx < METRICS_ERROR_NUM; idx++)
+		{
+			total.extraction_error[idx] += __metadata_extractor_metrics_load(&shard->extraction_error[idx]);
+		}
+
+		for(api = 0; api < METADATA_EXTRACTOR_METRIC_API_MAX; api++)
+		{
+			total.api[api].count += __metadata_extractor_metrics_load(&shard->api[api].count);
+			total.api[api].sum_usec += __metadata_extractor_metrics_load(&shard->api[api].sum_usec);
+			for(idx = 0; idx < METRICS_BUCKET_NUM; idx++)
+			{
+				total.api[api].bucket[idx] += __metadata_extractor_metrics_load(&shard->api[api].bucket[idx]);
+			}
+			for(idx = 0; idx < METRICS_ERROR_NUM; idx++)
+			{
+				total.api[api].error[idx] += __metadata_extractor_metrics_load(&shard->api[api].error[idx]);
+			}
+		}
+	}
+
+	text->cap = 4096;
+	text->len = 0;
+	text->failed = false;
+	text->data = (char *)malloc(text->cap);
+	if(text->data == NULL)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	__metadata_extractor_metrics_printf(text, "# HELP metadata_extractor_extractions_total Content and tag extractions performed.\n");
+	__metadata_extractor_metrics_printf(text, "# TYPE metadata_extractor_extractions_total counter\n");
+	__metadata_extractor_metrics_printf(text, "metadata_extractor_extractions_total %llu\n", total.extractions);
+
+	__metadata_extractor_metrics_printf(text, "# HELP metadata_extractor_extraction_failures_total Failed extractions by error.\n");
+	__metadata_extractor_metrics_printf(text, "# TYPE metadata_extractor_extraction_failures_total counter\n");
+	for(idx = 0; idx < METRICS_ERROR_NUM; idx++)
+	{
+		__metadata_extractor_metrics_printf(text, "metadata_extractor_extraction_failures_total{error=\"%s\"} %llu\n", g_metrics_error_name[idx], total.extraction_error[idx]);
+	}
+
+	__metadata_extractor_metrics_printf(text, "# HELP metadata_extractor_cache_hits_total Calls served from an already extracted handle.\n");
+	__metadata_extractor_metrics_printf(text, "# TYPE metadata_extractor_cache_hits_total counter\n");
+	__metadata_extractor_metrics_printf(text, "metadata_extractor_cache_hits_total %llu\n", total.cache_hits);
+	__metadata_extractor_metrics_printf(text, "# HELP metadata_extractor_waveform_cache_hits_total Waveforms read from the waveform cache directory.\n");
+	__metadata_extractor_metrics_printf(text, "# TYPE metadata_extractor_waveform_cache_hits_total counter\n");
+	__metadata_extractor_metrics_printf(text, "metadata_extractor_waveform_cache_hits_total %llu\n", total.waveform_cache_hits);
+
+	__metadata_extractor_metrics_printf(text, "# HELP metadata_extractor_api_errors_total Failed API calls by error.\n");
+	__metadata_extractor_metrics_printf(text, "# TYPE metadata_extractor_api_errors_total counter\n");
+	for(api = 0; api < METADATA_EXTRACTOR_METRIC_API_MAX; api++)
+	{
+		for(idx = 0; idx < METRICS_ERROR_NUM; idx++)
+		{
+			__metadata_extractor_metrics_printf(text, "metadata_extractor_api_errors_total{api=\"%s\",error=\"%s\"} %llu\n", g_metrics_api_name[api], g_metrics_error_name[idx], total.api[api].error[idx]);
+		}
+	}
+
+	__metadata_extractor_metrics_printf(text, "# HELP metadata_extractor_api_latency_seconds API call latency.\n");
+	__metadata_extractor_metrics_printf(text, "# TYPE metadata_extractor_api_latency_seconds histogram\n");
+	for(api = 0; api < METADATA_EXTRACTOR_METRIC_API_MAX; api++)
+	{
+		unsigned long long cumulative = 0;
+
+		for(idx = 0; idx < METRICS_BUCKET_NUM; idx++)
+		{
+			cumulative += total.api[api].bucket[idx];
+			if(idx < METRICS_BUCKET_NUM - 1)
+			{
+				__metadata_extractor_metrics_printf(text, "metadata_extractor_api_latency_seconds_bucket{api=\"%s\",le=\"%g\"} %llu\n", g_metrics_api_name[api], g_metrics_bucket_bound[idx] / 1000000.0, cumulative);
+			}
+			else
+			{
+				__metadata_extractor_metrics_printf(text, "metadata_extractor_api_latency_seconds_bucket{api=\"%s\",le=\"+Inf\"} %llu\n", g_metrics_api_name[api], cumulative);
+			}
+		}
+		__metadata_extractor_metrics_printf(text, "metadata_extractor_api_latency_seconds_sum{api=\"%s\"} %.6f\n", g_metrics_api_name[api], total.api[api].sum_usec / 1000000.0);
+		__metadata_extractor_metrics_printf(text, "metadata_extractor_api_latency_seconds_count{api=\"%s\"} %llu\n", g_metrics_api_name[api], total.api[api].count);
+	}
+
+	if(text->failed)
+	{
+		SAFE_FREE(text->data);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_metrics_dump(char *buffer, int size, int *length)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metrics_text_s text;
+
+	if((!length) || (size < 0) || ((size > 0) && (!buffer)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_metrics_render(&text);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, ret);
+		return ret;
+	}
+
+	*length = (int)text.len;
+
+	if((size_t)size < text.len + 1)
+	{
+		SAFE_FREE(text.data);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	memcpy(buffer, text.data, text.len + 1);
+	SAFE_FREE(text.data);
+
+	return ret;
+}
+
+int metadata_extractor_metrics_dump_to_file(const char *path)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metrics_text_s text;
+	char tmp_path[METRICS_PATH_MAX] = {0, };
+	FILE *fp = NULL;
+	bool failed = false;
+	int fd = -1;
+
+	if((!path) || (snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path) >= (int)sizeof(tmp_path)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = __metadata_extractor_metrics_render(&text);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, ret);
+		return ret;
+	}
+
+	/* write aside under a unique name and rename, so scrapers never see a partial or mixed file */
+	fd = mkstemp(tmp_path);
+	if((fd >= 0) && ((fchmod(fd, 0644) != 0) || ((fp = fdopen(fd, "w")) == NULL)))
+	{
+		close(fd);
+		unlink(tmp_path);
+	}
+	if(fp == NULL)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not open [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, tmp_path);
+		SAFE_FREE(text.data);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	failed = (fwrite(text.data, 1, text.len, fp) != text.len);
+	if(fclose(fp) != 0)
+	{
+		failed = true;
+	}
+
+	SAFE_FREE(text.data);
+
+	if(failed || (rename(tmp_path, path) != 0))
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not write [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, path);
+		unlink(tmp_path);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return ret;
+}
+
+int metadata_extractor_metrics_reset(void)
+{
+	int shard_idx = 0;
+
+	for(shard_idx = 0; shard_idx < METRICS_SHARD_NUM; shard_idx++)
+	{
+		unsigned long long *counter = (unsigned long long *)&g_metrics_shard[shard_idx];
+		size_t idx = 0;
+
+		for(idx = 0; idx < sizeof(metrics_shard_s) / sizeof(unsigned long long); idx++)
+		{
+			__atomic_store_n(&counter[idx], 0, __ATOMIC_RELAXED);
+		}
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
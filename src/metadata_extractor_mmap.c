@@ -0,0 +1,164 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+/* MMFileFormatType of mm-fileinfo, the format argument of its _from_memory() functions */
+#define MMAP_FORMAT_3GP			0
+#define MMAP_FORMAT_ASF			1
+#define MMAP_FORMAT_AVI			2
+#define MMAP_FORMAT_MATROSKA	3
+#define MMAP_FORMAT_MP4			4
+#define MMAP_FORMAT_OGG			5
+#define MMAP_FORMAT_QT			7
+#define MMAP_FORMAT_AMR			9
+#define MMAP_FORMAT_AAC			10
+#define MMAP_FORMAT_MP3			11
+#define MMAP_FORMAT_WAV			14
+#define MMAP_FORMAT_FLAC		24
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/* the container of data from its magic bytes, -1 when it is not one the memory parsers take */
+int __metadata_extractor_mmap_format(const unsigned char *data, size_t size)
+{
+	static const unsigned char asf_guid[8] = { 0x30, 0x26, 0xb2, 0x75, 0x8e, 0x66, 0xcf, 0x11 };
+
+	if(size < 12)
+	{
+		return -1;
+	}
+
+	if(memcmp(data + 4, "ftyp", 4) == 0)
+	{
+		if(memcmp(data + 8, "qt  ", 4) == 0)
+			return MMAP_FORMAT_QT;
+		if((memcmp(data + 8, "3gp", 3) == 0) || (memcmp(data + 8, "3g2", 3) == 0))
+			return MMAP_FORMAT_3GP;
+		return MMAP_FORMAT_MP4;
+	}
+
+	if((data[0] == 0x1a) && (data[1] == 0x45) && (data[2] == 0xdf) && (data[3] == 0xa3))
+		return MMAP_FORMAT_MATROSKA;
+
+	if(memcmp(data, "RIFF", 4) == 0)
+	{
+		if(memcmp(data + 8, "AVI ", 4) == 0)
+			return MMAP_FORMAT_AVI;
+		if(memcmp(data + 8, "WAVE", 4) == 0)
+			return MMAP_FORMAT_WAV;
+		return -1;
+	}
+
+	if(memcmp(data, asf_guid, sizeof(asf_guid)) == 0)
+		return MMAP_FORMAT_ASF;
+	if(memcmp(data, "OggS", 4) == 0)
+		return MMAP_FORMAT_OGG;
+	if(memcmp(data, "fLaC", 4) == 0)
+		return MMAP_FORMAT_FLAC;
+	if(memcmp(data, "#!AMR", 5) == 0)
+		return MMAP_FORMAT_AMR;
+	if((memcmp(data, "ID3", 3) == 0) && (size >= 10))
+	{
+		/* ID3v2 leads MP3 as well as FLAC and ADTS, the stream after it tells them apart */
+		size_t tag_size = 10 + (((size_t)(data[6] & 0x7f) << 21) | ((size_t)(data[7] & 0x7f) << 14) | ((size_t)(data[8] & 0x7f) << 7) | (data[9] & 0x7f));
+
+		if(data[5] & 0x10)
+			tag_size += 10;		/* footer */
+		if(tag_size >= size)
+			return -1;
+		return __metadata_extractor_mmap_format(data + tag_size, size - tag_size);
+	}
+
+	if(data[0] == 0xff)
+	{
+		/* ADTS has layer 0 in the frame sync, MPEG audio 1 to 3 */
+		if((data[1] & 0xf6) == 0xf0)
+			return MMAP_FORMAT_AAC;
+		if((data[1] & 0xe0) == 0xe0)
+			return MMAP_FORMAT_MP3;
+	}
+
+	return -1;
+}
+
+/*
+ * Maps path for the source mode. Fails, and the caller reads by path, for files that can not be mapped
+ * (empty, special or on a file system without mmap), are larger than the unsigned int size of the memory parsers,
+ * or whose container the memory parsers can not be told.
+ */
+int __metadata_extractor_mmap_open(const char *path, metadata_extractor_source_e source, void **map, size_t *size, int *format)
+{
+	int fd = -1;
+	struct stat st;
+	void *_map = NULL;
+	int _format = -1;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+	{
+		return METADATA_EXTRACTOR_ERROR_FILE_EXISTS;
+	}
+
+	if((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || (st.st_size == 0) || ((unsigned long long)st.st_size > UINT_MAX))
+	{
+		close(fd);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	_map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(_map == MAP_FAILED)
+	{
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	/* before the first page is touched, so that the sniffing below already reads with the right window */
+	madvise(_map, st.st_size, (source == METADATA_EXTRACTOR_SOURCE_MMAP_RANDOM) ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+	_format = __metadata_extractor_mmap_format((const unsigned char *)_map, st.st_size);
+	if(_format < 0)
+	{
+		munmap(_map, st.st_size);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	*map = _map;
+	*size = st.st_size;
+	*format = _format;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+void __metadata_extractor_mmap_close(void *map, size_t size)
+{
+	if(map != NULL)
+	{
+		munmap(map, size);
+	}
+}
@@ -0,0 +1,212 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define PREFETCH_MAX_THREADS	16
+#define PREFETCH_HEAD_SIZE		(256 * 1024)	/* container headers, ID3v2 and a moov atom at the front */
+#define PREFETCH_TAIL_SIZE		(256 * 1024)	/* ID3v1, APE footers and a moov atom at the end */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * mm-fileinfo reads by path with small synchronous reads, so on a cold cache every file costs several seeks
+ * one after the other. The workers walk up to depth files ahead of the extractor and read the parts the parsers
+ * look at into the page cache; each worker blocks in readahead(), so depth reads are in flight at once.
+ */
+struct metadata_extractor_prefetch_s
+{
+	const char **paths;
+	int count;
+	int depth;
+	int next;					/* next file to prefetch */
+	int done;					/* files the extractor has finished */
+	bool stop;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	pthread_t threads[PREFETCH_MAX_THREADS];
+	int thread_count;
+};
+
+static void __metadata_extractor_prefetch_read(int fd, off_t offset, size_t length)
+{
+	if(readahead(fd, offset, length) != 0)
+	{
+		/* not supported by every file system; the hint at least starts the read */
+		posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+	}
+}
+
+static void __metadata_extractor_prefetch_file(const char *path)
+{
+	int fd = -1;
+	struct stat st;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC | O_NOATIME);
+	if(fd < 0)
+	{
+		/* O_NOATIME is refused for files of other users */
+		fd = open(path, O_RDONLY | O_CLOEXEC);
+	}
+	if(fd < 0)
+	{
+		return;
+	}
+
+	if((fstat(fd, &st) == 0) && S_ISREG(st.st_mode))
+	{
+		__metadata_extractor_prefetch_read(fd, 0, PREFETCH_HEAD_SIZE);
+		if(st.st_size > PREFETCH_HEAD_SIZE)
+		{
+			off_t tail = (st.st_size - PREFETCH_TAIL_SIZE > PREFETCH_HEAD_SIZE) ? st.st_size - PREFETCH_TAIL_SIZE : PREFETCH_HEAD_SIZE;
+
+			__metadata_extractor_prefetch_read(fd, tail, st.st_size - tail);
+		}
+	}
+
+	close(fd);
+}
+
+static void *__metadata_extractor_prefetch_thread(void *data)
+{
+	metadata_extractor_prefetch_s *prefetch = (metadata_extractor_prefetch_s *)data;
+
+	pthread_mutex_lock(&prefetch->lock);
+
+	while(!prefetch->stop && (prefetch->next < prefetch->count))
+	{
+		int idx = 0;
+
+		if(prefetch->next >= prefetch->done + prefetch->depth)
+		{
+			pthread_cond_wait(&prefetch->cond, &prefetch->lock);
+			continue;
+		}
+
+		idx = prefetch->next++;
+		pthread_mutex_unlock(&prefetch->lock);
+
+		__metadata_extractor_prefetch_file(prefetch->paths[idx]);
+
+		pthread_mutex_lock(&prefetch->lock);
+	}
+
+	pthread_mutex_unlock(&prefetch->lock);
+
+	return NULL;
+}
+
+metadata_extractor_prefetch_s *__metadata_extractor_prefetch_start(const char **paths, int count, int depth)
+{
+	metadata_extractor_prefetch_s *prefetch = NULL;
+	int thread_count = 0;
+	int idx = 0;
+
+	if((depth <= 0) || (count <= 1))
+	{
+		return NULL;
+	}
+
+	prefetch = (metadata_extractor_prefetch_s *)calloc(1, sizeof(metadata_extractor_prefetch_s));
+	if(prefetch == NULL)
+	{
+		/* extraction goes on without prefetch */
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return NULL;
+	}
+
+	prefetch->paths = paths;
+	prefetch->count = count;
+	prefetch->depth = depth;
+	/* the extractor opens the first file right away, there is nothing to gain there */
+	prefetch->next = 1;
+	pthread_mutex_init(&prefetch->lock, NULL);
+	pthread_cond_init(&prefetch->cond, NULL);
+
+	thread_count = (depth < PREFETCH_MAX_THREADS) ? depth : PREFETCH_MAX_THREADS;
+	if(thread_count > count - 1)
+		thread_count = count - 1;
+
+	for(idx = 0; idx < thread_count; idx++)
+	{
+		if(pthread_create(&prefetch->threads[idx], NULL, __metadata_extractor_prefetch_thread, prefetch) != 0)
+			break;
+		prefetch->thread_count++;
+	}
+
+	if(prefetch->thread_count == 0)
+	{
+		pthread_cond_destroy(&prefetch->cond);
+		pthread_mutex_destroy(&prefetch->lock);
+		free(prefetch);
+		return NULL;
+	}
+
+	return prefetch;
+}
+
+void __metadata_extractor_prefetch_advance(metadata_extractor_prefetch_s *prefetch, int done)
+{
+	if(prefetch == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&prefetch->lock);
+	prefetch->done = done;
+	/* files the extractor passed need no prefetch any more */
+	if(prefetch->next < done + 1)
+		prefetch->next = done + 1;
+	pthread_cond_broadcast(&prefetch->cond);
+	pthread_mutex_unlock(&prefetch->lock);
+}
+
+void __metadata_extractor_prefetch_stop(metadata_extractor_prefetch_s *prefetch)
+{
+	int idx = 0;
+
+	if(prefetch == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&prefetch->lock);
+	prefetch->stop = true;
+	pthread_cond_broadcast(&prefetch->cond);
+	pthread_mutex_unlock(&prefetch->lock);
+
+	for(idx = 0; idx < prefetch->thread_count; idx++)
+	{
+		pthread_join(prefetch->threads[idx], NULL);
+	}
+
+	pthread_cond_destroy(&prefetch->cond);
+	pthread_mutex_destroy(&prefetch->lock);
+	free(prefetch);
+}
@@ -0,0 +1,366 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+#define RECORD_OFFSET_MAGIC		0
+#define RECORD_OFFSET_VERSION	4
+#define RECORD_OFFSET_COUNT		6
+#define RECORD_OFFSET_SIZE		8
+#define RECORD_OFFSET_PRESENT	12
+#define RECORD_OFFSET_PATH		16
+
+#define RECORD_SLOT(attr)		(METADATA_EXTRACTOR_RECORD_HEADER_SIZE + (attr) * METADATA_EXTRACTOR_RECORD_SLOT_SIZE)
+
+static const metadata_extractor_record_type_e g_record_attr_type[METADATA_EXTRACTOR_RECORD_ATTR_COUNT] = {
+	[METADATA_DURATION] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_VIDEO_BITRATE] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_VIDEO_FPS] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_VIDEO_WIDTH] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_VIDEO_HEIGHT] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_HAS_VIDEO] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_AUDIO_BITRATE] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_AUDIO_CHANNELS] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_AUDIO_SAMPLERATE] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_HAS_AUDIO] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_ARTIST] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_TITLE] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_ALBUM] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_GENRE] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_AUTHOR] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_COPYRIGHT] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_DATE] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_DESCRIPTION] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_TRACK_NUM] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_CLASSIFICATION] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_RATING] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_LONGITUDE] = METADATA_EXTRACTOR_RECORD_DOUBLE,
+	[METADATA_LATITUDE] = METADATA_EXTRACTOR_RECORD_DOUBLE,
+	[METADATA_ALTITUDE] = METADATA_EXTRACTOR_RECORD_DOUBLE,
+	[METADATA_CONDUCTOR] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_UNSYNCLYRICS] = METADATA_EXTRACTOR_RECORD_STRING,
+	[METADATA_SYNCLYRICS_NUM] = METADATA_EXTRACTOR_RECORD_INT,
+	[METADATA_RECDATE] = METADATA_EXTRACTOR_RECORD_STRING,
+};
+
+/* byte-wise accessors keep the record readable at any alignment and on any host byte order */
+static uint16_t __metadata_extractor_record_u16(const unsigned char *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t __metadata_extractor_record_u32(const unsigned char *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t __metadata_extractor_record_u64(const unsigned char *p)
+{
+	return (uint64_t)__metadata_extractor_record_u32(p) | ((uint64_t)__metadata_extractor_record_u32(p + 4) << 32);
+}
+
+static void __metadata_extractor_record_put_u16(unsigned char *p, uint16_t value)
+{
+	p[0] = (unsigned char)value;
+	p[1] = (unsigned char)(value >> 8);
+}
+
+static void __metadata_extractor_record_put_u32(unsigned char *p, uint32_t value)
+{
+	p[0] = (unsigned char)value;
+	p[1] = (unsigned char)(value >> 8);
+	p[2] = (unsigned char)(value >> 16);
+	p[3] = (unsigned char)(value >> 24);
+}
+
+static void __metadata_extractor_record_put_u64(unsigned char *p, uint64_t value)
+{
+	__metadata_extractor_record_put_u32(p, (uint32_t)value);
+	__metadata_extractor_record_put_u32(p + 4, (uint32_t)(value >> 32));
+}
+
+metadata_extractor_record_type_e __metadata_extractor_record_attr_type(metadata_extractor_attr_e attribute)
+{
+	return g_record_attr_type[attribute];
+}
+
+size_t __metadata_extractor_record_size(const char *path, const metadata_extractor_record_value_s *values)
+{
+	size_t size = RECORD_SLOT(METADATA_EXTRACTOR_RECORD_ATTR_COUNT);
+	int attr = 0;
+
+	if(path != NULL)
+	{
+		size += strlen(path) + 1;
+	}
+
+	for(attr = 0; attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT; attr++)
+	{
+		if((g_record_attr_type[attr] == METADATA_EXTRACTOR_RECORD_STRING) && (values[attr].s_value != NULL))
+		{
+			size += strlen(values[attr].s_value) + 1;
+		}
+	}
+
+	return size;
+}
+
+static size_t __metadata_extractor_record_put_string(unsigned char *record, size_t offset, unsigned char *slot, const char *str)
+{
+	size_t len = strlen(str);
+
+	memcpy(record + offset, str, len + 1);
+	__metadata_extractor_record_put_u32(slot, (uint32_t)offset);
+	__metadata_extractor_record_put_u32(slot + 4, (uint32_t)len);
+
+	return offset + len + 1;
+}
+
+void __metadata_extractor_record_write(const char *path, const metadata_extractor_record_value_s *values, void *record, size_t size)
+{
+	unsigned char *p = (unsigned char *)record;
+	size_t offset = RECORD_SLOT(METADATA_EXTRACTOR_RECORD_ATTR_COUNT);
+	uint32_t present = 0;
+	int attr = 0;
+
+	memset(p, 0, offset);
+
+	__metadata_extractor_record_put_u32(p + RECORD_OFFSET_MAGIC, METADATA_EXTRACTOR_RECORD_MAGIC);
+	__metadata_extractor_record_put_u16(p + RECORD_OFFSET_VERSION, METADATA_EXTRACTOR_RECORD_VERSION);
+	__metadata_extractor_record_put_u16(p + RECORD_OFFSET_COUNT, METADATA_EXTRACTOR_RECORD_ATTR_COUNT);
+	__metadata_extractor_record_put_u32(p + RECORD_OFFSET_SIZE, (uint32_t)size);
+
+	if(path != NULL)
+	{
+		offset = __metadata_extractor_record_put_string(p, offset, p + RECORD_OFFSET_PATH, path);
+	}
+
+	for(attr = 0; attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT; attr++)
+	{
+		unsigned char *slot = p + RECORD_SLOT(attr);
+
+		switch(g_record_attr_type[attr])
+		{
+			case METADATA_EXTRACTOR_RECORD_INT:
+				__metadata_extractor_record_put_u32(slot, (uint32_t)values[attr].i_value);
+				present |= 1U << attr;
+				break;
+			case METADATA_EXTRACTOR_RECORD_DOUBLE:
+			{
+				uint64_t bits = 0;
+				memcpy(&bits, &values[attr].d_value, sizeof(bits));
+				__metadata_extractor_record_put_u64(slot, bits);
+				present |= 1U << attr;
+				break;
+			}
+			case METADATA_EXTRACTOR_RECORD_STRING:
+				if(values[attr].s_value != NULL)
+				{
+					offset = __metadata_extractor_record_put_string(p, offset, slot, values[attr].s_value);
+					present |= 1U << attr;
+				}
+				break;
+		}
+	}
+
+	__metadata_extractor_record_put_u32(p + RECORD_OFFSET_PRESENT, present);
+}
+
+/* check that a string slot points at a null-terminated string inside the record; an empty slot is no string */
+static bool __metadata_extractor_record_check_string(const unsigned char *record, size_t size, const unsigned char *slot, bool optional)
+{
+	uint32_t offset = __metadata_extractor_record_u32(slot);
+	uint32_t len = __metadata_extractor_record_u32(slot + 4);
+
+	if((offset == 0) && (len == 0))
+	{
+		return optional;
+	}
+
+	if((offset < METADATA_EXTRACTOR_RECORD_HEADER_SIZE) || (offset >= size) || (len >= size - offset))
+	{
+		return false;
+	}
+
+	/* the first null must be the terminator, so that the length and strlen() agree */
+	return memchr(record + offset, '\0', len + 1) == record + offset + len;
+}
+
+int metadata_extractor_record_validate(const void *record, size_t size)
+{
+	const unsigned char *p = (const unsigned char *)record;
+	uint16_t count = 0;
+	uint32_t present = 0;
+	int attr = 0;
+
+	if((!p) || (size < METADATA_EXTRACTOR_RECORD_HEADER_SIZE))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	count = __metadata_extractor_record_u16(p + RECORD_OFFSET_COUNT);
+
+	if((__metadata_extractor_record_u32(p + RECORD_OFFSET_MAGIC) != METADATA_EXTRACTOR_RECORD_MAGIC) ||
+		(__metadata_extractor_record_u16(p + RECORD_OFFSET_VERSION) != METADATA_EXTRACTOR_RECORD_VERSION) ||
+		(__metadata_extractor_record_u32(p + RECORD_OFFSET_SIZE) != size) ||
+		(count > 32) || (RECORD_SLOT(count) > size))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) malformed record", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(!__metadata_extractor_record_check_string(p, size, p + RECORD_OFFSET_PATH, true))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) malformed path", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	present = __metadata_extractor_record_u32(p + RECORD_OFFSET_PRESENT);
+
+	for(attr = 0; (attr < count) && (attr < METADATA_EXTRACTOR_RECORD_ATTR_COUNT); attr++)
+	{
+		if((g_record_attr_type[attr] == METADATA_EXTRACTOR_RECORD_STRING) && (present & (1U << attr)) &&
+			!__metadata_extractor_record_check_string(p, size, p + RECORD_SLOT(attr), false))
+		{
+			LOGE("[%s]INVALID_PARAMETER(0x%08x) malformed attribute [%d]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER, attr);
+			return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+		}
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* slot of a present attribute of the given type, NULL when absent or written by an older version */
+static const unsigned char *__metadata_extractor_record_slot(const unsigned char *record, metadata_extractor_attr_e attribute)
+{
+	if(attribute >= __metadata_extractor_record_u16(record + RECORD_OFFSET_COUNT))
+	{
+		return NULL;
+	}
+
+	if(!(__metadata_extractor_record_u32(record + RECORD_OFFSET_PRESENT) & (1U << attribute)))
+	{
+		return NULL;
+	}
+
+	return record + RECORD_SLOT(attribute);
+}
+
+static bool __metadata_extractor_record_check_attr(const void *record, metadata_extractor_attr_e attribute, metadata_extractor_record_type_e type)
+{
+	if((record == NULL) || (attribute < 0) || (attribute >= METADATA_EXTRACTOR_RECORD_ATTR_COUNT))
+	{
+		return false;
+	}
+
+	return g_record_attr_type[attribute] == type;
+}
+
+int metadata_extractor_record_get_int(const void *record, metadata_extractor_attr_e attribute, int *value)
+{
+	const unsigned char *slot = NULL;
+
+	if((!value) || (!__metadata_extractor_record_check_attr(record, attribute, METADATA_EXTRACTOR_RECORD_INT)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	slot = __metadata_extractor_record_slot((const unsigned char *)record, attribute);
+	*value = (slot != NULL) ? (int)__metadata_extractor_record_u32(slot) : 0;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_record_get_double(const void *record, metadata_extractor_attr_e attribute, double *value)
+{
+	const unsigned char *slot = NULL;
+	uint64_t bits = 0;
+
+	if((!value) || (!__metadata_extractor_record_check_attr(record, attribute, METADATA_EXTRACTOR_RECORD_DOUBLE)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	slot = __metadata_extractor_record_slot((const unsigned char *)record, attribute);
+	if(slot != NULL)
+	{
+		bits = __metadata_extractor_record_u64(slot);
+	}
+	memcpy(value, &bits, sizeof(*value));
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_record_get_string(const void *record, metadata_extractor_attr_e attribute, const char **value, int *length)
+{
+	const unsigned char *slot = NULL;
+
+	if((!value) || (!__metadata_extractor_record_check_attr(record, attribute, METADATA_EXTRACTOR_RECORD_STRING)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	slot = __metadata_extractor_record_slot((const unsigned char *)record, attribute);
+	if(slot != NULL)
+	{
+		*value = (const char *)record + __metadata_extractor_record_u32(slot);
+		if(length != NULL)
+		{
+			*length = (int)__metadata_extractor_record_u32(slot + 4);
+		}
+	}
+	else
+	{
+		*value = NULL;
+		if(length != NULL)
+		{
+			*length = 0;
+		}
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_record_get_path(const void *record, const char **path)
+{
+	const unsigned char *p = (const unsigned char *)record;
+	uint32_t offset = 0;
+
+	if((!p) || (!path))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	offset = __metadata_extractor_record_u32(p + RECORD_OFFSET_PATH);
+	*path = (offset != 0) ? (const char *)p + offset : NULL;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
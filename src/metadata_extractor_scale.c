@@ -0,0 +1,549 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <png.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SCALE_MAX_DIMENSION		65535	/* keeps the accumulators of the resampler in 32 bits */
+#define SCALE_JPEG_QUALITY		85
+#define SCORE_DIMENSION			64		/* frames are scored on a thumbnail of at most this size */
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * Box filter fed one source row at a time, so that a JPEG is never held decoded in full.
+ * Positions are counted in units of 1/(src * dst) pixel: a source pixel is dst units wide and
+ * a destination pixel src units, so the share of every source pixel in a destination pixel is
+ * an exact integer and the shares of one destination pixel sum up to src.
+ */
+typedef struct
+{
+	int src_width;
+	int src_height;
+	int dst_width;
+	int dst_height;
+	unsigned short *row;			/* the current source row, filtered horizontally, times 256 */
+	unsigned int *sum;				/* the current destination row, summed vertically */
+	unsigned long long position;	/* vertical position of the next source row */
+	int dst_row;
+	unsigned char *pixels;			/* dst_height rows of dst_width RGB888 pixels */
+	size_t stride;					/* bytes from one row of pixels to the next */
+	bool own_pixels;
+}metadata_extractor_scaler_s;
+
+typedef struct
+{
+	struct jpeg_error_mgr pub;
+	jmp_buf jump;
+}metadata_extractor_jpeg_error_s;
+
+/* fit into max_width x max_height keeping the aspect ratio, never upscale */
+static void __metadata_extractor_scaler_fit(int width, int height, int max_width, int max_height, int *dst_width, int *dst_height)
+{
+	if((width <= max_width) && (height <= max_height))
+	{
+		*dst_width = width;
+		*dst_height = height;
+	}
+	else if((unsigned long long)width * max_height >= (unsigned long long)height * max_width)
+	{
+		*dst_width = max_width;
+		*dst_height = (int)(((unsigned long long)height * max_width + width / 2) / width);
+	}
+	else
+	{
+		*dst_height = max_height;
+		*dst_width = (int)(((unsigned long long)width * max_height + height / 2) / height);
+	}
+	if(*dst_width < 1)
+		*dst_width = 1;
+	if(*dst_height < 1)
+		*dst_height = 1;
+}
+
+/* pixels NULL has the scaler allocate its output, otherwise it writes rows stride bytes apart into pixels */
+static int __metadata_extractor_scaler_init(metadata_extractor_scaler_s *scaler, int width, int height, int max_width, int max_height, unsigned char *pixels, size_t stride)
+{
+	memset(scaler, 0, sizeof(metadata_extractor_scaler_s));
+
+	if((width <= 0) || (height <= 0) || (width > SCALE_MAX_DIMENSION) || (height > SCALE_MAX_DIMENSION))
+	{
+		LOGE("[%s]unsupported image size %dx%d", __FUNCTION__, width, height);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	scaler->src_width = width;
+	scaler->src_height = height;
+	__metadata_extractor_scaler_fit(width, height, max_width, max_height, &scaler->dst_width, &scaler->dst_height);
+
+	scaler->row = (unsigned short *)malloc((size_t)scaler->dst_width * 3 * sizeof(unsigned short));
+	scaler->sum = (unsigned int *)calloc((size_t)scaler->dst_width * 3, sizeof(unsigned int));
+	if(pixels != NULL)
+	{
+		scaler->pixels = pixels;
+		scaler->stride = stride;
+	}
+	else
+	{
+		scaler->pixels = (unsigned char *)malloc((size_t)scaler->dst_width * scaler->dst_height * 3);
+		scaler->stride = (size_t)scaler->dst_width * 3;
+		scaler->own_pixels = true;
+	}
+	if((scaler->row == NULL) || (scaler->sum == NULL) || (scaler->pixels == NULL))
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static void __metadata_extractor_scaler_release(metadata_extractor_scaler_s *scaler)
+{
+	free(scaler->row);
+	free(scaler->sum);
+	if(scaler->own_pixels)
+		free(scaler->pixels);
+	scaler->row = NULL;
+	scaler->sum = NULL;
+	scaler->pixels = NULL;
+}
+
+static void __metadata_extractor_scaler_filter_row(metadata_extractor_scaler_s *scaler, const unsigned char *src)
+{
+	unsigned int src_width = scaler->src_width;
+	unsigned int dst_width = scaler->dst_width;
+	unsigned long long bound = src_width;
+	unsigned long long position = 0;
+	unsigned int sum[3] = {0, };
+	unsigned int x = 0;
+	int dst = 0;
+
+	for(x = 0; x < src_width; x++)
+	{
+		const unsigned char *pixel = src + x * 3;
+		unsigned long long end = position + dst_width;
+		unsigned int share = (unsigned int)(((end < bound) ? end : bound) - position);
+
+		sum[0] += share * pixel[0];
+		sum[1] += share * pixel[1];
+		sum[2] += share * pixel[2];
+		position += share;
+
+		if(position == bound)
+		{
+			/* 255 * 256 at most */
+			scaler->row[dst * 3] = (unsigned short)(((unsigned long long)sum[0] * 256 + src_width / 2) / src_width);
+			scaler->row[dst * 3 + 1] = (unsigned short)(((unsigned long long)sum[1] * 256 + src_width / 2) / src_width);
+			scaler->row[dst * 3 + 2] = (unsigned short)(((unsigned long long)sum[2] * 256 + src_width / 2) / src_width);
+			dst++;
+			bound += src_width;
+
+			/* the rest of a pixel that straddles two destination pixels */
+			share = (unsigned int)(end - position);
+			sum[0] = share * pixel[0];
+			sum[1] = share * pixel[1];
+			sum[2] = share * pixel[2];
+			position = end;
+		}
+	}
+}
+
+static void __metadata_extractor_scaler_push_row(metadata_extractor_scaler_s *scaler, const unsigned char *src)
+{
+	unsigned int count = (unsigned int)scaler->dst_width * 3;
+	unsigned long long end = scaler->position + scaler->dst_height;
+	unsigned int idx = 0;
+
+	__metadata_extractor_scaler_filter_row(scaler, src);
+
+	while(scaler->position < end)
+	{
+		unsigned long long bound = (unsigned long long)(scaler->dst_row + 1) * scaler->src_height;
+		unsigned int share = (unsigned int)(((end < bound) ? end : bound) - scaler->position);
+		const unsigned short *row = scaler->row;
+		unsigned int *sum = scaler->sum;
+
+		/* the bulk of the work: plain multiply-add over the row, which the compiler vectorizes */
+		for(idx = 0; idx < count; idx++)
+			sum[idx] += share * row[idx];
+
+		scaler->position += share;
+
+		if(scaler->position == bound)
+		{
+			unsigned char *dst = scaler->pixels + (size_t)scaler->dst_row * scaler->stride;
+			unsigned long long divisor = (unsigned long long)scaler->src_height * 256;
+
+			for(idx = 0; idx < count; idx++)
+			{
+				dst[idx] = (unsigned char)((sum[idx] + divisor / 2) / divisor);
+				sum[idx] = 0;
+			}
+			scaler->dst_row++;
+		}
+	}
+}
+
+static void __metadata_extractor_scale_jpeg_error(j_common_ptr cinfo)
+{
+	metadata_extractor_jpeg_error_s *error = (metadata_extractor_jpeg_error_s *)cinfo->err;
+	char message[JMSG_LENGTH_MAX] = {0, };
+
+	(*cinfo->err->format_message)(cinfo, message);
+	LOGE("[%s]%s", __FUNCTION__, message);
+
+	longjmp(error->jump, 1);
+}
+
+static void __metadata_extractor_scale_jpeg_message(j_common_ptr cinfo)
+{
+	/* corrupt-data warnings of libjpeg go to stderr otherwise */
+}
+
+static int __metadata_extractor_scale_jpeg(const void *artwork, size_t size, int max_dim, metadata_extractor_scaler_s *scaler)
+{
+	struct jpeg_decompress_struct cinfo;
+	metadata_extractor_jpeg_error_s error;
+	unsigned char * volatile line = NULL;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int denom = 0;
+
+	memset(scaler, 0, sizeof(metadata_extractor_scaler_s));
+
+	cinfo.err = jpeg_std_error(&error.pub);
+	error.pub.error_exit = __metadata_extractor_scale_jpeg_error;
+	error.pub.output_message = __metadata_extractor_scale_jpeg_message;
+	if(setjmp(error.jump))
+	{
+		free(line);
+		jpeg_destroy_decompress(&cinfo);
+		__metadata_extractor_scaler_release(scaler);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char *)artwork, size);
+	jpeg_read_header(&cinfo, TRUE);
+
+	/*
+	 * The IDCT scales by 1/2, 1/4 or 1/8 for free, so only a fraction of the pixels is ever produced.
+	 * Take the smallest decode that still is at least max_dim, the box filter does the rest.
+	 */
+	cinfo.out_color_space = JCS_RGB;
+	cinfo.scale_num = 1;
+	for(denom = 8; denom > 1; denom /= 2)
+	{
+		if(((cinfo.image_width >= cinfo.image_height) ? cinfo.image_width : cinfo.image_height) / denom >= (unsigned int)max_dim)
+			break;
+	}
+	cinfo.scale_denom = denom;
+	/* the box filter smooths anyway */
+	cinfo.do_fancy_upsampling = FALSE;
+	cinfo.dct_method = JDCT_IFAST;
+
+	jpeg_start_decompress(&cinfo);
+
+	ret = __metadata_extractor_scaler_init(scaler, cinfo.output_width, cinfo.output_height, max_dim, max_dim, NULL, 0);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		jpeg_destroy_decompress(&cinfo);
+		__metadata_extractor_scaler_release(scaler);
+		return ret;
+	}
+
+	line = (unsigned char *)malloc((size_t)cinfo.output_width * 3);
+	if(line == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		jpeg_destroy_decompress(&cinfo);
+		__metadata_extractor_scaler_release(scaler);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	while(cinfo.output_scanline < cinfo.output_height)
+	{
+		JSAMPROW rows[1] = { line };
+
+		if(jpeg_read_scanlines(&cinfo, rows, 1) != 1)
+			break;
+		__metadata_extractor_scaler_push_row(scaler, line);
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	free(line);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* PNG has no reduced decode, the image is decoded in full and filtered row by row */
+static int __metadata_extractor_scale_png(const void *artwork, size_t size, int max_dim, metadata_extractor_scaler_s *scaler)
+{
+	png_image image;
+	unsigned char *pixels = NULL;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	unsigned int y = 0;
+
+	memset(scaler, 0, sizeof(metadata_extractor_scaler_s));
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+
+	if(!png_image_begin_read_from_memory(&image, artwork, size))
+	{
+		LOGE("[%s]%s", __FUNCTION__, image.message);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	ret = __metadata_extractor_scaler_init(scaler, image.width, image.height, max_dim, max_dim, NULL, 0);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		png_image_free(&image);
+		__metadata_extractor_scaler_release(scaler);
+		return ret;
+	}
+
+	/* transparency is composited onto black */
+	image.format = PNG_FORMAT_RGB;
+	pixels = (unsigned char *)malloc(PNG_IMAGE_SIZE(image));
+	if(pixels == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		png_image_free(&image);
+		__metadata_extractor_scaler_release(scaler);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	if(!png_image_finish_read(&image, NULL, pixels, 0, NULL))
+	{
+		LOGE("[%s]%s", __FUNCTION__, image.message);
+		free(pixels);
+		__metadata_extractor_scaler_release(scaler);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	for(y = 0; y < image.height; y++)
+	{
+		__metadata_extractor_scaler_push_row(scaler, pixels + (size_t)y * PNG_IMAGE_ROW_STRIDE(image));
+	}
+
+	free(pixels);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_scale_encode_jpeg(metadata_extractor_scaler_s *scaler, metadata_extractor_image_s *image)
+{
+	struct jpeg_compress_struct cinfo;
+	metadata_extractor_jpeg_error_s error;
+	unsigned char *data = NULL;
+	unsigned long size = 0;
+
+	cinfo.err = jpeg_std_error(&error.pub);
+	error.pub.error_exit = __metadata_extractor_scale_jpeg_error;
+	error.pub.output_message = __metadata_extractor_scale_jpeg_message;
+	if(setjmp(error.jump))
+	{
+		jpeg_destroy_compress(&cinfo);
+		free(data);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	jpeg_create_compress(&cinfo);
+	jpeg_mem_dest(&cinfo, &data, &size);
+
+	cinfo.image_width = scaler->dst_width;
+	cinfo.image_height = scaler->dst_height;
+	cinfo.input_components = 3;
+	cinfo.in_color_space = JCS_RGB;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, SCALE_JPEG_QUALITY, TRUE);
+
+	jpeg_start_compress(&cinfo, TRUE);
+	while(cinfo.next_scanline < cinfo.image_height)
+	{
+		JSAMPROW rows[1] = { scaler->pixels + (size_t)cinfo.next_scanline * scaler->dst_width * 3 };
+
+		jpeg_write_scanlines(&cinfo, rows, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	image->data = data;
+	image->size = size;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int __metadata_extractor_scale_artwork(const void *artwork, size_t size, int max_dim, metadata_extractor_image_format_e format, metadata_extractor_image_s *image)
+{
+	const unsigned char *data = (const unsigned char *)artwork;
+	metadata_extractor_scaler_s scaler;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+
+	/* by magic bytes, the MIME type of the tag is often wrong */
+	if((size >= 3) && (data[0] == 0xff) && (data[1] == 0xd8) && (data[2] == 0xff))
+	{
+		ret = __metadata_extractor_scale_jpeg(artwork, size, max_dim, &scaler);
+	}
+	else if((size >= 8) && (memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0))
+	{
+		ret = __metadata_extractor_scale_png(artwork, size, max_dim, &scaler);
+	}
+	else
+	{
+		LOGE("[%s]artwork is neither JPEG nor PNG", __FUNCTION__);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if(scaler.dst_row != scaler.dst_height)
+	{
+		/* truncated data, the bottom rows were never completed */
+		memset(scaler.pixels + (size_t)scaler.dst_row * scaler.dst_width * 3, 0, (size_t)(scaler.dst_height - scaler.dst_row) * scaler.dst_width * 3);
+	}
+
+	image->width = scaler.dst_width;
+	image->height = scaler.dst_height;
+
+	if(format == METADATA_EXTRACTOR_IMAGE_FORMAT_JPEG)
+	{
+		ret = __metadata_extractor_scale_encode_jpeg(&scaler, image);
+		__metadata_extractor_scaler_release(&scaler);
+		return ret;
+	}
+
+	image->data = scaler.pixels;
+	image->size = (size_t)scaler.dst_width * scaler.dst_height * 3;
+	scaler.pixels = NULL;
+	__metadata_extractor_scaler_release(&scaler);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* box-filters an RGB888 frame straight into a max_width x max_height slot of a larger image, centered */
+int __metadata_extractor_scale_frame(const unsigned char *frame, int width, int height, unsigned char *slot, int max_width, int max_height, size_t stride)
+{
+	metadata_extractor_scaler_s scaler;
+	int dst_width = 0;
+	int dst_height = 0;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int y = 0;
+
+	__metadata_extractor_scaler_fit(width, height, max_width, max_height, &dst_width, &dst_height);
+	slot += (size_t)((max_height - dst_height) / 2) * stride + (size_t)((max_width - dst_width) / 2) * 3;
+
+	ret = __metadata_extractor_scaler_init(&scaler, width, height, max_width, max_height, slot, stride);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_scaler_release(&scaler);
+		return ret;
+	}
+
+	for(y = 0; y < height; y++)
+	{
+		__metadata_extractor_scaler_push_row(&scaler, frame + (size_t)y * width * 3);
+	}
+
+	__metadata_extractor_scaler_release(&scaler);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/*
+ * How much a frame shows: the entropy of its luma histogram in bits plus its luma standard deviation
+ * in units of 32, computed on a thumbnail. Black, white and faded frames score near 0, detailed ones 8 and more.
+ */
+int __metadata_extractor_score_frame(const unsigned char *frame, int width, int height, double *score)
+{
+	metadata_extractor_scaler_s scaler;
+	unsigned char thumbnail[SCORE_DIMENSION * SCORE_DIMENSION * 3];
+	unsigned char luma[SCORE_DIMENSION * SCORE_DIMENSION];
+	unsigned int histogram[256];
+	unsigned long long sum = 0;
+	unsigned long long square_sum = 0;
+	double entropy = 0;
+	double mean = 0;
+	double variance = 0;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int pixels = 0;
+	int idx = 0;
+
+	ret = __metadata_extractor_scaler_init(&scaler, width, height, SCORE_DIMENSION, SCORE_DIMENSION, thumbnail, SCORE_DIMENSION * 3);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_scaler_release(&scaler);
+		return ret;
+	}
+
+	/* the fitted thumbnail is packed at the top of the buffer, without a letterbox to skew the histogram */
+	scaler.stride = (size_t)scaler.dst_width * 3;
+	pixels = scaler.dst_width * scaler.dst_height;
+
+	for(idx = 0; idx < height; idx++)
+	{
+		__metadata_extractor_scaler_push_row(&scaler, frame + (size_t)idx * width * 3);
+	}
+	__metadata_extractor_scaler_release(&scaler);
+
+	/* branch-free loops over flat arrays, which the compiler turns into vector code */
+	for(idx = 0; idx < pixels; idx++)
+	{
+		luma[idx] = (unsigned char)((77 * thumbnail[idx * 3] + 150 * thumbnail[idx * 3 + 1] + 29 * thumbnail[idx * 3 + 2] + 128) >> 8);
+	}
+	for(idx = 0; idx < pixels; idx++)
+	{
+		sum += luma[idx];
+		square_sum += (unsigned int)luma[idx] * luma[idx];
+	}
+
+	memset(histogram, 0, sizeof(histogram));
+	for(idx = 0; idx < pixels; idx++)
+	{
+		histogram[luma[idx]]++;
+	}
+	for(idx = 0; idx < 256; idx++)
+	{
+		if(histogram[idx] > 0)
+		{
+			double p = (double)histogram[idx] / pixels;
+			entropy -= p * log2(p);
+		}
+	}
+
+	mean = (double)sum / pixels;
+	variance = (double)square_sum / pixels - mean * mean;
+	if(variance < 0)
+		variance = 0;
+
+	*score = entropy + sqrt(variance) / 32;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
@@ -0,0 +1,347 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define TEXT_HIGH_BITS		0x8080808080808080ULL
+#define TEXT_REPLACEMENT	0xfffd
+
+/*
+ * Tag strings come from mm-fileinfo mostly as UTF-8, but frames it did not convert show up as Latin-1,
+ * as UTF-16 with a BOM or as BOM-less UTF-16BE, and fixed-size fields are padded with NULs or spaces.
+ * Everything is turned into trimmed, valid UTF-8 here. The common case, a string that is already clean,
+ * is checked eight bytes at a time and not copied at all.
+ */
+
+/* length of the leading ASCII run */
+static size_t __metadata_extractor_text_ascii_run(const unsigned char *text, size_t length)
+{
+	size_t pos = 0;
+	uint64_t word = 0;
+
+	for(; pos + 8 <= length; pos += 8)
+	{
+		memcpy(&word, text + pos, 8);
+		if(word & TEXT_HIGH_BITS)
+		{
+			break;
+		}
+	}
+
+	while((pos < length) && (text[pos] < 0x80))
+	{
+		pos++;
+	}
+
+	return pos;
+}
+
+/* length of the well-formed UTF-8 sequence at text, 0 when it is malformed */
+static size_t __metadata_extractor_text_utf8_sequence(const unsigned char *text, size_t length)
+{
+	unsigned char lead = text[0];
+	unsigned char low = 0x80;
+	unsigned char high = 0xbf;
+	size_t size = 0;
+	size_t idx = 0;
+
+	if((lead >= 0xc2) && (lead <= 0xdf))
+	{
+		size = 2;
+	}
+	else if((lead >= 0xe0) && (lead <= 0xef))
+	{
+		size = 3;
+		if(lead == 0xe0)
+			low = 0xa0;		/* overlong */
+		else if(lead == 0xed)
+			high = 0x9f;	/* surrogates */
+	}
+	else if((lead >= 0xf0) && (lead <= 0xf4))
+	{
+		size = 4;
+		if(lead == 0xf0)
+			low = 0x90;		/* overlong */
+		else if(lead == 0xf4)
+			high = 0x8f;	/* above U+10FFFF */
+	}
+	else
+	{
+		return 0;
+	}
+
+	if(length < size)
+	{
+		return 0;
+	}
+
+	if((text[1] < low) || (text[1] > high))
+	{
+		return 0;
+	}
+
+	for(idx = 2; idx < size; idx++)
+	{
+		if((text[idx] & 0xc0) != 0x80)
+		{
+			return 0;
+		}
+	}
+
+	return size;
+}
+
+static bool __metadata_extractor_text_is_utf8(const unsigned char *text, size_t length)
+{
+	size_t pos = 0;
+
+	while(pos < length)
+	{
+		size_t size = 0;
+
+		pos += __metadata_extractor_text_ascii_run(text + pos, length - pos);
+		if(pos == length)
+		{
+			break;
+		}
+
+		size = __metadata_extractor_text_utf8_sequence(text + pos, length - pos);
+		if(size == 0)
+		{
+			return false;
+		}
+		pos += size;
+	}
+
+	return true;
+}
+
+static char *__metadata_extractor_text_put_utf8(char *out, unsigned int code)
+{
+	if(code < 0x80)
+	{
+		*out++ = (char)code;
+	}
+	else if(code < 0x800)
+	{
+		*out++ = (char)(0xc0 | (code >> 6));
+		*out++ = (char)(0x80 | (code & 0x3f));
+	}
+	else if(code < 0x10000)
+	{
+		*out++ = (char)(0xe0 | (code >> 12));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+		*out++ = (char)(0x80 | (code & 0x3f));
+	}
+	else
+	{
+		*out++ = (char)(0xf0 | (code >> 18));
+		*out++ = (char)(0x80 | ((code >> 12) & 0x3f));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+		*out++ = (char)(0x80 | (code & 0x3f));
+	}
+
+	return out;
+}
+
+/* ISO-8859-1 maps one to one onto U+0000..U+00FF */
+static char *__metadata_extractor_text_from_latin1(const unsigned char *text, size_t length, char *out)
+{
+	size_t pos = 0;
+
+	while(pos < length)
+	{
+		size_t run = __metadata_extractor_text_ascii_run(text + pos, length - pos);
+
+		memcpy(out, text + pos, run);
+		out += run;
+		pos += run;
+
+		if(pos < length)
+		{
+			out = __metadata_extractor_text_put_utf8(out, text[pos]);
+			pos++;
+		}
+	}
+
+	return out;
+}
+
+/* stops at U+0000; unpaired surrogates become U+FFFD */
+static char *__metadata_extractor_text_from_utf16(const unsigned char *text, size_t length, bool big_endian, char *out)
+{
+	size_t pos = 0;
+
+	for(pos = 0; pos + 2 <= length; pos += 2)
+	{
+		unsigned int code = 0;
+
+		/* four ASCII units at a time */
+		while(pos + 8 <= length)
+		{
+			const unsigned char *lo = text + pos + (big_endian ? 1 : 0);
+			const unsigned char *hi = text + pos + (big_endian ? 0 : 1);
+
+			if((hi[0] | hi[2] | hi[4] | hi[6]) || ((lo[0] | lo[2] | lo[4] | lo[6]) & 0x80) ||
+				(lo[0] == 0) || (lo[2] == 0) || (lo[4] == 0) || (lo[6] == 0))
+			{
+				break;
+			}
+
+			out[0] = (char)lo[0];
+			out[1] = (char)lo[2];
+			out[2] = (char)lo[4];
+			out[3] = (char)lo[6];
+			out += 4;
+			pos += 8;
+		}
+
+		if(pos + 2 > length)
+		{
+			break;
+		}
+
+		code = big_endian ? ((text[pos] << 8) | text[pos + 1]) : ((text[pos + 1] << 8) | text[pos]);
+
+		if(code == 0)
+		{
+			break;
+		}
+
+		if((code >= 0xd800) && (code <= 0xdbff) && (pos + 4 <= length))
+		{
+			unsigned int low = big_endian ? ((text[pos + 2] << 8) | text[pos + 3]) : ((text[pos + 3] << 8) | text[pos + 2]);
+
+			if((low >= 0xdc00) && (low <= 0xdfff))
+			{
+				code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+				pos += 2;
+			}
+		}
+
+		if((code >= 0xd800) && (code <= 0xdfff))
+		{
+			code = TEXT_REPLACEMENT;
+		}
+
+		out = __metadata_extractor_text_put_utf8(out, code);
+	}
+
+	return out;
+}
+
+static size_t __metadata_extractor_text_trim_end(const char *text, size_t length)
+{
+	while((length > 0) && (text[length - 1] == ' '))
+	{
+		length--;
+	}
+
+	return length;
+}
+
+/*
+ * length is the size reported for the tag, used only to read UTF-16 past its first zero byte;
+ * other text is read up to its terminating NUL. *normalized is NULL when text is clean as it is,
+ * otherwise a malloc()ed null-terminated UTF-8 string.
+ */
+int __metadata_extractor_text_normalize(const char *text, int length, char **normalized)
+{
+	const unsigned char *bytes = (const unsigned char *)text;
+	size_t start = 0;
+	size_t end = 0;
+	size_t text_length = 0;
+	char *out = NULL;
+	char *out_end = NULL;
+	bool utf16 = false;
+	bool big_endian = false;
+
+	*normalized = NULL;
+
+	if((length >= 2) && (((bytes[0] == 0xff) && (bytes[1] == 0xfe)) || ((bytes[0] == 0xfe) && (bytes[1] == 0xff))))
+	{
+		utf16 = true;
+		big_endian = (bytes[0] == 0xfe);
+		start = 2;
+	}
+	else if((length >= 2) && (bytes[0] == 0) && (bytes[1] != 0))
+	{
+		/* BOM-less UTF-16BE of a Latin script; read as a C string it would be empty */
+		utf16 = true;
+		big_endian = true;
+	}
+
+	if(utf16)
+	{
+		out = (char *)malloc((length - start) / 2 * 3 + 1);
+		if(out == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+
+		out_end = __metadata_extractor_text_from_utf16(bytes + start, length - start, big_endian, out);
+		out_end = out + __metadata_extractor_text_trim_end(out, out_end - out);
+		*out_end = '\0';
+		*normalized = out;
+
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	text_length = strlen(text);
+	end = __metadata_extractor_text_trim_end(text, text_length);
+
+	if((end >= 3) && (bytes[0] == 0xef) && (bytes[1] == 0xbb) && (bytes[2] == 0xbf))
+	{
+		start = 3;
+	}
+
+	if(__metadata_extractor_text_is_utf8(bytes + start, end - start))
+	{
+		if((start == 0) && (end == text_length))
+		{
+			return METADATA_EXTRACTOR_ERROR_NONE;
+		}
+
+		out = (char *)malloc(end - start + 1);
+		if(out == NULL)
+		{
+			return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+		memcpy(out, text + start, end - start);
+		out[end - start] = '\0';
+		*normalized = out;
+
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	/* not UTF-8, so the bytes are taken as Latin-1 */
+	out = (char *)malloc((end - start) * 2 + 1);
+	if(out == NULL)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	out_end = __metadata_extractor_text_from_latin1(bytes + start, end - start, out);
+	*out_end = '\0';
+	*normalized = out;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
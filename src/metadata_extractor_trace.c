@@ -0,0 +1,413 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define TRACE_RING_SIZE		2048
+#define TRACE_DETAIL_LEN	96
+#define TRACE_DETAIL_WORDS	(TRACE_DETAIL_LEN / sizeof(unsigned long long))
+#define TRACE_RETIRED_MAX	16
+#define TRACE_ENV			"METADATA_EXTRACTOR_TRACE"
+#define TRACE_PATH_MAX		4096
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * Each thread records complete ("X") events into its own ring, so recording takes no lock.
+ * Rings are registered once in a global list that the flush walks. When a ring wraps, the
+ * oldest events are overwritten. Events recorded while a flush is running may be missed.
+ *
+ * The flush copies events while their thread may be overwriting them, seqlock style: the owner
+ * announces the event it is about to write in claim before touching the slot, and the flush
+ * drops a copied event if claim shows that its slot was reused meanwhile. All event fields are
+ * accessed atomically, the detail string a word at a time.
+ *
+ * When a thread exits its ring is retired; the next flush writes and frees it. Past
+ * TRACE_RETIRED_MAX retired rings, a new thread takes over the oldest and its events are lost.
+ */
+typedef struct
+{
+	const char *name;
+	unsigned long long ts;
+	unsigned long long dur;
+	unsigned long long detail[TRACE_DETAIL_WORDS];	/* null-terminated string */
+} trace_event_s;
+
+typedef struct trace_ring_s
+{
+	long tid;
+	unsigned long long head;	/* written by the owning thread only */
+	unsigned long long claim;	/* 1 + the event being written, by the owning thread only */
+	unsigned long long tail;	/* written by the flush only */
+	bool retired;				/* the owning thread exited, under g_trace_lock */
+	trace_event_s event[TRACE_RING_SIZE];
+	struct trace_ring_s *next;
+} trace_ring_s;
+
+static int g_trace_enabled = 0;
+static pthread_once_t g_trace_env_once = PTHREAD_ONCE_INIT;
+static char g_trace_env_path[TRACE_PATH_MAX] = {0, };
+static pthread_mutex_t g_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_ring_s *g_trace_rings = NULL;
+static int g_trace_retired = 0;
+static pthread_once_t g_trace_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_trace_key;
+static bool g_trace_key_created = false;
+static __thread trace_ring_s *g_trace_thread_ring = NULL;
+
+static unsigned long long __metadata_extractor_trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000ULL + (unsigned long long)(ts.tv_nsec / 1000);
+}
+
+static void __metadata_extractor_trace_check_env(void)
+{
+	const char *path = getenv(TRACE_ENV);
+
+	if((path == NULL) || (path[0] == '\0'))
+	{
+		return;
+	}
+
+	snprintf(g_trace_env_path, sizeof(g_trace_env_path), "%s", path);
+	/* written by __metadata_extractor_trace_unload(), at exit or when the library is unloaded */
+	__atomic_store_n(&g_trace_enabled, 1, __ATOMIC_RELEASE);
+
+	metadata_extractor_info("[%s] tracing to [%s] \n", __FUNCTION__, g_trace_env_path);
+}
+
+/* rings outlive their threads so that late flushes still see the events */
+static void __metadata_extractor_trace_thread_exit(void *data)
+{
+	trace_ring_s *ring = (trace_ring_s *)data;
+
+	pthread_mutex_lock(&g_trace_lock);
+	ring->retired = true;
+	g_trace_retired++;
+	pthread_mutex_unlock(&g_trace_lock);
+
+	/* a later destructor of this thread that traces gets a ring of its own */
+	g_trace_thread_ring = NULL;
+}
+
+static void __metadata_extractor_trace_create_key(void)
+{
+	g_trace_key_created = (pthread_key_create(&g_trace_key, __metadata_extractor_trace_thread_exit) == 0);
+}
+
+static trace_ring_s *__metadata_extractor_trace_ring(void)
+{
+	trace_ring_s *ring = g_trace_thread_ring;
+	trace_ring_s *oldest = NULL;
+
+	if(ring != NULL)
+	{
+		return ring;
+	}
+
+	pthread_once(&g_trace_key_once, __metadata_extractor_trace_create_key);
+	if(!g_trace_key_created)
+	{
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_trace_lock);
+
+	if(g_trace_retired >= TRACE_RETIRED_MAX)
+	{
+		/* the list is newest first */
+		for(ring = g_trace_rings; ring != NULL; ring = ring->next)
+		{
+			if(ring->retired)
+				oldest = ring;
+		}
+	}
+
+	if(oldest != NULL)
+	{
+		ring = oldest;
+		ring->head = 0;
+		ring->claim = 0;
+		ring->tail = 0;
+		ring->retired = false;
+		g_trace_retired--;
+	}
+	else
+	{
+		ring = (trace_ring_s *)calloc(1, sizeof(trace_ring_s));
+		if(ring != NULL)
+		{
+			ring->next = g_trace_rings;
+			g_trace_rings = ring;
+		}
+	}
+	if(ring != NULL)
+	{
+		ring->tid = (long)syscall(SYS_gettid);
+	}
+
+	pthread_mutex_unlock(&g_trace_lock);
+
+	if(ring == NULL)
+	{
+		return NULL;
+	}
+
+	pthread_setspecific(g_trace_key, ring);
+	g_trace_thread_ring = ring;
+
+	return ring;
+}
+
+unsigned long long __metadata_extractor_trace_begin(void)
+{
+	pthread_once(&g_trace_env_once, __metadata_extractor_trace_check_env);
+
+	if(!__atomic_load_n(&g_trace_enabled, __ATOMIC_RELAXED))
+	{
+		return 0;
+	}
+
+	return __metadata_extractor_trace_now();
+}
+
+void __metadata_extractor_trace_end(const char *name, unsigned long long begin, const char *detail)
+{
+	trace_ring_s *ring = NULL;
+	trace_event_s *event = NULL;
+	unsigned long long head = 0;
+	unsigned long long words[TRACE_DETAIL_WORDS];
+	size_t idx = 0;
+
+	if(begin == 0)
+	{
+		return;
+	}
+
+	ring = __metadata_extractor_trace_ring();
+	if(ring == NULL)
+	{
+		return;
+	}
+
+	memset(words, 0, sizeof(words));
+	if(detail != NULL)
+	{
+		/* keep the tail of long paths, it names the file */
+		size_t len = strlen(detail);
+		if(len >= TRACE_DETAIL_LEN)
+		{
+			detail += len - (TRACE_DETAIL_LEN - 1);
+		}
+		snprintf((char *)words, sizeof(words), "%s", detail);
+	}
+
+	head = ring->head;
+	event = &ring->event[head % TRACE_RING_SIZE];
+
+	/* the slot is about to be reused, a flush copying its old event must drop it */
+	__atomic_store_n(&ring->claim, head + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&event->name, name, __ATOMIC_RELAXED);
+	__atomic_store_n(&event->ts, begin, __ATOMIC_RELAXED);
+	__atomic_store_n(&event->dur, __metadata_extractor_trace_now() - begin, __ATOMIC_RELAXED);
+	for(idx = 0; idx < TRACE_DETAIL_WORDS; idx++)
+	{
+		__atomic_store_n(&event->detail[idx], words[idx], __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static void __metadata_extractor_trace_write_string(FILE *fp, const char *str)
+{
+	const unsigned char *ch = (const unsigned char *)str;
+
+	fputc('"', fp);
+	for(; *ch != '\0'; ch++)
+	{
+		if((*ch == '"') || (*ch == '\\'))
+		{
+			fputc('\\', fp);
+			fputc(*ch, fp);
+		}
+		else if(*ch < 0x20)
+		{
+			fprintf(fp, "\\u%04x", *ch);
+		}
+		else
+		{
+			fputc(*ch, fp);
+		}
+	}
+	fputc('"', fp);
+}
+
+int metadata_extractor_set_trace_enabled(bool enable)
+{
+	pthread_once(&g_trace_env_once, __metadata_extractor_trace_check_env);
+
+	__atomic_store_n(&g_trace_enabled, enable ? 1 : 0, __ATOMIC_RELEASE);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* the event idx of ring, or false if its thread overwrote it while it was copied */
+static bool __metadata_extractor_trace_copy(trace_ring_s *ring, unsigned long long idx, trace_event_s *copy)
+{
+	trace_event_s *event = &ring->event[idx % TRACE_RING_SIZE];
+	size_t word = 0;
+
+	copy->name = __atomic_load_n(&event->name, __ATOMIC_RELAXED);
+	copy->ts = __atomic_load_n(&event->ts, __ATOMIC_RELAXED);
+	copy->dur = __atomic_load_n(&event->dur, __ATOMIC_RELAXED);
+	for(word = 0; word < TRACE_DETAIL_WORDS; word++)
+	{
+		copy->detail[word] = __atomic_load_n(&event->detail[word], __ATOMIC_RELAXED);
+	}
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	/* event idx + TRACE_RING_SIZE is the first to reuse the slot */
+	return __atomic_load_n(&ring->claim, __ATOMIC_RELAXED) <= idx + TRACE_RING_SIZE;
+}
+
+int metadata_extractor_trace_flush(const char *path)
+{
+	trace_ring_s *ring = NULL;
+	trace_ring_s **link = NULL;
+	trace_event_s event;
+	FILE *fp = NULL;
+	bool first = true;
+	long pid = (long)getpid();
+
+	if((!path) || (path[0] == '\0'))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	fp = fopen(path, "w");
+	if(fp == NULL)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not open [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, path);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp);
+
+	pthread_mutex_lock(&g_trace_lock);
+
+	link = &g_trace_rings;
+	while((ring = *link) != NULL)
+	{
+		unsigned long long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		unsigned long long idx = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+
+		if(idx < ring->tail)
+		{
+			idx = ring->tail;
+		}
+
+		fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%ld,\"args\":{\"name\":\"extractor-%ld\"}}", first ? "" : ",", pid, ring->tid, ring->tid);
+		first = false;
+
+		for(; idx < head; idx++)
+		{
+			const char *detail = (const char *)event.detail;
+
+			if(!__metadata_extractor_trace_copy(ring, idx, &event))
+			{
+				continue;
+			}
+			/* a torn copy is dropped above, this only guards against a bad terminator */
+			((char *)event.detail)[TRACE_DETAIL_LEN - 1] = '\0';
+
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"metadata_extractor\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%ld,\"tid\":%ld",
+					event.name, event.ts, event.dur, pid, ring->tid);
+			if(detail[0] != '\0')
+			{
+				fputs(",\"args\":{\"path\":", fp);
+				__metadata_extractor_trace_write_string(fp, detail);
+				fputc('}', fp);
+			}
+			fputc('}', fp);
+		}
+
+		/* the next flush starts where this one ended */
+		ring->tail = head;
+
+		if(ring->retired)
+		{
+			*link = ring->next;
+			g_trace_retired--;
+			free(ring);
+		}
+		else
+		{
+			link = &ring->next;
+		}
+	}
+
+	pthread_mutex_unlock(&g_trace_lock);
+
+	fputs("\n]}\n", fp);
+
+	if(fclose(fp) != 0)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not write [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, path);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/*
+ * At exit, and at dlclose() so that no thread exit calls into the unloaded library. Rings are
+ * left alone: at exit other threads may still be recording into theirs.
+ */
+static void __attribute__((destructor)) __metadata_extractor_trace_unload(void)
+{
+	if(g_trace_env_path[0] != '\0')
+	{
+		metadata_extractor_trace_flush(g_trace_env_path);
+	}
+
+	if(g_trace_key_created)
+	{
+		pthread_key_delete(g_trace_key);
+		g_trace_key_created = false;
+	}
+}
@@ -0,0 +1,844 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define WATCHER_INITIAL_BUCKETS		1024
+#define WATCHER_EVENT_BUFFER		(64 * 1024)
+#define WATCHER_EXTRACT_BATCH		32		/* files extracted between two reads of the event queue */
+#define WATCHER_WATCH_MASK			(IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+									IN_DONT_FOLLOW | IN_ONLYDIR | IN_EXCL_UNLINK)
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+/*
+ * One thread reads inotify events for every directory of the tree. A file written and closed, or moved in,
+ * becomes pending with a deadline; further writes push the deadline back, so a file copied in chunks is
+ * extracted once, after it settles. Pending entries are kept in deadline order in a list, and the index
+ * maps paths to the serialized record of their last extraction. Only the watcher thread changes the index;
+ * the lock is held while it does, and by readers.
+ */
+typedef struct metadata_extractor_watcher_entry_s
+{
+	struct metadata_extractor_watcher_entry_s *next;			/* bucket chain */
+	struct metadata_extractor_watcher_entry_s *pending_prev;
+	struct metadata_extractor_watcher_entry_s *pending_next;
+	uint64_t hash;
+	unsigned long long deadline;	/* ms, 0 when not pending */
+	void *record;					/* NULL until extracted */
+	size_t record_size;
+	char path[];
+}metadata_extractor_watcher_entry_s;
+
+typedef struct
+{
+	char *root;
+	int debounce;
+	metadata_extractor_watcher_cb callback;
+	void *user_data;
+	metadata_extractor_h metadata;
+	int inotify_fd;
+	int stop_fd;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	metadata_extractor_watcher_entry_s **buckets;
+	unsigned int bucket_mask;
+	int count;
+	int record_count;
+	metadata_extractor_watcher_entry_s *pending_head;
+	metadata_extractor_watcher_entry_s *pending_tail;
+	char **watches;				/* directory per watch descriptor */
+	int watch_capacity;
+}metadata_extractor_watcher_s;
+
+static unsigned long long __metadata_extractor_watcher_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static metadata_extractor_watcher_entry_s *__metadata_extractor_watcher_find(metadata_extractor_watcher_s *watcher, const char *path, uint64_t hash)
+{
+	metadata_extractor_watcher_entry_s *entry = watcher->buckets[hash & watcher->bucket_mask];
+
+	while(entry != NULL)
+	{
+		if((entry->hash == hash) && (strcmp(entry->path, path) == 0))
+		{
+			return entry;
+		}
+		entry = entry->next;
+	}
+
+	return NULL;
+}
+
+static void __metadata_extractor_watcher_pending_unlink(metadata_extractor_watcher_s *watcher, metadata_extractor_watcher_entry_s *entry)
+{
+	if(entry->deadline == 0)
+	{
+		return;
+	}
+
+	if(entry->pending_prev)
+		entry->pending_prev->pending_next = entry->pending_next;
+	else
+		watcher->pending_head = entry->pending_next;
+
+	if(entry->pending_next)
+		entry->pending_next->pending_prev = entry->pending_prev;
+	else
+		watcher->pending_tail = entry->pending_prev;
+
+	entry->pending_prev = NULL;
+	entry->pending_next = NULL;
+	entry->deadline = 0;
+}
+
+/* the debounce is the same for every file, so appending keeps the list in deadline order */
+static void __metadata_extractor_watcher_pending_append(metadata_extractor_watcher_s *watcher, metadata_extractor_watcher_entry_s *entry, unsigned long long deadline)
+{
+	__metadata_extractor_watcher_pending_unlink(watcher, entry);
+
+	entry->deadline = deadline;
+	entry->pending_prev = watcher->pending_tail;
+	if(watcher->pending_tail)
+		watcher->pending_tail->pending_next = entry;
+	else
+		watcher->pending_head = entry;
+	watcher->pending_tail = entry;
+}
+
+static int __metadata_extractor_watcher_grow_buckets(metadata_extractor_watcher_s *watcher)
+{
+	unsigned int bucket_count = (watcher->bucket_mask + 1) * 2;
+	metadata_extractor_watcher_entry_s **buckets = NULL;
+	unsigned int idx = 0;
+
+	buckets = (metadata_extractor_watcher_entry_s **)calloc(bucket_count, sizeof(metadata_extractor_watcher_entry_s *));
+	if(buckets == NULL)
+	{
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	for(idx = 0; idx <= watcher->bucket_mask; idx++)
+	{
+		metadata_extractor_watcher_entry_s *entry = watcher->buckets[idx];
+
+		while(entry != NULL)
+		{
+			metadata_extractor_watcher_entry_s *next = entry->next;
+
+			entry->next = buckets[entry->hash & (bucket_count - 1)];
+			buckets[entry->hash & (bucket_count - 1)] = entry;
+			entry = next;
+		}
+	}
+
+	SAFE_FREE(watcher->buckets);
+	watcher->buckets = buckets;
+	watcher->bucket_mask = bucket_count - 1;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* makes path pending, adding it to the index without a record if it is not there */
+static void __metadata_extractor_watcher_schedule(metadata_extractor_watcher_s *watcher, const char *path, unsigned long long deadline)
+{
+	size_t length = strlen(path);
+	uint64_t hash = __metadata_extractor_hash(path, length);
+	metadata_extractor_watcher_entry_s *entry = NULL;
+
+	pthread_mutex_lock(&watcher->lock);
+
+	entry = __metadata_extractor_watcher_find(watcher, path, hash);
+	if(entry == NULL)
+	{
+		if((unsigned int)watcher->count > watcher->bucket_mask)
+		{
+			/* a longer chain is only slower */
+			__metadata_extractor_watcher_grow_buckets(watcher);
+		}
+
+		entry = (metadata_extractor_watcher_entry_s *)calloc(1, sizeof(metadata_extractor_watcher_entry_s) + length + 1);
+		if(entry == NULL)
+		{
+			pthread_mutex_unlock(&watcher->lock);
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			return;
+		}
+		entry->hash = hash;
+		memcpy(entry->path, path, length + 1);
+		entry->next = watcher->buckets[hash & watcher->bucket_mask];
+		watcher->buckets[hash & watcher->bucket_mask] = entry;
+		watcher->count++;
+	}
+
+	__metadata_extractor_watcher_pending_append(watcher, entry, deadline);
+
+	pthread_mutex_unlock(&watcher->lock);
+}
+
+/* called with the lock held */
+static void __metadata_extractor_watcher_remove_locked(metadata_extractor_watcher_s *watcher, metadata_extractor_watcher_entry_s *entry)
+{
+	metadata_extractor_watcher_entry_s **link = &watcher->buckets[entry->hash & watcher->bucket_mask];
+
+	while(*link != entry)
+	{
+		link = &(*link)->next;
+	}
+	*link = entry->next;
+
+	__metadata_extractor_watcher_pending_unlink(watcher, entry);
+
+	if(entry->record != NULL)
+	{
+		watcher->record_count--;
+	}
+	watcher->count--;
+
+	SAFE_FREE(entry->record);
+	free(entry);
+}
+
+static void __metadata_extractor_watcher_remove(metadata_extractor_watcher_s *watcher, const char *path)
+{
+	metadata_extractor_watcher_entry_s *entry = NULL;
+	bool had_record = false;
+
+	pthread_mutex_lock(&watcher->lock);
+	entry = __metadata_extractor_watcher_find(watcher, path, __metadata_extractor_hash(path, strlen(path)));
+	if(entry != NULL)
+	{
+		had_record = (entry->record != NULL);
+		__metadata_extractor_watcher_remove_locked(watcher, entry);
+	}
+	pthread_mutex_unlock(&watcher->lock);
+
+	if(had_record)
+	{
+		watcher->callback(path, METADATA_EXTRACTOR_JOURNAL_DELETED, watcher->user_data);
+	}
+}
+
+/* removes every entry under directory dir, for a directory moved out of the tree */
+static void __metadata_extractor_watcher_remove_tree(metadata_extractor_watcher_s *watcher, const char *dir)
+{
+	size_t length = strlen(dir);
+	unsigned int idx = 0;
+	int wd = 0;
+
+	for(idx = 0; idx <= watcher->bucket_mask; idx++)
+	{
+		metadata_extractor_watcher_entry_s *entry = watcher->buckets[idx];
+
+		while(entry != NULL)
+		{
+			metadata_extractor_watcher_entry_s *next = entry->next;
+
+			if((strncmp(entry->path, dir, length) == 0) && (entry->path[length] == '/'))
+			{
+				/* the path is needed after the entry is gone */
+				char *path = strdup(entry->path);
+
+				if(path != NULL)
+				{
+					__metadata_extractor_watcher_remove(watcher, path);
+					free(path);
+				}
+			}
+			entry = next;
+		}
+	}
+
+	for(wd = 0; wd < watcher->watch_capacity; wd++)
+	{
+		const char *watch = watcher->watches[wd];
+
+		if((watch != NULL) && (strncmp(watch, dir, length) == 0) && ((watch[length] == '/') || (watch[length] == '\0')))
+		{
+			/* the IN_IGNORED that follows releases the slot */
+			inotify_rm_watch(watcher->inotify_fd, wd);
+		}
+	}
+}
+
+/* dir is kept as the prefix that event names are joined to, "" for "/" */
+static void __metadata_extractor_watcher_add_watch(metadata_extractor_watcher_s *watcher, const char *dir)
+{
+	int wd = inotify_add_watch(watcher->inotify_fd, (dir[0] != '\0') ? dir : "/", WATCHER_WATCH_MASK);
+
+	if(wd < 0)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not watch [%s] (%d)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, dir, errno);
+		return;
+	}
+
+	if(wd >= watcher->watch_capacity)
+	{
+		int capacity = (watcher->watch_capacity > 0) ? watcher->watch_capacity : 256;
+		char **watches = NULL;
+
+		while(capacity <= wd)
+		{
+			capacity *= 2;
+		}
+
+		watches = (char **)realloc(watcher->watches, capacity * sizeof(char *));
+		if(watches == NULL)
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			inotify_rm_watch(watcher->inotify_fd, wd);
+			return;
+		}
+		memset(watches + watcher->watch_capacity, 0, (capacity - watcher->watch_capacity) * sizeof(char *));
+		watcher->watches = watches;
+		watcher->watch_capacity = capacity;
+	}
+
+	/* a directory watched again keeps its descriptor */
+	SAFE_FREE(watcher->watches[wd]);
+	watcher->watches[wd] = strdup(dir);
+}
+
+/* watches dir and everything below it, and schedules the files already there;
+ * path holds the directory, length its length, 0 for "/"; path is PATH_MAX long and reused for the children */
+static void __metadata_extractor_watcher_add_tree(metadata_extractor_watcher_s *watcher, char *path, size_t length, unsigned long long deadline)
+{
+	DIR *dir = NULL;
+	struct dirent *dirent = NULL;
+
+	/* watched before listing, so a file created meanwhile is either listed or reported */
+	__metadata_extractor_watcher_add_watch(watcher, path);
+
+	dir = opendir((length > 0) ? path : "/");
+	if(dir == NULL)
+	{
+		return;
+	}
+
+	while((dirent = readdir(dir)) != NULL)
+	{
+		size_t name_length = strlen(dirent->d_name);
+		unsigned char type = dirent->d_type;
+
+		if((strcmp(dirent->d_name, ".") == 0) || (strcmp(dirent->d_name, "..") == 0) || (length + 1 + name_length >= PATH_MAX))
+		{
+			continue;
+		}
+
+		if(type == DT_UNKNOWN)
+		{
+			struct stat st;
+
+			if(fstatat(dirfd(dir), dirent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+				continue;
+			type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN);
+		}
+
+		path[length] = '/';
+		memcpy(path + length + 1, dirent->d_name, name_length + 1);
+
+		if(type == DT_REG)
+		{
+			__metadata_extractor_watcher_schedule(watcher, path, deadline);
+		}
+		else if(type == DT_DIR)
+		{
+			__metadata_extractor_watcher_add_tree(watcher, path, length + 1 + name_length, deadline);
+		}
+
+		path[length] = '\0';
+	}
+
+	closedir(dir);
+}
+
+static void __metadata_extractor_watcher_rescan(metadata_extractor_watcher_s *watcher, unsigned long long deadline)
+{
+	char *path = (char *)malloc(PATH_MAX);
+	unsigned int idx = 0;
+
+	if(path == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return;
+	}
+
+	snprintf(path, PATH_MAX, "%s", watcher->root);
+	__metadata_extractor_watcher_add_tree(watcher, path, strlen(path), deadline);
+
+	/* files removed while events were lost */
+	for(idx = 0; idx <= watcher->bucket_mask; idx++)
+	{
+		metadata_extractor_watcher_entry_s *entry = watcher->buckets[idx];
+
+		while(entry != NULL)
+		{
+			metadata_extractor_watcher_entry_s *next = entry->next;
+			struct stat st;
+
+			if((lstat(entry->path, &st) != 0) || !S_ISREG(st.st_mode))
+			{
+				snprintf(path, PATH_MAX, "%s", entry->path);
+				__metadata_extractor_watcher_remove(watcher, path);
+			}
+			entry = next;
+		}
+	}
+
+	free(path);
+}
+
+static void __metadata_extractor_watcher_handle_event(metadata_extractor_watcher_s *watcher, const struct inotify_event *event, char *path, unsigned long long now)
+{
+	const char *dir = NULL;
+
+	if(event->mask & IN_Q_OVERFLOW)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) event queue overflow, rescanning [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED,
+			(watcher->root[0] != '\0') ? watcher->root : "/");
+		__metadata_extractor_watcher_rescan(watcher, now + watcher->debounce);
+		return;
+	}
+
+	if((event->wd < 0) || (event->wd >= watcher->watch_capacity) || (watcher->watches[event->wd] == NULL))
+	{
+		return;
+	}
+
+	if(event->mask & IN_IGNORED)
+	{
+		SAFE_FREE(watcher->watches[event->wd]);
+		return;
+	}
+
+	dir = watcher->watches[event->wd];
+	if((event->len == 0) || (snprintf(path, PATH_MAX, "%s/%s", dir, event->name) >= PATH_MAX))
+	{
+		return;
+	}
+
+	if(event->mask & IN_ISDIR)
+	{
+		if(event->mask & (IN_CREATE | IN_MOVED_TO))
+		{
+			__metadata_extractor_watcher_add_tree(watcher, path, strlen(path), now + watcher->debounce);
+		}
+		else if(event->mask & IN_MOVED_FROM)
+		{
+			__metadata_extractor_watcher_remove_tree(watcher, path);
+		}
+	}
+	else if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+	{
+		__metadata_extractor_watcher_schedule(watcher, path, now + watcher->debounce);
+	}
+	else if(event->mask & IN_MODIFY)
+	{
+		/* still being written: push back a pending extraction, the close schedules a new one */
+		metadata_extractor_watcher_entry_s *entry = NULL;
+
+		pthread_mutex_lock(&watcher->lock);
+		entry = __metadata_extractor_watcher_find(watcher, path, __metadata_extractor_hash(path, strlen(path)));
+		if((entry != NULL) && (entry->deadline != 0))
+		{
+			__metadata_extractor_watcher_pending_append(watcher, entry, now + watcher->debounce);
+		}
+		pthread_mutex_unlock(&watcher->lock);
+	}
+	else if(event->mask & (IN_DELETE | IN_MOVED_FROM))
+	{
+		__metadata_extractor_watcher_remove(watcher, path);
+	}
+}
+
+static void __metadata_extractor_watcher_extract(metadata_extractor_watcher_s *watcher, metadata_extractor_watcher_entry_s *entry)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	void *record = NULL;
+	size_t record_size = 0;
+	void *old_record = NULL;
+	metadata_extractor_journal_change_e change = METADATA_EXTRACTOR_JOURNAL_NEW;
+	unsigned long long trace_begin = 0;
+
+	trace_begin = __metadata_extractor_trace_begin();
+	ret = metadata_extractor_set_path(watcher->metadata, entry->path);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		ret = metadata_extractor_serialize(watcher->metadata, &record, &record_size);
+	}
+	__metadata_extractor_trace_end("watcher_extract", trace_begin, entry->path);
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		/* not media, or no longer readable */
+		metadata_extractor_debug("[%s] can not extract [%s] (0x%08x)", __FUNCTION__, entry->path, ret);
+		if(entry->record == NULL)
+		{
+			pthread_mutex_lock(&watcher->lock);
+			__metadata_extractor_watcher_remove_locked(watcher, entry);
+			pthread_mutex_unlock(&watcher->lock);
+		}
+		else
+		{
+			char *path = strdup(entry->path);
+
+			if(path != NULL)
+			{
+				__metadata_extractor_watcher_remove(watcher, path);
+				free(path);
+			}
+		}
+		return;
+	}
+
+	if(entry->record != NULL)
+	{
+		if((entry->record_size == record_size) && (memcmp(entry->record, record, record_size) == 0))
+		{
+			SAFE_FREE(record);
+			return;
+		}
+		change = METADATA_EXTRACTOR_JOURNAL_CHANGED;
+	}
+
+	pthread_mutex_lock(&watcher->lock);
+	old_record = entry->record;
+	entry->record = record;
+	entry->record_size = record_size;
+	if(old_record == NULL)
+	{
+		watcher->record_count++;
+	}
+	pthread_mutex_unlock(&watcher->lock);
+
+	SAFE_FREE(old_record);
+
+	watcher->callback(entry->path, change, watcher->user_data);
+}
+
+static void *__metadata_extractor_watcher_thread(void *data)
+{
+	metadata_extractor_watcher_s *watcher = (metadata_extractor_watcher_s *)data;
+	char *buffer = NULL;
+	char *path = NULL;
+	bool stop = false;
+
+	buffer = (char *)malloc(WATCHER_EVENT_BUFFER);
+	path = (char *)malloc(PATH_MAX);
+	if((buffer == NULL) || (path == NULL))
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		SAFE_FREE(buffer);
+		SAFE_FREE(path);
+		return NULL;
+	}
+
+	/* the files already in the tree are extracted right away */
+	__metadata_extractor_watcher_rescan(watcher, __metadata_extractor_watcher_now());
+
+	while(!stop)
+	{
+		struct pollfd fds[2];
+		int timeout = -1;
+		unsigned long long now = __metadata_extractor_watcher_now();
+		int extracted = 0;
+
+		if(watcher->pending_head != NULL)
+		{
+			timeout = (watcher->pending_head->deadline > now) ? (int)(watcher->pending_head->deadline - now) : 0;
+		}
+
+		fds[0].fd = watcher->inotify_fd;
+		fds[0].events = POLLIN;
+		fds[1].fd = watcher->stop_fd;
+		fds[1].events = POLLIN;
+
+		if((poll(fds, 2, timeout) < 0) && (errno != EINTR))
+		{
+			LOGE("[%s]ERROR_UNKNOWN(0x%08x) poll failed (%d)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, errno);
+			break;
+		}
+
+		if(fds[1].revents & POLLIN)
+		{
+			break;
+		}
+
+		if(fds[0].revents & POLLIN)
+		{
+			ssize_t read_size = 0;
+
+			now = __metadata_extractor_watcher_now();
+			while((read_size = read(watcher->inotify_fd, buffer, WATCHER_EVENT_BUFFER)) > 0)
+			{
+				ssize_t pos = 0;
+
+				while(pos < read_size)
+				{
+					const struct inotify_event *event = (const struct inotify_event *)(buffer + pos);
+
+					__metadata_extractor_watcher_handle_event(watcher, event, path, now);
+					pos += sizeof(struct inotify_event) + event->len;
+				}
+			}
+		}
+
+		/* a few at a time, so that events and destroy are not held up by a large backlog */
+		now = __metadata_extractor_watcher_now();
+		while((watcher->pending_head != NULL) && (watcher->pending_head->deadline <= now) && (extracted < WATCHER_EXTRACT_BATCH))
+		{
+			metadata_extractor_watcher_entry_s *entry = watcher->pending_head;
+
+			pthread_mutex_lock(&watcher->lock);
+			__metadata_extractor_watcher_pending_unlink(watcher, entry);
+			pthread_mutex_unlock(&watcher->lock);
+
+			__metadata_extractor_watcher_extract(watcher, entry);
+			extracted++;
+		}
+	}
+
+	SAFE_FREE(buffer);
+	SAFE_FREE(path);
+
+	return NULL;
+}
+
+int metadata_extractor_watcher_create(const char *root, int debounce_ms, metadata_extractor_watcher_cb callback, void *user_data, metadata_extractor_watcher_h *watcher)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_watcher_s *_watcher = NULL;
+	size_t root_length = 0;
+	struct stat st;
+
+	if((!root) || (root[0] != '/') || (debounce_ms < 0) || (!callback) || (!watcher))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if((stat(root, &st) != 0) || !S_ISDIR(st.st_mode))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) not a directory [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER, root);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_watcher = (metadata_extractor_watcher_s *)calloc(1, sizeof(metadata_extractor_watcher_s));
+	if(_watcher == NULL)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	_watcher->inotify_fd = -1;
+	_watcher->stop_fd = -1;
+	_watcher->debounce = debounce_ms;
+	_watcher->callback = callback;
+	_watcher->user_data = user_data;
+	pthread_mutex_init(&_watcher->lock, NULL);
+
+	_watcher->root = strdup(root);
+	_watcher->buckets = (metadata_extractor_watcher_entry_s **)calloc(WATCHER_INITIAL_BUCKETS, sizeof(metadata_extractor_watcher_entry_s *));
+	_watcher->bucket_mask = WATCHER_INITIAL_BUCKETS - 1;
+	if((_watcher->root == NULL) || (_watcher->buckets == NULL))
+	{
+		ret = METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		goto error;
+	}
+
+	/* kept without the trailing slash, so "/" becomes the empty prefix of every path below it */
+	root_length = strlen(_watcher->root);
+	while((root_length > 0) && (_watcher->root[root_length - 1] == '/'))
+	{
+		_watcher->root[--root_length] = '\0';
+	}
+
+	ret = metadata_extractor_create(&_watcher->metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		goto error;
+	}
+
+	_watcher->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	_watcher->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((_watcher->inotify_fd < 0) || (_watcher->stop_fd < 0))
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) inotify setup failed (%d)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, errno);
+		ret = METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+		goto error;
+	}
+
+	if(pthread_create(&_watcher->thread, NULL, __metadata_extractor_watcher_thread, _watcher) != 0)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not start thread", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED);
+		ret = METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+		goto error;
+	}
+
+	*watcher = (metadata_extractor_watcher_h)_watcher;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+
+error:
+	if(ret == METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY)
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+	}
+	if(_watcher->metadata != NULL)
+		metadata_extractor_destroy(_watcher->metadata);
+	if(_watcher->inotify_fd >= 0)
+		close(_watcher->inotify_fd);
+	if(_watcher->stop_fd >= 0)
+		close(_watcher->stop_fd);
+	pthread_mutex_destroy(&_watcher->lock);
+	SAFE_FREE(_watcher->root);
+	SAFE_FREE(_watcher->buckets);
+	SAFE_FREE(_watcher);
+
+	return ret;
+}
+
+int metadata_extractor_watcher_destroy(metadata_extractor_watcher_h watcher)
+{
+	metadata_extractor_watcher_s *_watcher = (metadata_extractor_watcher_s *)watcher;
+	uint64_t value = 1;
+	unsigned int idx = 0;
+	int wd = 0;
+
+	if(!_watcher)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(write(_watcher->stop_fd, &value, sizeof(value)) != sizeof(value))
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not stop thread (%d)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, errno);
+	}
+	pthread_join(_watcher->thread, NULL);
+
+	for(idx = 0; idx <= _watcher->bucket_mask; idx++)
+	{
+		metadata_extractor_watcher_entry_s *entry = _watcher->buckets[idx];
+
+		while(entry != NULL)
+		{
+			metadata_extractor_watcher_entry_s *next = entry->next;
+
+			SAFE_FREE(entry->record);
+			free(entry);
+			entry = next;
+		}
+	}
+
+	for(wd = 0; wd < _watcher->watch_capacity; wd++)
+	{
+		SAFE_FREE(_watcher->watches[wd]);
+	}
+
+	metadata_extractor_destroy(_watcher->metadata);
+	close(_watcher->inotify_fd);
+	close(_watcher->stop_fd);
+	pthread_mutex_destroy(&_watcher->lock);
+	SAFE_FREE(_watcher->watches);
+	SAFE_FREE(_watcher->buckets);
+	SAFE_FREE(_watcher->root);
+	SAFE_FREE(_watcher);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_watcher_get_record(metadata_extractor_watcher_h watcher, const char *path, void **record, size_t *size)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_watcher_s *_watcher = (metadata_extractor_watcher_s *)watcher;
+	metadata_extractor_watcher_entry_s *entry = NULL;
+
+	if((!_watcher) || (!path) || (!record) || (!size))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	*record = NULL;
+	*size = 0;
+
+	pthread_mutex_lock(&_watcher->lock);
+	entry = __metadata_extractor_watcher_find(_watcher, path, __metadata_extractor_hash(path, strlen(path)));
+	if((entry != NULL) && (entry->record != NULL))
+	{
+		*record = malloc(entry->record_size);
+		if(*record != NULL)
+		{
+			memcpy(*record, entry->record, entry->record_size);
+			*size = entry->record_size;
+		}
+		else
+		{
+			LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+			ret = METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		}
+	}
+	pthread_mutex_unlock(&_watcher->lock);
+
+	return ret;
+}
+
+int metadata_extractor_watcher_get_count(metadata_extractor_watcher_h watcher, int *count)
+{
+	metadata_extractor_watcher_s *_watcher = (metadata_extractor_watcher_s *)watcher;
+
+	if((!_watcher) || (!count))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&_watcher->lock);
+	*count = _watcher->record_count;
+	pthread_mutex_unlock(&_watcher->lock);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
@@ -0,0 +1,438 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define WAVEFORM_READ_SIZE		(32 * 1024)
+
+#define WAVEFORM_FORMAT_PCM			0x0001
+#define WAVEFORM_FORMAT_FLOAT		0x0003
+#define WAVEFORM_FORMAT_EXTENSIBLE	0xfffe
+
+#define WAVEFORM_CACHE_MAGIC	0x4657584d	/* "MXWF" */
+#define WAVEFORM_CACHE_VERSION	1
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+typedef struct
+{
+	int format;				/* WAVEFORM_FORMAT_PCM or WAVEFORM_FORMAT_FLOAT */
+	int channels;
+	int bits;
+	int block_align;
+	unsigned long long data_offset;
+	unsigned long long data_size;
+}metadata_extractor_wave_s;
+
+typedef struct
+{
+	float min;
+	float max;
+	double square_sum;
+	unsigned long long samples;
+}metadata_extractor_waveform_bucket_s;
+
+/*
+ * Cache file, a machine-local cache in host byte order like the journal, named after the
+ * xxh64 of the media path:
+ *
+ *   0  uint32 magic "MXWF", uint32 version, uint32 bucket count, uint32 padding
+ *  16  inode, size and mtime in ns of the media file (64 bit each)
+ *  40  one metadata_extractor_peak_s per bucket
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t buckets;
+	uint32_t padding;
+	uint64_t ino;
+	uint64_t size;
+	int64_t mtime;
+}metadata_extractor_waveform_cache_header_s;
+
+static unsigned int __metadata_extractor_waveform_le16(const unsigned char *p)
+{
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+static unsigned int __metadata_extractor_waveform_le32(const unsigned char *p)
+{
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+/* the fmt and data chunks of a RIFF WAVE file; anything compressed is not ours to decode */
+static int __metadata_extractor_waveform_parse(int fd, unsigned long long file_size, metadata_extractor_wave_s *wave)
+{
+	unsigned char header[40];
+	unsigned long long position = 12;
+	bool has_format = false;
+
+	if((file_size < 12) || (pread(fd, header, 12, 0) != 12) || (memcmp(header, "RIFF", 4) != 0) || (memcmp(header + 8, "WAVE", 4) != 0))
+	{
+		LOGE("[%s]not a RIFF WAVE file", __FUNCTION__);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	while((position + 8 <= file_size) && (pread(fd, header, 8, (off_t)position) == 8))
+	{
+		unsigned long long chunk_size = __metadata_extractor_waveform_le32(header + 4);
+
+		if((memcmp(header, "fmt ", 4) == 0) && (chunk_size >= 16))
+		{
+			size_t length = (chunk_size < sizeof(header)) ? (size_t)chunk_size : sizeof(header);
+
+			if(pread(fd, header, length, (off_t)(position + 8)) != (ssize_t)length)
+				break;
+
+			wave->format = __metadata_extractor_waveform_le16(header);
+			wave->channels = __metadata_extractor_waveform_le16(header + 2);
+			wave->block_align = __metadata_extractor_waveform_le16(header + 12);
+			wave->bits = __metadata_extractor_waveform_le16(header + 14);
+			/* the sub format GUID starts with the format tag */
+			if((wave->format == WAVEFORM_FORMAT_EXTENSIBLE) && (length >= 26))
+				wave->format = __metadata_extractor_waveform_le16(header + 24);
+			has_format = true;
+		}
+		else if((memcmp(header, "data", 4) == 0) && has_format)
+		{
+			wave->data_offset = position + 8;
+			/* streaming writers leave the size at 0 or 0xffffffff, and files get truncated */
+			if((chunk_size == 0) || (chunk_size == 0xffffffffULL) || (chunk_size > file_size - wave->data_offset))
+				chunk_size = file_size - wave->data_offset;
+			wave->data_size = chunk_size;
+			break;
+		}
+
+		/* chunks are padded to even sizes */
+		position += 8 + chunk_size + (chunk_size & 1);
+	}
+
+	if((!has_format) || (wave->data_offset == 0) || (wave->channels <= 0) ||
+		!(((wave->format == WAVEFORM_FORMAT_PCM) && ((wave->bits == 8) || (wave->bits == 16) || (wave->bits == 24) || (wave->bits == 32))) ||
+		((wave->format == WAVEFORM_FORMAT_FLOAT) && ((wave->bits == 32) || (wave->bits == 64)))) ||
+		(wave->block_align != wave->channels * (wave->bits / 8)))
+	{
+		LOGE("[%s]unsupported WAVE format 0x%04x, %d bits", __FUNCTION__, wave->format, wave->bits);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* interleaved samples to floats in [-1, 1]; one flat loop per format, for the compiler to vectorize */
+static void __metadata_extractor_waveform_convert(const metadata_extractor_wave_s *wave, const unsigned char *data, size_t count, float *samples)
+{
+	size_t idx = 0;
+
+	if(wave->format == WAVEFORM_FORMAT_FLOAT)
+	{
+		if(wave->bits == 32)
+		{
+			for(idx = 0; idx < count; idx++)
+			{
+				uint32_t bits = __metadata_extractor_waveform_le32(data + idx * 4);
+				float value;
+
+				memcpy(&value, &bits, sizeof(value));
+				samples[idx] = value;
+			}
+		}
+		else
+		{
+			for(idx = 0; idx < count; idx++)
+			{
+				uint64_t bits = (uint64_t)__metadata_extractor_waveform_le32(data + idx * 8) | ((uint64_t)__metadata_extractor_waveform_le32(data + idx * 8 + 4) << 32);
+				double value;
+
+				memcpy(&value, &bits, sizeof(value));
+				samples[idx] = (float)value;
+			}
+		}
+		return;
+	}
+
+	switch(wave->bits)
+	{
+		case 8:		/* unsigned */
+			for(idx = 0; idx < count; idx++)
+				samples[idx] = ((int)data[idx] - 128) * (1.0f / 128);
+			break;
+		case 16:
+			for(idx = 0; idx < count; idx++)
+				samples[idx] = (int16_t)(data[idx * 2] | (data[idx * 2 + 1] << 8)) * (1.0f / 32768);
+			break;
+		case 24:
+			for(idx = 0; idx < count; idx++)
+				samples[idx] = ((int32_t)(((uint32_t)data[idx * 3] << 8) | ((uint32_t)data[idx * 3 + 1] << 16) | ((uint32_t)data[idx * 3 + 2] << 24)) >> 8) * (1.0f / 8388608);
+			break;
+		default:
+			for(idx = 0; idx < count; idx++)
+				samples[idx] = (int32_t)__metadata_extractor_waveform_le32(data + idx * 4) * (1.0f / 2147483648.0f);
+			break;
+	}
+}
+
+/* folds a run of samples of one bucket into it; all channels go into the same bucket */
+static void __metadata_extractor_waveform_reduce(metadata_extractor_waveform_bucket_s *bucket, const float *samples, size_t count)
+{
+	float min = bucket->min;
+	float max = bucket->max;
+	float square_sum = 0;
+	size_t idx = 0;
+
+	for(idx = 0; idx < count; idx++)
+	{
+		min = (samples[idx] < min) ? samples[idx] : min;
+		max = (samples[idx] > max) ? samples[idx] : max;
+		square_sum += samples[idx] * samples[idx];
+	}
+
+	bucket->min = min;
+	bucket->max = max;
+	/* runs are at most one read long, so float is precise enough within one */
+	bucket->square_sum += square_sum;
+	bucket->samples += count;
+}
+
+static void __metadata_extractor_waveform_finish(const metadata_extractor_waveform_bucket_s *bucket, metadata_extractor_peak_s *peak)
+{
+	if(bucket->samples == 0)
+	{
+		memset(peak, 0, sizeof(metadata_extractor_peak_s));
+		return;
+	}
+
+	peak->min = bucket->min;
+	peak->max = bucket->max;
+	peak->rms = (float)sqrt(bucket->square_sum / bucket->samples);
+}
+
+int __metadata_extractor_waveform(const char *path, int buckets, metadata_extractor_peak_s *peaks)
+{
+	metadata_extractor_wave_s wave;
+	metadata_extractor_waveform_bucket_s bucket;
+	unsigned char *buffer = NULL;
+	float *samples = NULL;
+	unsigned long long frames = 0;
+	unsigned long long frame = 0;
+	unsigned long long bucket_end = 0;
+	size_t read_size = 0;
+	int index = 0;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int fd = -1;
+	struct stat st;
+
+	memset(&wave, 0, sizeof(wave));
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+	{
+		LOGE("[%s]FILE_NOT_EXISTS(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_FILE_EXISTS);
+		return METADATA_EXTRACTOR_ERROR_FILE_EXISTS;
+	}
+
+	if((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode))
+	{
+		close(fd);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	ret = __metadata_extractor_waveform_parse(fd, st.st_size, &wave);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		close(fd);
+		return ret;
+	}
+
+	/* whole frames per read, so a bucket boundary never splits one */
+	read_size = (WAVEFORM_READ_SIZE / wave.block_align) * wave.block_align;
+	if(read_size == 0)
+		read_size = wave.block_align;
+	frames = wave.data_size / wave.block_align;
+
+	buffer = (unsigned char *)malloc(read_size);
+	samples = (float *)malloc(read_size / (wave.bits / 8) * sizeof(float));
+	if((buffer == NULL) || (samples == NULL))
+	{
+		free(buffer);
+		free(samples);
+		close(fd);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	posix_fadvise(fd, (off_t)wave.data_offset, (off_t)wave.data_size, POSIX_FADV_SEQUENTIAL);
+
+	/* frame f goes to bucket f * buckets / frames, so bucket b ends at ceil((b + 1) * frames / buckets) */
+	memset(&bucket, 0, sizeof(bucket));
+	bucket.min = 1;
+	bucket.max = -1;
+	bucket_end = (frames + buckets - 1) / buckets;
+
+	while(frame < frames)
+	{
+		size_t length = (frames - frame < read_size / wave.block_align) ? (size_t)(frames - frame) * wave.block_align : read_size;
+		ssize_t done = pread(fd, buffer, length, (off_t)(wave.data_offset + frame * wave.block_align));
+		size_t chunk_frames = 0;
+		size_t offset = 0;
+
+		if(done < wave.block_align)
+		{
+			/* the data ended early, the rest of the buckets stay empty */
+			LOGE("[%s]read failed at frame %llu", __FUNCTION__, frame);
+			break;
+		}
+		chunk_frames = done / wave.block_align;
+
+		__metadata_extractor_waveform_convert(&wave, buffer, chunk_frames * wave.channels, samples);
+
+		while(offset < chunk_frames)
+		{
+			unsigned long long run = (bucket_end - frame < chunk_frames - offset) ? bucket_end - frame : chunk_frames - offset;
+
+			__metadata_extractor_waveform_reduce(&bucket, samples + offset * wave.channels, run * wave.channels);
+			offset += run;
+			frame += run;
+
+			while((frame == bucket_end) && (index < buckets))
+			{
+				__metadata_extractor_waveform_finish(&bucket, &peaks[index]);
+				index++;
+				memset(&bucket, 0, sizeof(bucket));
+				bucket.min = 1;
+				bucket.max = -1;
+				bucket_end = ((unsigned long long)(index + 1) * frames + buckets - 1) / buckets;
+			}
+		}
+	}
+
+	for(; index < buckets; index++)
+	{
+		__metadata_extractor_waveform_finish(&bucket, &peaks[index]);
+		memset(&bucket, 0, sizeof(bucket));
+	}
+
+	free(buffer);
+	free(samples);
+	close(fd);
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* one file per path and bucket count, so an overview and a zoom of the same file are both kept */
+static bool __metadata_extractor_waveform_cache_path(const char *cache_dir, const char *path, int buckets, char *cache_path, size_t size)
+{
+	int length = snprintf(cache_path, size, "%s/%016llx-%d.wfm", cache_dir, __metadata_extractor_xxh64(path, strlen(path), 0), buckets);
+
+	return (length > 0) && ((size_t)length < size);
+}
+
+static void __metadata_extractor_waveform_cache_header(const struct stat *st, int buckets, metadata_extractor_waveform_cache_header_s *header)
+{
+	memset(header, 0, sizeof(metadata_extractor_waveform_cache_header_s));
+	header->magic = WAVEFORM_CACHE_MAGIC;
+	header->version = WAVEFORM_CACHE_VERSION;
+	header->buckets = buckets;
+	header->ino = st->st_ino;
+	header->size = st->st_size;
+	header->mtime = (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+/* true when the cache holds peaks of the file as it is now, with as many buckets */
+bool __metadata_extractor_waveform_cache_load(const char *cache_dir, const char *path, int buckets, metadata_extractor_peak_s *peaks)
+{
+	metadata_extractor_waveform_cache_header_s expected;
+	metadata_extractor_waveform_cache_header_s header;
+	char cache_path[PATH_MAX];
+	size_t peaks_size = (size_t)buckets * sizeof(metadata_extractor_peak_s);
+	bool loaded = false;
+	struct stat st;
+	int fd = -1;
+
+	if((stat(path, &st) != 0) || !__metadata_extractor_waveform_cache_path(cache_dir, path, buckets, cache_path, sizeof(cache_path)))
+		return false;
+
+	fd = open(cache_path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		return false;
+
+	__metadata_extractor_waveform_cache_header(&st, buckets, &expected);
+	if((pread(fd, &header, sizeof(header), 0) == sizeof(header)) && (memcmp(&header, &expected, sizeof(header)) == 0) &&
+		(pread(fd, peaks, peaks_size, sizeof(header)) == (ssize_t)peaks_size))
+	{
+		loaded = true;
+	}
+
+	close(fd);
+
+	return loaded;
+}
+
+/* written to a temporary file of its own and renamed, so readers never see a partial or mixed one */
+void __metadata_extractor_waveform_cache_save(const char *cache_dir, const char *path, int buckets, const metadata_extractor_peak_s *peaks)
+{
+	metadata_extractor_waveform_cache_header_s header;
+	char cache_path[PATH_MAX];
+	char temp_path[PATH_MAX];
+	size_t peaks_size = (size_t)buckets * sizeof(metadata_extractor_peak_s);
+	bool written = false;
+	struct stat st;
+	int fd = -1;
+
+	if((stat(path, &st) != 0) || !__metadata_extractor_waveform_cache_path(cache_dir, path, buckets, cache_path, sizeof(cache_path)) ||
+		(snprintf(temp_path, sizeof(temp_path), "%s.XXXXXX", cache_path) >= (int)sizeof(temp_path)))
+		return;
+
+	fd = mkostemp(temp_path, O_CLOEXEC);
+	if(fd < 0)
+	{
+		LOGE("[%s]cannot create %s", __FUNCTION__, temp_path);
+		return;
+	}
+	if(fchmod(fd, 0644) != 0)
+	{
+		LOGE("[%s]cannot set the mode of %s", __FUNCTION__, temp_path);
+		close(fd);
+		unlink(temp_path);
+		return;
+	}
+
+	__metadata_extractor_waveform_cache_header(&st, buckets, &header);
+	written = (write(fd, &header, sizeof(header)) == sizeof(header)) && (write(fd, peaks, peaks_size) == (ssize_t)peaks_size);
+
+	if((close(fd) != 0) || !written || (rename(temp_path, cache_path) != 0))
+	{
+		LOGE("[%s]cannot write %s", __FUNCTION__, cache_path);
+		unlink(temp_path);
+	}
+}
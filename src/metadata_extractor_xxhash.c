@@ -0,0 +1,198 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <metadata_extractor_private.h>
+
+/*
+ * XXH64 as specified by the xxHash project, so digests can be checked with xxhsum.
+ * Four independent lanes per 32 byte stripe keep the multipliers of a core busy,
+ * which makes it run at memory speed without any SIMD code.
+ */
+#define XXH_PRIME64_1	0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2	0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3	0x165667B19E3779F9ULL
+#define XXH_PRIME64_4	0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5	0x27D4EB2F165667C5ULL
+
+#define XXH_ROTL64(x, r)	(((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline uint64_t __metadata_extractor_xxh64_read64(const unsigned char *p)
+{
+	uint64_t value;
+
+	memcpy(&value, p, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap64(value);
+#endif
+	return value;
+}
+
+static inline uint32_t __metadata_extractor_xxh64_read32(const unsigned char *p)
+{
+	uint32_t value;
+
+	memcpy(&value, p, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap32(value);
+#endif
+	return value;
+}
+
+static inline uint64_t __metadata_extractor_xxh64_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = XXH_ROTL64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t __metadata_extractor_xxh64_merge(uint64_t acc, uint64_t value)
+{
+	acc ^= __metadata_extractor_xxh64_round(0, value);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+/* whole stripes of data, returns the bytes consumed */
+static size_t __metadata_extractor_xxh64_stripes(unsigned long long *v, const unsigned char *data, size_t length)
+{
+	const unsigned char *p = data;
+	const unsigned char *limit = data + (length & ~(size_t)31);
+	uint64_t v1 = v[0];
+	uint64_t v2 = v[1];
+	uint64_t v3 = v[2];
+	uint64_t v4 = v[3];
+
+	while(p < limit)
+	{
+		v1 = __metadata_extractor_xxh64_round(v1, __metadata_extractor_xxh64_read64(p));
+		v2 = __metadata_extractor_xxh64_round(v2, __metadata_extractor_xxh64_read64(p + 8));
+		v3 = __metadata_extractor_xxh64_round(v3, __metadata_extractor_xxh64_read64(p + 16));
+		v4 = __metadata_extractor_xxh64_round(v4, __metadata_extractor_xxh64_read64(p + 24));
+		p += 32;
+	}
+
+	v[0] = v1;
+	v[1] = v2;
+	v[2] = v3;
+	v[3] = v4;
+
+	return (size_t)(p - data);
+}
+
+void __metadata_extractor_xxh64_init(metadata_extractor_xxh64_s *state, unsigned long long seed)
+{
+	memset(state, 0, sizeof(metadata_extractor_xxh64_s));
+	state->seed = seed;
+	state->v[0] = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+	state->v[1] = seed + XXH_PRIME64_2;
+	state->v[2] = seed;
+	state->v[3] = seed - XXH_PRIME64_1;
+}
+
+void __metadata_extractor_xxh64_update(metadata_extractor_xxh64_s *state, const void *data, size_t length)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	size_t used = 0;
+
+	state->total += length;
+
+	if(state->buffered > 0)
+	{
+		size_t fill = 32 - state->buffered;
+
+		if(length < fill)
+		{
+			memcpy(state->buffer + state->buffered, p, length);
+			state->buffered += length;
+			return;
+		}
+
+		memcpy(state->buffer + state->buffered, p, fill);
+		__metadata_extractor_xxh64_stripes(state->v, state->buffer, 32);
+		state->buffered = 0;
+		p += fill;
+		length -= fill;
+	}
+
+	used = __metadata_extractor_xxh64_stripes(state->v, p, length);
+	if(used < length)
+	{
+		memcpy(state->buffer, p + used, length - used);
+		state->buffered = length - used;
+	}
+}
+
+unsigned long long __metadata_extractor_xxh64_digest(const metadata_extractor_xxh64_s *state)
+{
+	const unsigned char *p = state->buffer;
+	const unsigned char *end = state->buffer + state->buffered;
+	uint64_t hash = 0;
+
+	if(state->total >= 32)
+	{
+		hash = XXH_ROTL64(state->v[0], 1) + XXH_ROTL64(state->v[1], 7) + XXH_ROTL64(state->v[2], 12) + XXH_ROTL64(state->v[3], 18);
+		hash = __metadata_extractor_xxh64_merge(hash, state->v[0]);
+		hash = __metadata_extractor_xxh64_merge(hash, state->v[1]);
+		hash = __metadata_extractor_xxh64_merge(hash, state->v[2]);
+		hash = __metadata_extractor_xxh64_merge(hash, state->v[3]);
+	}
+	else
+	{
+		hash = state->seed + XXH_PRIME64_5;
+	}
+
+	hash += state->total;
+
+	while(p + 8 <= end)
+	{
+		hash ^= __metadata_extractor_xxh64_round(0, __metadata_extractor_xxh64_read64(p));
+		hash = XXH_ROTL64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		p += 8;
+	}
+
+	if(p + 4 <= end)
+	{
+		hash ^= (uint64_t)__metadata_extractor_xxh64_read32(p) * XXH_PRIME64_1;
+		hash = XXH_ROTL64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+
+	while(p < end)
+	{
+		hash ^= (*p) * XXH_PRIME64_5;
+		hash = XXH_ROTL64(hash, 11) * XXH_PRIME64_1;
+		p++;
+	}
+
+	hash ^= hash >> 33;
+	hash *= XXH_PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= XXH_PRIME64_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+unsigned long long __metadata_extractor_xxh64(const void *data, size_t length, unsigned long long seed)
+{
+	metadata_extractor_xxh64_s state;
+
+	__metadata_extractor_xxh64_init(&state, seed);
+	__metadata_extractor_xxh64_update(&state, data, length);
+
+	return __metadata_extractor_xxh64_digest(&state);
+}
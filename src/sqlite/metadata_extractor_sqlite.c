@@ -0,0 +1,533 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sqlite3.h>
+#include <dlog.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_sqlite.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define SQLITE_BATCH_SIZE_DEFAULT	1000
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_METADATAEXTRACTOR"
+
+typedef struct metadata_extractor_sqlite_s
+{
+	sqlite3 *db;
+	sqlite3_stmt *upsert;
+	sqlite3_stmt *lookup;
+	sqlite3_stmt *begin;
+	sqlite3_stmt *commit;
+	metadata_extractor_sqlite_column_s *columns;
+	int column_count;
+	int batch_size;
+	int pending;			/* rows written in the open transaction */
+}metadata_extractor_sqlite_s;
+
+/* default column names, same spelling as the attributes */
+static const char *g_sqlite_attr_name[METADATA_EXTRACTOR_RECORD_ATTR_COUNT] = {
+	"duration", "video_bitrate", "video_fps", "video_width", "video_height", "has_video",
+	"audio_bitrate", "audio_channels", "audio_samplerate", "has_audio",
+	"artist", "title", "album", "genre", "author", "copyright", "date", "description",
+	"track_num", "classification", "rating", "longitude", "latitude", "altitude",
+	"conductor", "unsynclyrics", "synclyrics_num", "recdate",
+};
+
+static bool __metadata_extractor_sqlite_is_identifier(const char *name)
+{
+	const char *ch = name;
+
+	if((name == NULL) || (!isalpha((unsigned char)name[0]) && (name[0] != '_')))
+	{
+		return false;
+	}
+
+	for(; *ch != '\0'; ch++)
+	{
+		if(!isalnum((unsigned char)*ch) && (*ch != '_'))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static const char *__metadata_extractor_sqlite_column_type(metadata_extractor_attr_e attribute)
+{
+	switch(__metadata_extractor_record_attr_type(attribute))
+	{
+		case METADATA_EXTRACTOR_RECORD_INT: return "INTEGER";
+		case METADATA_EXTRACTOR_RECORD_DOUBLE: return "REAL";
+		default: return "TEXT";
+	}
+}
+
+static int __metadata_extractor_sqlite_exec(metadata_extractor_sqlite_s *sink, const char *sql)
+{
+	char *err_msg = NULL;
+
+	if(sqlite3_exec(sink->db, sql, NULL, NULL, &err_msg) != SQLITE_OK)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, err_msg ? err_msg : "");
+		sqlite3_free(err_msg);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_sqlite_prepare(metadata_extractor_sqlite_s *sink, const char *sql, sqlite3_stmt **stmt)
+{
+	if(sqlite3_prepare_v2(sink->db, sql, -1, stmt, NULL) != SQLITE_OK)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, sqlite3_errmsg(sink->db));
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static int __metadata_extractor_sqlite_step(metadata_extractor_sqlite_s *sink, sqlite3_stmt *stmt)
+{
+	int ret = sqlite3_step(stmt);
+
+	sqlite3_reset(stmt);
+
+	if((ret != SQLITE_DONE) && (ret != SQLITE_ROW))
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, sqlite3_errmsg(sink->db));
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+/* CREATE TABLE, then INSERT .. ON CONFLICT(path) DO UPDATE .. WHERE mtime changed */
+static int __metadata_extractor_sqlite_prepare_table(metadata_extractor_sqlite_s *sink, const char *table)
+{
+	sqlite3_str *create = sqlite3_str_new(sink->db);
+	sqlite3_str *upsert = sqlite3_str_new(sink->db);
+	char *create_sql = NULL;
+	char *upsert_sql = NULL;
+	char *lookup_sql = NULL;
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	int idx = 0;
+
+	sqlite3_str_appendf(create, "CREATE TABLE IF NOT EXISTS \"%w\" (path TEXT PRIMARY KEY NOT NULL, mtime INTEGER", table);
+	sqlite3_str_appendf(upsert, "INSERT INTO \"%w\" (path, mtime", table);
+	for(idx = 0; idx < sink->column_count; idx++)
+	{
+		sqlite3_str_appendf(create, ", \"%w\" %s", sink->columns[idx].column, __metadata_extractor_sqlite_column_type(sink->columns[idx].attribute));
+		sqlite3_str_appendf(upsert, ", \"%w\"", sink->columns[idx].column);
+	}
+	sqlite3_str_appendall(create, ")");
+
+	sqlite3_str_appendall(upsert, ") VALUES (?, ?");
+	for(idx = 0; idx < sink->column_count; idx++)
+	{
+		sqlite3_str_appendall(upsert, ", ?");
+	}
+	sqlite3_str_appendall(upsert, ") ON CONFLICT(path) DO UPDATE SET mtime = excluded.mtime");
+	for(idx = 0; idx < sink->column_count; idx++)
+	{
+		sqlite3_str_appendf(upsert, ", \"%w\" = excluded.\"%w\"", sink->columns[idx].column, sink->columns[idx].column);
+	}
+	sqlite3_str_appendall(upsert, " WHERE mtime IS NOT excluded.mtime");
+
+	create_sql = sqlite3_str_finish(create);
+	upsert_sql = sqlite3_str_finish(upsert);
+	lookup_sql = sqlite3_mprintf("SELECT mtime FROM \"%w\" WHERE path = ?", table);
+
+	if((create_sql == NULL) || (upsert_sql == NULL) || (lookup_sql == NULL))
+	{
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		ret = METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+		goto out;
+	}
+
+	ret = __metadata_extractor_sqlite_exec(sink, create_sql);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_sqlite_prepare(sink, upsert_sql, &sink->upsert);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_sqlite_prepare(sink, lookup_sql, &sink->lookup);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_sqlite_prepare(sink, "BEGIN IMMEDIATE", &sink->begin);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = __metadata_extractor_sqlite_prepare(sink, "COMMIT", &sink->commit);
+
+out:
+	sqlite3_free(create_sql);
+	sqlite3_free(upsert_sql);
+	sqlite3_free(lookup_sql);
+
+	return ret;
+}
+
+static void __metadata_extractor_sqlite_release(metadata_extractor_sqlite_s *sink)
+{
+	sqlite3_finalize(sink->upsert);
+	sqlite3_finalize(sink->lookup);
+	sqlite3_finalize(sink->begin);
+	sqlite3_finalize(sink->commit);
+	sqlite3_close(sink->db);
+	SAFE_FREE(sink->columns);
+	SAFE_FREE(sink);
+}
+
+int metadata_extractor_sqlite_create(const char *db_path, const char *table, const metadata_extractor_sqlite_column_s *columns, int column_count, metadata_extractor_sqlite_h *sink)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_sqlite_s *_sink = NULL;
+	int idx = 0;
+
+	if((!db_path) || (!sink) || (!__metadata_extractor_sqlite_is_identifier(table)) || ((columns != NULL) && (column_count <= 0)))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	for(idx = 0; (columns != NULL) && (idx < column_count); idx++)
+	{
+		if((columns[idx].attribute < 0) || (columns[idx].attribute >= METADATA_EXTRACTOR_RECORD_ATTR_COUNT) ||
+			(!__metadata_extractor_sqlite_is_identifier(columns[idx].column)) ||
+			(strcasecmp(columns[idx].column, "path") == 0) || (strcasecmp(columns[idx].column, "mtime") == 0))
+		{
+			LOGE("[%s]INVALID_PARAMETER(0x%08x) column [%d]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER, idx);
+			return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+		}
+	}
+
+	_sink = (metadata_extractor_sqlite_s *)calloc(1, sizeof(metadata_extractor_sqlite_s));
+	if(_sink != NULL)
+	{
+		_sink->column_count = (columns != NULL) ? column_count : METADATA_EXTRACTOR_RECORD_ATTR_COUNT;
+		_sink->columns = (metadata_extractor_sqlite_column_s *)calloc(_sink->column_count, sizeof(metadata_extractor_sqlite_column_s));
+	}
+	if((_sink == NULL) || (_sink->columns == NULL))
+	{
+		if(_sink != NULL)
+			SAFE_FREE(_sink);
+		LOGE("[%s]OUT_OF_MEMORY(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY);
+		return METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY;
+	}
+
+	/* column names point at the caller's strings or the static table, both outlive the sink */
+	for(idx = 0; idx < _sink->column_count; idx++)
+	{
+		if(columns != NULL)
+		{
+			_sink->columns[idx] = columns[idx];
+		}
+		else
+		{
+			_sink->columns[idx].attribute = (metadata_extractor_attr_e)idx;
+			_sink->columns[idx].column = g_sqlite_attr_name[idx];
+		}
+	}
+	_sink->batch_size = SQLITE_BATCH_SIZE_DEFAULT;
+
+	if(sqlite3_open_v2(db_path, &_sink->db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK)
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) can not open [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, db_path);
+		__metadata_extractor_sqlite_release(_sink);
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	ret = __metadata_extractor_sqlite_prepare_table(_sink, table);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		__metadata_extractor_sqlite_release(_sink);
+		return ret;
+	}
+
+	*sink = (metadata_extractor_sqlite_h)_sink;
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_sqlite_flush(metadata_extractor_sqlite_h sink)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_sqlite_s *_sink = (metadata_extractor_sqlite_s *)sink;
+
+	if(!_sink)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	if(_sink->pending == 0)
+	{
+		return METADATA_EXTRACTOR_ERROR_NONE;
+	}
+
+	ret = __metadata_extractor_sqlite_step(_sink, _sink->commit);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		_sink->pending = 0;
+	}
+
+	return ret;
+}
+
+int metadata_extractor_sqlite_set_batch_size(metadata_extractor_sqlite_h sink, int rows)
+{
+	metadata_extractor_sqlite_s *_sink = (metadata_extractor_sqlite_s *)sink;
+
+	if((!_sink) || (rows < 1))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	_sink->batch_size = rows;
+
+	if(_sink->pending >= rows)
+	{
+		return metadata_extractor_sqlite_flush(sink);
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+int metadata_extractor_sqlite_is_current(metadata_extractor_sqlite_h sink, const char *path, long long mtime, bool *is_current)
+{
+	metadata_extractor_sqlite_s *_sink = (metadata_extractor_sqlite_s *)sink;
+	int ret = 0;
+
+	if((!_sink) || (!path) || (!is_current))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	sqlite3_bind_text(_sink->lookup, 1, path, -1, SQLITE_STATIC);
+	ret = sqlite3_step(_sink->lookup);
+	*is_current = (ret == SQLITE_ROW) && (sqlite3_column_type(_sink->lookup, 0) == SQLITE_INTEGER) && (sqlite3_column_int64(_sink->lookup, 0) == mtime);
+	sqlite3_reset(_sink->lookup);
+	sqlite3_clear_bindings(_sink->lookup);
+
+	if((ret != SQLITE_ROW) && (ret != SQLITE_DONE))
+	{
+		LOGE("[%s]ERROR_UNKNOWN(0x%08x) [%s]", __FUNCTION__, METADATA_EXTRACTOR_ERROR_OPERATION_FAILED, sqlite3_errmsg(_sink->db));
+		return METADATA_EXTRACTOR_ERROR_OPERATION_FAILED;
+	}
+
+	return METADATA_EXTRACTOR_ERROR_NONE;
+}
+
+static void __metadata_extractor_sqlite_bind_record(metadata_extractor_sqlite_s *sink, const void *record)
+{
+	int idx = 0;
+
+	for(idx = 0; idx < sink->column_count; idx++)
+	{
+		metadata_extractor_attr_e attribute = sink->columns[idx].attribute;
+		int param = idx + 3;
+
+		switch(__metadata_extractor_record_attr_type(attribute))
+		{
+			case METADATA_EXTRACTOR_RECORD_INT:
+			{
+				int value = 0;
+				metadata_extractor_record_get_int(record, attribute, &value);
+				sqlite3_bind_int(sink->upsert, param, value);
+				break;
+			}
+			case METADATA_EXTRACTOR_RECORD_DOUBLE:
+			{
+				double value = 0;
+				metadata_extractor_record_get_double(record, attribute, &value);
+				sqlite3_bind_double(sink->upsert, param, value);
+				break;
+			}
+			case METADATA_EXTRACTOR_RECORD_STRING:
+			{
+				const char *value = NULL;
+				int length = 0;
+				metadata_extractor_record_get_string(record, attribute, &value, &length);
+				if(value != NULL)
+					sqlite3_bind_text(sink->upsert, param, value, length, SQLITE_STATIC);
+				else
+					sqlite3_bind_null(sink->upsert, param);
+				break;
+			}
+		}
+	}
+}
+
+static void __metadata_extractor_sqlite_bind_batch_row(metadata_extractor_sqlite_s *sink, const metadata_extractor_batch_s *batch, int row)
+{
+	int idx = 0;
+
+	for(idx = 0; idx < sink->column_count; idx++)
+	{
+		const metadata_extractor_batch_column_s *column = &batch->columns[sink->columns[idx].attribute];
+		int param = idx + 3;
+
+		if(!METADATA_EXTRACTOR_BATCH_IS_VALID(column, row))
+		{
+			sqlite3_bind_null(sink->upsert, param);
+			continue;
+		}
+
+		switch(__metadata_extractor_record_attr_type(sink->columns[idx].attribute))
+		{
+			case METADATA_EXTRACTOR_RECORD_INT:
+				sqlite3_bind_int(sink->upsert, param, ((const int *)column->values)[row]);
+				break;
+			case METADATA_EXTRACTOR_RECORD_DOUBLE:
+				sqlite3_bind_double(sink->upsert, param, ((const double *)column->values)[row]);
+				break;
+			case METADATA_EXTRACTOR_RECORD_STRING:
+				if(column->intern != NULL)
+				{
+					const char *value = NULL;
+					int length = 0;
+
+					/* interned strings never move */
+					metadata_extractor_intern_get_string(column->intern, column->ids[row], &value, &length);
+					sqlite3_bind_text(sink->upsert, param, value, length, SQLITE_STATIC);
+				}
+				else
+				{
+					sqlite3_bind_text(sink->upsert, param, column->data + column->offsets[row], column->offsets[row + 1] - column->offsets[row], SQLITE_STATIC);
+				}
+				break;
+		}
+	}
+}
+
+/* columns are bound by the caller; strings are bound in place, the step below is their last use */
+static int __metadata_extractor_sqlite_write_row(metadata_extractor_sqlite_s *sink, const char *path, int path_length, long long mtime)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+
+	if(sink->pending == 0)
+	{
+		ret = __metadata_extractor_sqlite_step(sink, sink->begin);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			sqlite3_clear_bindings(sink->upsert);
+			return ret;
+		}
+	}
+
+	sqlite3_bind_text(sink->upsert, 1, path, path_length, SQLITE_STATIC);
+	sqlite3_bind_int64(sink->upsert, 2, mtime);
+
+	ret = __metadata_extractor_sqlite_step(sink, sink->upsert);
+	sqlite3_clear_bindings(sink->upsert);
+
+	/* the transaction is open even when the row failed, keep counting it */
+	sink->pending++;
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		return ret;
+	}
+
+	if(sink->pending >= sink->batch_size)
+	{
+		ret = metadata_extractor_sqlite_flush((metadata_extractor_sqlite_h)sink);
+	}
+
+	return ret;
+}
+
+int metadata_extractor_sqlite_write_record(metadata_extractor_sqlite_h sink, const void *record, long long mtime)
+{
+	metadata_extractor_sqlite_s *_sink = (metadata_extractor_sqlite_s *)sink;
+	const char *path = NULL;
+
+	if((!_sink) || (!record))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	metadata_extractor_record_get_path(record, &path);
+	if(path == NULL)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x) record without path", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	__metadata_extractor_sqlite_bind_record(_sink, record);
+
+	return __metadata_extractor_sqlite_write_row(_sink, path, -1, mtime);
+}
+
+int metadata_extractor_sqlite_write_batch(metadata_extractor_sqlite_h sink, metadata_extractor_batch_h batch, const long long *mtimes)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_sqlite_s *_sink = (metadata_extractor_sqlite_s *)sink;
+	metadata_extractor_batch_s *_batch = (metadata_extractor_batch_s *)batch;
+	int row = 0;
+
+	if((!_sink) || (!_batch) || (!mtimes))
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	for(row = 0; row < _batch->row_count; row++)
+	{
+		/* rows of files that could not be extracted have no duration, nor any other value */
+		if(!METADATA_EXTRACTOR_BATCH_IS_VALID(&_batch->columns[METADATA_DURATION], row))
+		{
+			continue;
+		}
+
+		__metadata_extractor_sqlite_bind_batch_row(_sink, _batch, row);
+
+		ret = __metadata_extractor_sqlite_write_row(_sink, _batch->path.data + _batch->path.offsets[row],
+			_batch->path.offsets[row + 1] - _batch->path.offsets[row], mtimes[row]);
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			return ret;
+		}
+	}
+
+	return ret;
+}
+
+int metadata_extractor_sqlite_destroy(metadata_extractor_sqlite_h sink)
+{
+	int ret = METADATA_EXTRACTOR_ERROR_NONE;
+	metadata_extractor_sqlite_s *_sink = (metadata_extractor_sqlite_s *)sink;
+
+	if(!_sink)
+	{
+		LOGE("[%s]INVALID_PARAMETER(0x%08x)", __FUNCTION__, METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER);
+		return METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = metadata_extractor_sqlite_flush(sink);
+
+	__metadata_extractor_sqlite_release(_sink);
+
+	return ret;
+}
@@ -0,0 +1,316 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Micro benchmarks of the metadata extractor API.
+ *
+ *   metadata : per-call cost of metadata_extractor_get_metadata() on an extracted handle,
+ *              i.e. the fixed overhead (argument checks, logging, dispatch, copy) of every getter.
+ *   extract  : per-file cost of metadata_extractor_set_path() plus reading every attribute.
+ *   text     : throughput of the tag text normalization over 1 MiB lyric blobs in each input encoding,
+ *              no files needed.
+ *
+ * With -a the handles run in arena mode, so results are not freed one by one.
+ *
+ * To see the logging overhead, run the metadata mode against a library built with
+ * -DENABLE_DEBUG_LOG=ON and one built without it.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <metadata_extractor.h>
+#include <metadata_extractor_private.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+#define RESULT_FREE(src)    { if(!g_arena) SAFE_FREE(src) }
+
+#define TEXT_BLOB_SIZE		(1024 * 1024)
+
+static bool g_arena = false;
+
+static unsigned long long __bench_now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static int __bench_metadata(const char *path, int iterations)
+{
+	metadata_extractor_h metadata = NULL;
+	unsigned long long begin = 0;
+	unsigned long long elapsed = 0;
+	unsigned long long calls = 0;
+	int attr = 0;
+	int idx = 0;
+	int ret = 0;
+
+	ret = metadata_extractor_create(&metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		fprintf(stderr, "metadata_extractor_create failed [%d]\n", ret);
+		return -1;
+	}
+	metadata_extractor_set_arena_enabled(metadata, g_arena);
+
+	ret = metadata_extractor_set_path(metadata, path);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		char *value = NULL;
+
+		/* extract once so that the loop measures only the per-call path */
+		ret = metadata_extractor_get_metadata(metadata, METADATA_DURATION, &value);
+		RESULT_FREE(value);
+	}
+
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		fprintf(stderr, "can not extract [%s] [%d]\n", path, ret);
+		metadata_extractor_destroy(metadata);
+		return -1;
+	}
+
+	begin = __bench_now_nsec();
+	for(idx = 0; idx < iterations; idx++)
+	{
+		for(attr = METADATA_DURATION; attr <= METADATA_RECDATE; attr++)
+		{
+			char *value = NULL;
+
+			metadata_extractor_get_metadata(metadata, (metadata_extractor_attr_e)attr, &value);
+			RESULT_FREE(value);
+			calls++;
+		}
+	}
+	elapsed = __bench_now_nsec() - begin;
+
+	printf("metadata\t%s\tcalls=%llu\tns_per_call=%.1f\n", path, calls, calls ? (double)elapsed / calls : 0.0);
+
+	metadata_extractor_destroy(metadata);
+
+	return 0;
+}
+
+static int __bench_extract(char **paths, int count, int iterations)
+{
+	metadata_extractor_h metadata = NULL;
+	unsigned long long begin = 0;
+	unsigned long long elapsed = 0;
+	unsigned long long files = 0;
+	int attr = 0;
+	int idx = 0;
+	int file_idx = 0;
+	int ret = 0;
+
+	ret = metadata_extractor_create(&metadata);
+	if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		fprintf(stderr, "metadata_extractor_create failed [%d]\n", ret);
+		return -1;
+	}
+	metadata_extractor_set_arena_enabled(metadata, g_arena);
+
+	begin = __bench_now_nsec();
+	for(idx = 0; idx < iterations; idx++)
+	{
+		for(file_idx = 0; file_idx < count; file_idx++)
+		{
+			if(metadata_extractor_set_path(metadata, paths[file_idx]) != METADATA_EXTRACTOR_ERROR_NONE)
+				continue;
+
+			/* a scanner reads every attribute of every file */
+			for(attr = METADATA_DURATION; attr <= METADATA_RECDATE; attr++)
+			{
+				char *value = NULL;
+
+				metadata_extractor_get_metadata(metadata, (metadata_extractor_attr_e)attr, &value);
+				RESULT_FREE(value);
+			}
+			files++;
+		}
+	}
+	elapsed = __bench_now_nsec() - begin;
+
+	printf("extract\tfiles=%llu\tus_per_file=%.1f\n", files, files ? (double)elapsed / files / 1000.0 : 0.0);
+
+	metadata_extractor_destroy(metadata);
+
+	return 0;
+}
+
+/* a lyric line repeated up to size bytes, in the given encoding */
+static char *__bench_text_blob(const char *encoding, int *size)
+{
+	static const char line[] = "And the words that I sing are carried away on the wind \xc3\xa9t\xc3\xa9\n";
+	unsigned char *blob = (unsigned char *)malloc(TEXT_BLOB_SIZE + 2);
+	int length = 0;
+	int pos = 0;
+
+	if(blob == NULL)
+	{
+		return NULL;
+	}
+
+	if((strcmp(encoding, "ascii") == 0) || (strcmp(encoding, "utf8") == 0))
+	{
+		bool ascii = (strcmp(encoding, "ascii") == 0);
+
+		while(length < TEXT_BLOB_SIZE)
+		{
+			unsigned char ch = (unsigned char)line[pos++ % (sizeof(line) - 1)];
+			blob[length++] = (ascii && (ch >= 0x80)) ? 'e' : ch;
+		}
+		/* do not end in the middle of a sequence */
+		while((length > 0) && ((blob[length - 1] & 0xc0) == 0x80 || blob[length - 1] >= 0xc0))
+			length--;
+	}
+	else if(strcmp(encoding, "latin1") == 0)
+	{
+		while(length < TEXT_BLOB_SIZE)
+		{
+			unsigned char ch = (unsigned char)line[pos++ % (sizeof(line) - 1)];
+
+			if(ch == 0xc3)
+				continue;
+			blob[length++] = (ch >= 0x80) ? (unsigned char)(ch + 0x40) : ch;
+		}
+	}
+	else if(strcmp(encoding, "utf16") == 0)
+	{
+		blob[length++] = 0xff;
+		blob[length++] = 0xfe;
+		while(length + 2 <= TEXT_BLOB_SIZE)
+		{
+			unsigned char ch = (unsigned char)line[pos++ % (sizeof(line) - 1)];
+
+			if(ch == 0xc3)
+				continue;
+			blob[length++] = (ch >= 0x80) ? (unsigned char)(ch + 0x40) : ch;
+			blob[length++] = 0;
+		}
+	}
+	else
+	{
+		free(blob);
+		return NULL;
+	}
+
+	blob[length] = '\0';
+	blob[length + 1] = '\0';
+	*size = length;
+
+	return (char *)blob;
+}
+
+static int __bench_text(int iterations)
+{
+	static const char *encodings[] = { "ascii", "utf8", "latin1", "utf16" };
+	unsigned int enc = 0;
+	int idx = 0;
+
+	for(enc = 0; enc < sizeof(encodings) / sizeof(encodings[0]); enc++)
+	{
+		unsigned long long begin = 0;
+		unsigned long long elapsed = 0;
+		int size = 0;
+		char *blob = __bench_text_blob(encodings[enc], &size);
+
+		if(blob == NULL)
+		{
+			fprintf(stderr, "can not make [%s] blob\n", encodings[enc]);
+			return -1;
+		}
+
+		begin = __bench_now_nsec();
+		for(idx = 0; idx < iterations; idx++)
+		{
+			char *normalized = NULL;
+
+			if(__metadata_extractor_text_normalize(blob, size, &normalized) != METADATA_EXTRACTOR_ERROR_NONE)
+			{
+				fprintf(stderr, "normalize failed\n");
+				free(blob);
+				return -1;
+			}
+			SAFE_FREE(normalized);
+		}
+		elapsed = __bench_now_nsec() - begin;
+
+		printf("text\t%s\tbytes=%d\tMB_per_s=%.1f\n", encodings[enc], size, elapsed ? (double)size * iterations * 1000.0 / elapsed : 0.0);
+
+		free(blob);
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *mode = "metadata";
+	int iterations = 10000;
+	int c = 0;
+	int idx = 0;
+
+	while((c = getopt(argc, argv, "m:n:ah")) != -1)
+	{
+		switch(c)
+		{
+			case 'm': mode = optarg; break;
+			case 'n': iterations = atoi(optarg); break;
+			case 'a': g_arena = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-m metadata|extract|text] [-n iterations] [-a] <file>...\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if(strcmp(mode, "text") == 0)
+	{
+		return (iterations >= 1) && (__bench_text(iterations) == 0) ? 0 : 1;
+	}
+
+	if((optind >= argc) || (iterations < 1))
+	{
+		fprintf(stderr, "usage: %s [-m metadata|extract|text] [-n iterations] [-a] <file>...\n", argv[0]);
+		return 1;
+	}
+
+	if(strcmp(mode, "metadata") == 0)
+	{
+		for(idx = optind; idx < argc; idx++)
+		{
+			if(__bench_metadata(argv[idx], iterations) != 0)
+				return 1;
+		}
+	}
+	else if(strcmp(mode, "extract") == 0)
+	{
+		if(__bench_extract(&argv[optind], argc - optind, iterations) != 0)
+			return 1;
+	}
+	else
+	{
+		fprintf(stderr, "unknown mode [%s]\n", mode);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1193 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Deterministic synthetic media corpus generator.
+ *
+ * Writes MP3 (ID3v1, ID3v2.3, ID3v2.4 with APIC/SYLT/USLT), M4A, WAV and small MP4
+ * files whose size, tag count, artwork size and lyric line count are controlled from
+ * the command line. The same seed always produces byte-identical files.
+ *
+ * MP3 and WAV payloads are decodable (silent MPEG-1 Layer III frames, PCM triangle wave).
+ * M4A carries silent AAC-LC frames. The MP4 video track is container-valid only, its
+ * samples are placeholders and can not be decoded.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define CORPUS_PATH_MAX			4096
+#define CORPUS_BASE_TAG_NUM		8
+#define CORPUS_MP3_FRAME_LEN		417
+#define CORPUS_MP3_FRAME_SAMPLES	1152
+#define CORPUS_SAMPLERATE			44100
+#define CORPUS_AAC_FRAME_SAMPLES	1024
+#define CORPUS_VIDEO_FPS			25
+
+typedef enum
+{
+	CORPUS_FORMAT_MP3_ID3V1	= 1 << 0,
+	CORPUS_FORMAT_MP3_ID3V23	= 1 << 1,
+	CORPUS_FORMAT_MP3_ID3V24	= 1 << 2,
+	CORPUS_FORMAT_M4A			= 1 << 3,
+	CORPUS_FORMAT_WAV			= 1 << 4,
+	CORPUS_FORMAT_MP4			= 1 << 5,
+	CORPUS_FORMAT_ALL			= 0x3f,
+} corpus_format_e;
+
+typedef struct
+{
+	const char *out_dir;
+	int count;
+	unsigned long long seed;
+	int formats;
+	int tag_num;
+	int artwork_size;
+	int artwork_dim;
+	int lyric_lines;
+	int duration_ms;
+} corpus_option_s;
+
+typedef struct
+{
+	unsigned char *data;
+	size_t len;
+	size_t cap;
+} corpus_buf_s;
+
+typedef struct
+{
+	unsigned long long state;
+} corpus_rand_s;
+
+typedef struct
+{
+	char *title;
+	char *artist;
+	char *album;
+	char *genre;
+	char *composer;
+	char *copyright;
+	char *date;
+	char *comment;
+	int track_num;
+} corpus_tags_s;
+
+static const char *g_words[] = {
+	"amber", "blue", "cinder", "delta", "echo", "falling", "glass", "harbor",
+	"iron", "jade", "kite", "lunar", "marble", "night", "ocean", "paper",
+	"quiet", "river", "silver", "tide", "under", "velvet", "winter", "yellow",
+};
+
+static const char *g_genres[] = {
+	"Rock", "Pop", "Jazz", "Classical", "Electronic", "Folk", "Blues", "Ambient",
+};
+
+/* Silent AAC-LC raw frame, 2 channels */
+static const unsigned char g_aac_silence[] = { 0x21, 0x10, 0x04, 0x60, 0x8c, 0x1c };
+
+static void __corpus_rand_seed(corpus_rand_s *rnd, unsigned long long seed)
+{
+	rnd->state = seed ? seed : 0x9e3779b97f4a7c15ULL;
+}
+
+static unsigned int __corpus_rand_next(corpus_rand_s *rnd)
+{
+	unsigned long long x = rnd->state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	rnd->state = x;
+
+	return (unsigned int)((x * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+static int __corpus_buf_reserve(corpus_buf_s *buf, size_t more)
+{
+	size_t cap = buf->cap ? buf->cap : 4096;
+	unsigned char *data = NULL;
+
+	if(buf->len + more <= buf->cap)
+		return 0;
+
+	while(cap < buf->len + more)
+		cap *= 2;
+
+	data = (unsigned char *)realloc(buf->data, cap);
+	if(data == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return -1;
+	}
+
+	buf->data = data;
+	buf->cap = cap;
+
+	return 0;
+}
+
+static int __corpus_buf_put(corpus_buf_s *buf, const void *data, size_t len)
+{
+	if(__corpus_buf_reserve(buf, len) != 0)
+		return -1;
+
+	memcpy(buf->data + buf->len, data, len);
+	buf->len += len;
+
+	return 0;
+}
+
+static int __corpus_buf_fill(corpus_buf_s *buf, unsigned char value, size_t len)
+{
+	if(__corpus_buf_reserve(buf, len) != 0)
+		return -1;
+
+	memset(buf->data + buf->len, value, len);
+	buf->len += len;
+
+	return 0;
+}
+
+static int __corpus_buf_u8(corpus_buf_s *buf, unsigned int value)
+{
+	unsigned char b = (unsigned char)value;
+	return __corpus_buf_put(buf, &b, 1);
+}
+
+static int __corpus_buf_be16(corpus_buf_s *buf, unsigned int value)
+{
+	unsigned char b[2] = { (unsigned char)(value >> 8), (unsigned char)value };
+	return __corpus_buf_put(buf, b, sizeof(b));
+}
+
+static int __corpus_buf_be32(corpus_buf_s *buf, unsigned int value)
+{
+	unsigned char b[4] = { (unsigned char)(value >> 24), (unsigned char)(value >> 16), (unsigned char)(value >> 8), (unsigned char)value };
+	return __corpus_buf_put(buf, b, sizeof(b));
+}
+
+static int __corpus_buf_le16(corpus_buf_s *buf, unsigned int value)
+{
+	unsigned char b[2] = { (unsigned char)value, (unsigned char)(value >> 8) };
+	return __corpus_buf_put(buf, b, sizeof(b));
+}
+
+static int __corpus_buf_le32(corpus_buf_s *buf, unsigned int value)
+{
+	unsigned char b[4] = { (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24) };
+	return __corpus_buf_put(buf, b, sizeof(b));
+}
+
+static int __corpus_buf_str(corpus_buf_s *buf, const char *str, int with_nul)
+{
+	return __corpus_buf_put(buf, str, strlen(str) + (with_nul ? 1 : 0));
+}
+
+static void __corpus_patch_be32(corpus_buf_s *buf, size_t offset, unsigned int value)
+{
+	buf->data[offset] = (unsigned char)(value >> 24);
+	buf->data[offset + 1] = (unsigned char)(value >> 16);
+	buf->data[offset + 2] = (unsigned char)(value >> 8);
+	buf->data[offset + 3] = (unsigned char)value;
+}
+
+static void __corpus_patch_syncsafe(corpus_buf_s *buf, size_t offset, unsigned int value)
+{
+	buf->data[offset] = (unsigned char)((value >> 21) & 0x7f);
+	buf->data[offset + 1] = (unsigned char)((value >> 14) & 0x7f);
+	buf->data[offset + 2] = (unsigned char)((value >> 7) & 0x7f);
+	buf->data[offset + 3] = (unsigned char)(value & 0x7f);
+}
+
+static void __corpus_patch_le32(corpus_buf_s *buf, size_t offset, unsigned int value)
+{
+	buf->data[offset] = (unsigned char)value;
+	buf->data[offset + 1] = (unsigned char)(value >> 8);
+	buf->data[offset + 2] = (unsigned char)(value >> 16);
+	buf->data[offset + 3] = (unsigned char)(value >> 24);
+}
+
+static char *__corpus_make_phrase(corpus_rand_s *rnd, int words)
+{
+	char phrase[256] = {0, };
+	int idx = 0;
+
+	for(idx = 0; idx < words; idx++)
+	{
+		const char *word = g_words[__corpus_rand_next(rnd) % (sizeof(g_words) / sizeof(g_words[0]))];
+
+		if(idx > 0)
+			strncat(phrase, " ", sizeof(phrase) - strlen(phrase) - 1);
+		strncat(phrase, word, sizeof(phrase) - strlen(phrase) - 1);
+	}
+
+	if(phrase[0] >= 'a' && phrase[0] <= 'z')
+		phrase[0] -= 'a' - 'A';
+
+	return strdup(phrase);
+}
+
+static void __corpus_make_tags(corpus_rand_s *rnd, int file_idx, corpus_tags_s *tags)
+{
+	char date[16] = {0, };
+
+	tags->title = __corpus_make_phrase(rnd, 3);
+	tags->artist = __corpus_make_phrase(rnd, 2);
+	tags->album = __corpus_make_phrase(rnd, 2);
+	tags->genre = strdup(g_genres[__corpus_rand_next(rnd) % (sizeof(g_genres) / sizeof(g_genres[0]))]);
+	tags->composer = __corpus_make_phrase(rnd, 2);
+	tags->copyright = __corpus_make_phrase(rnd, 4);
+	snprintf(date, sizeof(date), "%d", 1960 + (int)(__corpus_rand_next(rnd) % 60));
+	tags->date = strdup(date);
+	tags->comment = __corpus_make_phrase(rnd, 6);
+	tags->track_num = (file_idx % 20) + 1;
+}
+
+static void __corpus_free_tags(corpus_tags_s *tags)
+{
+	SAFE_FREE(tags->title);
+	SAFE_FREE(tags->artist);
+	SAFE_FREE(tags->album);
+	SAFE_FREE(tags->genre);
+	SAFE_FREE(tags->composer);
+	SAFE_FREE(tags->copyright);
+	SAFE_FREE(tags->date);
+	SAFE_FREE(tags->comment);
+}
+
+/*
+ * Baseline grayscale JPEG of dim x dim pixels. Every block is flat mid-gray, so the
+ * entropy coded data is a "DC diff 0, EOB" pair per block using single-code Huffman tables.
+ * COM segments pad the file up to target_size bytes.
+ */
+static int __corpus_make_jpeg(corpus_buf_s *buf, int dim, int target_size)
+{
+	int blocks = ((dim + 7) / 8) * ((dim + 7) / 8);
+	int scan_bytes = (blocks * 2 + 7) / 8;
+	int fixed = 2 + (2 + 16) + (2 + 67) + (2 + 11) + 2 * (2 + 20) + (2 + 8) + scan_bytes + 2;
+	int pad = target_size - fixed;
+	int idx = 0;
+
+	/* SOI, APP0 JFIF */
+	__corpus_buf_be16(buf, 0xffd8);
+	__corpus_buf_be16(buf, 0xffe0);
+	__corpus_buf_be16(buf, 16);
+	__corpus_buf_put(buf, "JFIF\0\x01\x01\x00\x00\x01\x00\x01\x00\x00", 14);
+
+	/* COM padding, each segment carries at most 65533 bytes */
+	while(pad >= 5)
+	{
+		int chunk = pad - 4;
+		if(chunk > 65533)
+			chunk = 65533;
+		if(pad - (chunk + 4) > 0 && pad - (chunk + 4) < 5)
+			chunk -= 5;
+
+		__corpus_buf_be16(buf, 0xfffe);
+		__corpus_buf_be16(buf, chunk + 2);
+		__corpus_buf_fill(buf, 'C', chunk);
+		pad -= chunk + 4;
+	}
+
+	/* DQT, all ones */
+	__corpus_buf_be16(buf, 0xffdb);
+	__corpus_buf_be16(buf, 67);
+	__corpus_buf_u8(buf, 0);
+	__corpus_buf_fill(buf, 1, 64);
+
+	/* SOF0, 8 bit, 1 component */
+	__corpus_buf_be16(buf, 0xffc0);
+	__corpus_buf_be16(buf, 11);
+	__corpus_buf_u8(buf, 8);
+	__corpus_buf_be16(buf, dim);
+	__corpus_buf_be16(buf, dim);
+	__corpus_buf_u8(buf, 1);
+	__corpus_buf_u8(buf, 1);
+	__corpus_buf_u8(buf, 0x11);
+	__corpus_buf_u8(buf, 0);
+
+	/* DHT, DC table 0 and AC table 0 with a single 1-bit code for symbol 0 */
+	for(idx = 0; idx < 2; idx++)
+	{
+		__corpus_buf_be16(buf, 0xffc4);
+		__corpus_buf_be16(buf, 2 + 17 + 1);
+		__corpus_buf_u8(buf, idx << 4);
+		__corpus_buf_u8(buf, 1);
+		__corpus_buf_fill(buf, 0, 15);
+		__corpus_buf_u8(buf, 0);
+	}
+
+	/* SOS */
+	__corpus_buf_be16(buf, 0xffda);
+	__corpus_buf_be16(buf, 8);
+	__corpus_buf_u8(buf, 1);
+	__corpus_buf_u8(buf, 1);
+	__corpus_buf_u8(buf, 0x00);
+	__corpus_buf_u8(buf, 0);
+	__corpus_buf_u8(buf, 63);
+	__corpus_buf_u8(buf, 0);
+
+	/* two zero bits per block, final byte padded with ones */
+	for(idx = 0; idx < scan_bytes; idx++)
+	{
+		int used_bits = blocks * 2 - idx * 8;
+		unsigned char byte = 0;
+
+		if(used_bits < 8)
+			byte = (unsigned char)(0xff >> used_bits);
+		__corpus_buf_u8(buf, byte);
+	}
+
+	/* EOI */
+	return __corpus_buf_be16(buf, 0xffd9);
+}
+
+static void __corpus_id3v2_frame_begin(corpus_buf_s *buf, const char *id, size_t *size_offset)
+{
+	__corpus_buf_put(buf, id, 4);
+	*size_offset = buf->len;
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be16(buf, 0);
+}
+
+static void __corpus_id3v2_frame_end(corpus_buf_s *buf, int version, size_t size_offset)
+{
+	unsigned int size = (unsigned int)(buf->len - size_offset - 6);
+
+	if(version == 4)
+		__corpus_patch_syncsafe(buf, size_offset, size);
+	else
+		__corpus_patch_be32(buf, size_offset, size);
+}
+
+static void __corpus_id3v2_text(corpus_buf_s *buf, int version, const char *id, const char *text)
+{
+	size_t size_offset = 0;
+
+	__corpus_id3v2_frame_begin(buf, id, &size_offset);
+	/* ISO-8859-1 for v2.3, UTF-8 for v2.4 */
+	__corpus_buf_u8(buf, (version == 4) ? 3 : 0);
+	__corpus_buf_str(buf, text, 0);
+	__corpus_id3v2_frame_end(buf, version, size_offset);
+}
+
+static int __corpus_write_id3v2(corpus_buf_s *buf, const corpus_option_s *opt, corpus_rand_s *rnd, const corpus_tags_s *tags, int version)
+{
+	size_t header_offset = buf->len;
+	size_t size_offset = 0;
+	char text[64] = {0, };
+	int idx = 0;
+
+	__corpus_buf_put(buf, "ID3", 3);
+	__corpus_buf_u8(buf, version);
+	__corpus_buf_u8(buf, 0);
+	__corpus_buf_u8(buf, 0);
+	__corpus_buf_be32(buf, 0);
+
+	for(idx = 0; idx < opt->tag_num; idx++)
+	{
+		switch(idx)
+		{
+			case 0: __corpus_id3v2_text(buf, version, "TIT2", tags->title); break;
+			case 1: __corpus_id3v2_text(buf, version, "TPE1", tags->artist); break;
+			case 2: __corpus_id3v2_text(buf, version, "TALB", tags->album); break;
+			case 3: __corpus_id3v2_text(buf, version, "TCON", tags->genre); break;
+			case 4: __corpus_id3v2_text(buf, version, "TCOM", tags->composer); break;
+			case 5: __corpus_id3v2_text(buf, version, "TCOP", tags->copyright); break;
+			case 6: __corpus_id3v2_text(buf, version, (version == 4) ? "TDRC" : "TYER", tags->date); break;
+			case 7:
+				snprintf(text, sizeof(text), "%d", tags->track_num);
+				__corpus_id3v2_text(buf, version, "TRCK", text);
+				break;
+			default:
+			{
+				char *value = __corpus_make_phrase(rnd, 3);
+
+				__corpus_id3v2_frame_begin(buf, "TXXX", &size_offset);
+				__corpus_buf_u8(buf, (version == 4) ? 3 : 0);
+				snprintf(text, sizeof(text), "CORPUS_TAG_%d", idx);
+				__corpus_buf_str(buf, text, 1);
+				__corpus_buf_str(buf, value, 0);
+				__corpus_id3v2_frame_end(buf, version, size_offset);
+				SAFE_FREE(value);
+				break;
+			}
+		}
+	}
+
+	if(opt->tag_num > 0)
+	{
+		__corpus_id3v2_frame_begin(buf, "COMM", &size_offset);
+		__corpus_buf_u8(buf, 0);
+		__corpus_buf_put(buf, "eng", 3);
+		__corpus_buf_u8(buf, 0);
+		__corpus_buf_str(buf, tags->comment, 0);
+		__corpus_id3v2_frame_end(buf, version, size_offset);
+	}
+
+	if(opt->artwork_size > 0)
+	{
+		__corpus_id3v2_frame_begin(buf, "APIC", &size_offset);
+		__corpus_buf_u8(buf, 0);
+		__corpus_buf_str(buf, "image/jpeg", 1);
+		__corpus_buf_u8(buf, 3);
+		__corpus_buf_u8(buf, 0);
+		__corpus_make_jpeg(buf, opt->artwork_dim, opt->artwork_size);
+		__corpus_id3v2_frame_end(buf, version, size_offset);
+	}
+
+	if(opt->lyric_lines > 0)
+	{
+		int step_ms = opt->duration_ms / (opt->lyric_lines + 1);
+
+		__corpus_id3v2_frame_begin(buf, "SYLT", &size_offset);
+		__corpus_buf_u8(buf, 0);
+		__corpus_buf_put(buf, "eng", 3);
+		__corpus_buf_u8(buf, 2);	/* absolute time in milliseconds */
+		__corpus_buf_u8(buf, 1);	/* lyrics */
+		__corpus_buf_u8(buf, 0);
+		for(idx = 0; idx < opt->lyric_lines; idx++)
+		{
+			char *line = __corpus_make_phrase(rnd, 5);
+			__corpus_buf_str(buf, line, 1);
+			__corpus_buf_be32(buf, (unsigned int)(step_ms * (idx + 1)));
+			SAFE_FREE(line);
+		}
+		__corpus_id3v2_frame_end(buf, version, size_offset);
+
+		__corpus_id3v2_frame_begin(buf, "USLT", &size_offset);
+		__corpus_buf_u8(buf, 0);
+		__corpus_buf_put(buf, "eng", 3);
+		__corpus_buf_u8(buf, 0);
+		for(idx = 0; idx < opt->lyric_lines; idx++)
+		{
+			char *line = __corpus_make_phrase(rnd, 5);
+			__corpus_buf_str(buf, line, 0);
+			__corpus_buf_u8(buf, '\n');
+			SAFE_FREE(line);
+		}
+		__corpus_id3v2_frame_end(buf, version, size_offset);
+	}
+
+	/* padding */
+	__corpus_buf_fill(buf, 0, 256);
+	__corpus_patch_syncsafe(buf, header_offset + 6, (unsigned int)(buf->len - header_offset - 10));
+
+	return 0;
+}
+
+static void __corpus_id3v1_field(corpus_buf_s *buf, const char *text, int len)
+{
+	int text_len = (int)strlen(text);
+
+	if(text_len > len)
+		text_len = len;
+	__corpus_buf_put(buf, text, text_len);
+	__corpus_buf_fill(buf, 0, len - text_len);
+}
+
+static int __corpus_write_id3v1(corpus_buf_s *buf, const corpus_tags_s *tags)
+{
+	__corpus_buf_put(buf, "TAG", 3);
+	__corpus_id3v1_field(buf, tags->title, 30);
+	__corpus_id3v1_field(buf, tags->artist, 30);
+	__corpus_id3v1_field(buf, tags->album, 30);
+	__corpus_id3v1_field(buf, tags->date, 4);
+	__corpus_id3v1_field(buf, tags->comment, 28);
+	__corpus_buf_u8(buf, 0);
+	__corpus_buf_u8(buf, tags->track_num);
+
+	/* ID3v1 genre index 17 is Rock */
+	return __corpus_buf_u8(buf, 17);
+}
+
+static int __corpus_write_mp3_frames(corpus_buf_s *buf, const corpus_option_s *opt)
+{
+	long frames = ((long)opt->duration_ms * CORPUS_SAMPLERATE) / (CORPUS_MP3_FRAME_SAMPLES * 1000L);
+	long idx = 0;
+
+	if(frames < 1)
+		frames = 1;
+
+	for(idx = 0; idx < frames; idx++)
+	{
+		/* MPEG-1 Layer III, 128kbps, 44.1kHz, mono; zeroed side info decodes as silence */
+		__corpus_buf_put(buf, "\xff\xfb\x90\xc4", 4);
+		if(__corpus_buf_fill(buf, 0, CORPUS_MP3_FRAME_LEN - 4) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int __corpus_build_mp3(corpus_buf_s *buf, const corpus_option_s *opt, corpus_rand_s *rnd, const corpus_tags_s *tags, corpus_format_e format)
+{
+	if(format == CORPUS_FORMAT_MP3_ID3V23)
+		__corpus_write_id3v2(buf, opt, rnd, tags, 3);
+	else if(format == CORPUS_FORMAT_MP3_ID3V24)
+		__corpus_write_id3v2(buf, opt, rnd, tags, 4);
+
+	if(__corpus_write_mp3_frames(buf, opt) != 0)
+		return -1;
+
+	if(format == CORPUS_FORMAT_MP3_ID3V1)
+		return __corpus_write_id3v1(buf, tags);
+
+	return 0;
+}
+
+static void __corpus_riff_info(corpus_buf_s *buf, const char *id, const char *text)
+{
+	unsigned int len = (unsigned int)strlen(text) + 1;
+
+	__corpus_buf_put(buf, id, 4);
+	__corpus_buf_le32(buf, len);
+	__corpus_buf_str(buf, text, 1);
+	if(len & 1)
+		__corpus_buf_u8(buf, 0);
+}
+
+static int __corpus_build_wav(corpus_buf_s *buf, const corpus_option_s *opt, corpus_rand_s *rnd, const corpus_tags_s *tags)
+{
+	long samples = ((long)opt->duration_ms * CORPUS_SAMPLERATE) / 1000L;
+	size_t list_offset = 0;
+	size_t data_offset = 0;
+	long idx = 0;
+	int period = 50 + (int)(__corpus_rand_next(rnd) % 400);
+
+	__corpus_buf_put(buf, "RIFF", 4);
+	__corpus_buf_le32(buf, 0);
+	__corpus_buf_put(buf, "WAVE", 4);
+
+	/* PCM, 2 channels, 16 bit */
+	__corpus_buf_put(buf, "fmt ", 4);
+	__corpus_buf_le32(buf, 16);
+	__corpus_buf_le16(buf, 1);
+	__corpus_buf_le16(buf, 2);
+	__corpus_buf_le32(buf, CORPUS_SAMPLERATE);
+	__corpus_buf_le32(buf, CORPUS_SAMPLERATE * 4);
+	__corpus_buf_le16(buf, 4);
+	__corpus_buf_le16(buf, 16);
+
+	if(opt->tag_num > 0)
+	{
+		__corpus_buf_put(buf, "LIST", 4);
+		list_offset = buf->len;
+		__corpus_buf_le32(buf, 0);
+		__corpus_buf_put(buf, "INFO", 4);
+		if(opt->tag_num > 0) __corpus_riff_info(buf, "INAM", tags->title);
+		if(opt->tag_num > 1) __corpus_riff_info(buf, "IART", tags->artist);
+		if(opt->tag_num > 2) __corpus_riff_info(buf, "IPRD", tags->album);
+		if(opt->tag_num > 3) __corpus_riff_info(buf, "IGNR", tags->genre);
+		if(opt->tag_num > 5) __corpus_riff_info(buf, "ICOP", tags->copyright);
+		if(opt->tag_num > 6) __corpus_riff_info(buf, "ICRD", tags->date);
+		__corpus_riff_info(buf, "ICMT", tags->comment);
+		__corpus_patch_le32(buf, list_offset, (unsigned int)(buf->len - list_offset - 4));
+	}
+
+	__corpus_buf_put(buf, "data", 4);
+	data_offset = buf->len;
+	__corpus_buf_le32(buf, 0);
+	if(__corpus_buf_reserve(buf, samples * 4) != 0)
+		return -1;
+
+	/* triangle wave with a little deterministic noise; right channel at half level */
+	for(idx = 0; idx < samples; idx++)
+	{
+		int phase = (int)(idx % period);
+		int level = (phase < period / 2) ? phase : period - phase;
+		int sample = (level * 60000) / period - 15000 + (int)(__corpus_rand_next(rnd) % 512) - 256;
+
+		__corpus_buf_le16(buf, (unsigned int)(short)sample);
+		__corpus_buf_le16(buf, (unsigned int)(short)(sample / 2));
+	}
+
+	__corpus_patch_le32(buf, data_offset, (unsigned int)(buf->len - data_offset - 4));
+	__corpus_patch_le32(buf, 4, (unsigned int)(buf->len - 8));
+
+	return 0;
+}
+
+static size_t __corpus_box_begin(corpus_buf_s *buf, const char *type)
+{
+	size_t offset = buf->len;
+
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_put(buf, type, 4);
+
+	return offset;
+}
+
+static void __corpus_box_end(corpus_buf_s *buf, size_t offset)
+{
+	__corpus_patch_be32(buf, offset, (unsigned int)(buf->len - offset));
+}
+
+static void __corpus_full_box_header(corpus_buf_s *buf, int version, unsigned int flags)
+{
+	__corpus_buf_u8(buf, version);
+	__corpus_buf_u8(buf, flags >> 16);
+	__corpus_buf_be16(buf, flags & 0xffff);
+}
+
+static void __corpus_mp4_matrix(corpus_buf_s *buf)
+{
+	__corpus_buf_be32(buf, 0x00010000);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0x00010000);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0x40000000);
+}
+
+static void __corpus_mp4_ilst_text(corpus_buf_s *buf, const char *type, const char *text)
+{
+	size_t item = __corpus_box_begin(buf, type);
+	size_t data = __corpus_box_begin(buf, "data");
+
+	__corpus_buf_be32(buf, 1);	/* UTF-8 */
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_str(buf, text, 0);
+	__corpus_box_end(buf, data);
+	__corpus_box_end(buf, item);
+}
+
+static void __corpus_mp4_udta(corpus_buf_s *buf, const corpus_option_s *opt, corpus_rand_s *rnd, const corpus_tags_s *tags)
+{
+	size_t udta = __corpus_box_begin(buf, "udta");
+	size_t meta = __corpus_box_begin(buf, "meta");
+	size_t box = 0;
+	size_t ilst = 0;
+	int idx = 0;
+
+	__corpus_full_box_header(buf, 0, 0);
+
+	box = __corpus_box_begin(buf, "hdlr");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_put(buf, "mdirappl", 8);
+	__corpus_buf_fill(buf, 0, 9);
+	__corpus_box_end(buf, box);
+
+	ilst = __corpus_box_begin(buf, "ilst");
+	for(idx = 0; idx < opt->tag_num && idx < CORPUS_BASE_TAG_NUM; idx++)
+	{
+		switch(idx)
+		{
+			case 0: __corpus_mp4_ilst_text(buf, "\xa9nam", tags->title); break;
+			case 1: __corpus_mp4_ilst_text(buf, "\xa9" "ART", tags->artist); break;
+			case 2: __corpus_mp4_ilst_text(buf, "\xa9" "alb", tags->album); break;
+			case 3: __corpus_mp4_ilst_text(buf, "\xa9gen", tags->genre); break;
+			case 4: __corpus_mp4_ilst_text(buf, "\xa9wrt", tags->composer); break;
+			case 5: __corpus_mp4_ilst_text(buf, "cprt", tags->copyright); break;
+			case 6: __corpus_mp4_ilst_text(buf, "\xa9" "day", tags->date); break;
+			case 7:
+			{
+				size_t item = __corpus_box_begin(buf, "trkn");
+				size_t data = __corpus_box_begin(buf, "data");
+				__corpus_buf_be32(buf, 0);
+				__corpus_buf_be32(buf, 0);
+				__corpus_buf_be16(buf, 0);
+				__corpus_buf_be16(buf, tags->track_num);
+				__corpus_buf_be16(buf, 20);
+				__corpus_buf_be16(buf, 0);
+				__corpus_box_end(buf, data);
+				__corpus_box_end(buf, item);
+				break;
+			}
+		}
+	}
+
+	if(opt->tag_num > 0)
+		__corpus_mp4_ilst_text(buf, "\xa9" "cmt", tags->comment);
+
+	if(opt->lyric_lines > 0)
+	{
+		size_t item = __corpus_box_begin(buf, "\xa9lyr");
+		size_t data = __corpus_box_begin(buf, "data");
+
+		__corpus_buf_be32(buf, 1);
+		__corpus_buf_be32(buf, 0);
+		for(idx = 0; idx < opt->lyric_lines; idx++)
+		{
+			char *line = __corpus_make_phrase(rnd, 5);
+			__corpus_buf_str(buf, line, 0);
+			__corpus_buf_u8(buf, '\n');
+			SAFE_FREE(line);
+		}
+		__corpus_box_end(buf, data);
+		__corpus_box_end(buf, item);
+	}
+
+	if(opt->artwork_size > 0)
+	{
+		size_t item = __corpus_box_begin(buf, "covr");
+		size_t data = __corpus_box_begin(buf, "data");
+
+		__corpus_buf_be32(buf, 13);	/* JPEG */
+		__corpus_buf_be32(buf, 0);
+		__corpus_make_jpeg(buf, opt->artwork_dim, opt->artwork_size);
+		__corpus_box_end(buf, data);
+		__corpus_box_end(buf, item);
+	}
+
+	__corpus_box_end(buf, ilst);
+	__corpus_box_end(buf, meta);
+	__corpus_box_end(buf, udta);
+}
+
+/* Writes one trak with a constant sample size and one chunk per sample table entry. */
+static void __corpus_mp4_trak(corpus_buf_s *buf, int track_id, int is_video, unsigned int duration_ms,
+								unsigned int timescale, unsigned int sample_delta, unsigned int sample_count,
+								unsigned int sample_size, size_t *stco_patch)
+{
+	size_t trak = __corpus_box_begin(buf, "trak");
+	size_t box = 0;
+	size_t mdia = 0;
+	size_t minf = 0;
+	size_t stbl = 0;
+	size_t stsd = 0;
+	size_t entry = 0;
+
+	box = __corpus_box_begin(buf, "tkhd");
+	__corpus_full_box_header(buf, 0, 0x000007);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, track_id);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, duration_ms);
+	__corpus_buf_fill(buf, 0, 8);
+	__corpus_buf_be16(buf, 0);
+	__corpus_buf_be16(buf, 0);
+	__corpus_buf_be16(buf, is_video ? 0 : 0x0100);
+	__corpus_buf_be16(buf, 0);
+	__corpus_mp4_matrix(buf);
+	__corpus_buf_be32(buf, is_video ? (320 << 16) : 0);
+	__corpus_buf_be32(buf, is_video ? (240 << 16) : 0);
+	__corpus_box_end(buf, box);
+
+	mdia = __corpus_box_begin(buf, "mdia");
+
+	box = __corpus_box_begin(buf, "mdhd");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, timescale);
+	__corpus_buf_be32(buf, sample_delta * sample_count);
+	__corpus_buf_be16(buf, 0x55c4);	/* und */
+	__corpus_buf_be16(buf, 0);
+	__corpus_box_end(buf, box);
+
+	box = __corpus_box_begin(buf, "hdlr");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_put(buf, is_video ? "vide" : "soun", 4);
+	__corpus_buf_fill(buf, 0, 12);
+	__corpus_buf_str(buf, is_video ? "VideoHandler" : "SoundHandler", 1);
+	__corpus_box_end(buf, box);
+
+	minf = __corpus_box_begin(buf, "minf");
+	if(is_video)
+	{
+		box = __corpus_box_begin(buf, "vmhd");
+		__corpus_full_box_header(buf, 0, 1);
+		__corpus_buf_fill(buf, 0, 8);
+		__corpus_box_end(buf, box);
+	}
+	else
+	{
+		box = __corpus_box_begin(buf, "smhd");
+		__corpus_full_box_header(buf, 0, 0);
+		__corpus_buf_be32(buf, 0);
+		__corpus_box_end(buf, box);
+	}
+
+	box = __corpus_box_begin(buf, "dinf");
+	{
+		size_t dref = __corpus_box_begin(buf, "dref");
+		size_t url = 0;
+		__corpus_full_box_header(buf, 0, 0);
+		__corpus_buf_be32(buf, 1);
+		url = __corpus_box_begin(buf, "url ");
+		__corpus_full_box_header(buf, 0, 1);
+		__corpus_box_end(buf, url);
+		__corpus_box_end(buf, dref);
+	}
+	__corpus_box_end(buf, box);
+
+	stbl = __corpus_box_begin(buf, "stbl");
+
+	stsd = __corpus_box_begin(buf, "stsd");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 1);
+	if(is_video)
+	{
+		entry = __corpus_box_begin(buf, "avc1");
+		__corpus_buf_fill(buf, 0, 6);
+		__corpus_buf_be16(buf, 1);
+		__corpus_buf_fill(buf, 0, 16);
+		__corpus_buf_be16(buf, 320);
+		__corpus_buf_be16(buf, 240);
+		__corpus_buf_be32(buf, 0x00480000);
+		__corpus_buf_be32(buf, 0x00480000);
+		__corpus_buf_be32(buf, 0);
+		__corpus_buf_be16(buf, 1);
+		__corpus_buf_fill(buf, 0, 32);
+		__corpus_buf_be16(buf, 0x0018);
+		__corpus_buf_be16(buf, 0xffff);
+		box = __corpus_box_begin(buf, "avcC");
+		/* baseline profile 3.0, one 4 byte SPS and PPS placeholder */
+		__corpus_buf_put(buf, "\x01\x42\xc0\x1e\xff\xe1\x00\x04\x67\x42\xc0\x1e\x01\x00\x04\x68\xce\x3c\x80", 19);
+		__corpus_box_end(buf, box);
+		__corpus_box_end(buf, entry);
+	}
+	else
+	{
+		entry = __corpus_box_begin(buf, "mp4a");
+		__corpus_buf_fill(buf, 0, 6);
+		__corpus_buf_be16(buf, 1);
+		__corpus_buf_fill(buf, 0, 8);
+		__corpus_buf_be16(buf, 2);
+		__corpus_buf_be16(buf, 16);
+		__corpus_buf_be32(buf, 0);
+		__corpus_buf_be32(buf, CORPUS_SAMPLERATE << 16);
+		box = __corpus_box_begin(buf, "esds");
+		__corpus_full_box_header(buf, 0, 0);
+		/* ES_Descriptor, DecoderConfigDescriptor (AAC), AudioSpecificConfig LC/44100/stereo, SLConfig */
+		__corpus_buf_put(buf, "\x03\x19\x00\x01\x00\x04\x11\x40\x15\x00\x00\x00\x00\x01\xf4\x00\x00\x01\xf4\x00\x05\x02\x12\x10\x06\x01\x02", 27);
+		__corpus_box_end(buf, box);
+		__corpus_box_end(buf, entry);
+	}
+	__corpus_box_end(buf, stsd);
+
+	box = __corpus_box_begin(buf, "stts");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 1);
+	__corpus_buf_be32(buf, sample_count);
+	__corpus_buf_be32(buf, sample_delta);
+	__corpus_box_end(buf, box);
+
+	if(is_video)
+	{
+		/* every sample is a sync sample */
+		box = __corpus_box_begin(buf, "stss");
+		__corpus_full_box_header(buf, 0, 0);
+		__corpus_buf_be32(buf, 1);
+		__corpus_buf_be32(buf, 1);
+		__corpus_box_end(buf, box);
+	}
+
+	box = __corpus_box_begin(buf, "stsc");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 1);
+	__corpus_buf_be32(buf, 1);
+	__corpus_buf_be32(buf, sample_count);
+	__corpus_buf_be32(buf, 1);
+	__corpus_box_end(buf, box);
+
+	box = __corpus_box_begin(buf, "stsz");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, sample_size);
+	__corpus_buf_be32(buf, sample_count);
+	__corpus_box_end(buf, box);
+
+	box = __corpus_box_begin(buf, "stco");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 1);
+	*stco_patch = buf->len;
+	__corpus_buf_be32(buf, 0);
+	__corpus_box_end(buf, box);
+
+	__corpus_box_end(buf, stbl);
+	__corpus_box_end(buf, minf);
+	__corpus_box_end(buf, mdia);
+	__corpus_box_end(buf, trak);
+}
+
+static int __corpus_build_mp4(corpus_buf_s *buf, const corpus_option_s *opt, corpus_rand_s *rnd, const corpus_tags_s *tags, int with_video)
+{
+	unsigned int audio_samples = (unsigned int)(((long)opt->duration_ms * CORPUS_SAMPLERATE) / (CORPUS_AAC_FRAME_SAMPLES * 1000L));
+	unsigned int video_samples = (unsigned int)(((long)opt->duration_ms * CORPUS_VIDEO_FPS) / 1000L);
+	unsigned int video_sample_size = 512;
+	size_t audio_stco = 0;
+	size_t video_stco = 0;
+	size_t box = 0;
+	size_t moov = 0;
+	size_t mdat = 0;
+	unsigned int idx = 0;
+
+	if(audio_samples < 1)
+		audio_samples = 1;
+	if(video_samples < 1)
+		video_samples = 1;
+
+	box = __corpus_box_begin(buf, "ftyp");
+	__corpus_buf_put(buf, with_video ? "isom" : "M4A ", 4);
+	__corpus_buf_be32(buf, 0x200);
+	__corpus_buf_put(buf, with_video ? "isomiso2avc1mp41" : "M4A mp42isom", with_video ? 16 : 12);
+	__corpus_box_end(buf, box);
+
+	moov = __corpus_box_begin(buf, "moov");
+
+	box = __corpus_box_begin(buf, "mvhd");
+	__corpus_full_box_header(buf, 0, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 0);
+	__corpus_buf_be32(buf, 1000);
+	__corpus_buf_be32(buf, opt->duration_ms);
+	__corpus_buf_be32(buf, 0x00010000);
+	__corpus_buf_be16(buf, 0x0100);
+	__corpus_buf_fill(buf, 0, 10);
+	__corpus_mp4_matrix(buf);
+	__corpus_buf_fill(buf, 0, 24);
+	__corpus_buf_be32(buf, with_video ? 3 : 2);
+	__corpus_box_end(buf, box);
+
+	if(with_video)
+		__corpus_mp4_trak(buf, 2, 1, opt->duration_ms, 1000 * CORPUS_VIDEO_FPS, 1000, video_samples, video_sample_size, &video_stco);
+	__corpus_mp4_trak(buf, 1, 0, opt->duration_ms, CORPUS_SAMPLERATE, CORPUS_AAC_FRAME_SAMPLES, audio_samples, sizeof(g_aac_silence), &audio_stco);
+
+	__corpus_mp4_udta(buf, opt, rnd, tags);
+	__corpus_box_end(buf, moov);
+
+	mdat = __corpus_box_begin(buf, "mdat");
+
+	__corpus_patch_be32(buf, audio_stco, (unsigned int)buf->len);
+	for(idx = 0; idx < audio_samples; idx++)
+		__corpus_buf_put(buf, g_aac_silence, sizeof(g_aac_silence));
+
+	if(with_video)
+	{
+		__corpus_patch_be32(buf, video_stco, (unsigned int)buf->len);
+		for(idx = 0; idx < video_samples; idx++)
+		{
+			/* length prefixed IDR NAL placeholder */
+			__corpus_buf_be32(buf, video_sample_size - 4);
+			__corpus_buf_u8(buf, 0x65);
+			if(__corpus_buf_fill(buf, (unsigned char)(__corpus_rand_next(rnd) & 0x7f), video_sample_size - 5) != 0)
+				return -1;
+		}
+	}
+
+	__corpus_box_end(buf, mdat);
+
+	return 0;
+}
+
+static int __corpus_write_file(const char *path, const corpus_buf_s *buf)
+{
+	FILE *fp = fopen(path, "wb");
+
+	if(fp == NULL)
+	{
+		fprintf(stderr, "can not open [%s] (%s)\n", path, strerror(errno));
+		return -1;
+	}
+
+	if(fwrite(buf->data, 1, buf->len, fp) != buf->len)
+	{
+		fprintf(stderr, "can not write [%s] (%s)\n", path, strerror(errno));
+		fclose(fp);
+		return -1;
+	}
+
+	fclose(fp);
+
+	printf("%s\t%zu\n", path, buf->len);
+
+	return 0;
+}
+
+static int __corpus_generate(const corpus_option_s *opt, int file_idx, corpus_format_e format)
+{
+	corpus_buf_s buf = {NULL, 0, 0};
+	corpus_tags_s tags;
+	corpus_rand_s rnd;
+	char path[CORPUS_PATH_MAX] = {0, };
+	const char *suffix = NULL;
+	int ret = 0;
+
+	memset(&tags, 0, sizeof(tags));
+
+	/* every file gets its own stream so adding formats does not shift the others */
+	__corpus_rand_seed(&rnd, opt->seed ^ ((unsigned long long)(file_idx + 1) << 32) ^ (unsigned long long)format);
+	__corpus_make_tags(&rnd, file_idx, &tags);
+
+	switch(format)
+	{
+		case CORPUS_FORMAT_MP3_ID3V1:
+			suffix = "_id3v1.mp3";
+			ret = __corpus_build_mp3(&buf, opt, &rnd, &tags, format);
+			break;
+		case CORPUS_FORMAT_MP3_ID3V23:
+			suffix = "_id3v23.mp3";
+			ret = __corpus_build_mp3(&buf, opt, &rnd, &tags, format);
+			break;
+		case CORPUS_FORMAT_MP3_ID3V24:
+			suffix = "_id3v24.mp3";
+			ret = __corpus_build_mp3(&buf, opt, &rnd, &tags, format);
+			break;
+		case CORPUS_FORMAT_M4A:
+			suffix = ".m4a";
+			ret = __corpus_build_mp4(&buf, opt, &rnd, &tags, 0);
+			break;
+		case CORPUS_FORMAT_WAV:
+			suffix = ".wav";
+			ret = __corpus_build_wav(&buf, opt, &rnd, &tags);
+			break;
+		case CORPUS_FORMAT_MP4:
+			suffix = ".mp4";
+			ret = __corpus_build_mp4(&buf, opt, &rnd, &tags, 1);
+			break;
+		default:
+			ret = -1;
+			break;
+	}
+
+	if(ret == 0)
+	{
+		snprintf(path, sizeof(path), "%s/corpus_%05d%s", opt->out_dir, file_idx, suffix);
+		ret = __corpus_write_file(path, &buf);
+	}
+
+	__corpus_free_tags(&tags);
+	SAFE_FREE(buf.data);
+
+	return ret;
+}
+
+static int __corpus_parse_formats(const char *list)
+{
+	int formats = 0;
+	char *dup = strdup(list);
+	char *save = NULL;
+	char *token = NULL;
+
+	if(dup == NULL)
+		return -1;
+
+	for(token = strtok_r(dup, ",", &save); token != NULL; token = strtok_r(NULL, ",", &save))
+	{
+		if(strcmp(token, "all") == 0) formats |= CORPUS_FORMAT_ALL;
+		else if(strcmp(token, "id3v1") == 0) formats |= CORPUS_FORMAT_MP3_ID3V1;
+		else if(strcmp(token, "id3v23") == 0) formats |= CORPUS_FORMAT_MP3_ID3V23;
+		else if(strcmp(token, "id3v24") == 0) formats |= CORPUS_FORMAT_MP3_ID3V24;
+		else if(strcmp(token, "mp3") == 0) formats |= CORPUS_FORMAT_MP3_ID3V1 | CORPUS_FORMAT_MP3_ID3V23 | CORPUS_FORMAT_MP3_ID3V24;
+		else if(strcmp(token, "m4a") == 0) formats |= CORPUS_FORMAT_M4A;
+		else if(strcmp(token, "wav") == 0) formats |= CORPUS_FORMAT_WAV;
+		else if(strcmp(token, "mp4") == 0) formats |= CORPUS_FORMAT_MP4;
+		else
+		{
+			fprintf(stderr, "unknown format [%s]\n", token);
+			formats = -1;
+			break;
+		}
+	}
+
+	SAFE_FREE(dup);
+
+	return formats;
+}
+
+static void __corpus_usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [options] <output_dir>\n"
+		"  -n <count>       files per format (default 1)\n"
+		"  -s <seed>        random seed (default 1)\n"
+		"  -f <list>        formats: all,mp3,id3v1,id3v23,id3v24,m4a,wav,mp4 (default all)\n"
+		"  -t <tags>        text tag count, extra tags become TXXX frames (default 8)\n"
+		"  -a <bytes>       embedded artwork size, 0 disables (default 32768)\n"
+		"  -w <pixels>      artwork width and height (default 300)\n"
+		"  -l <lines>       synchronized/unsynchronized lyric lines (default 16)\n"
+		"  -d <msec>        payload duration (default 5000)\n",
+		name);
+}
+
+int main(int argc, char *argv[])
+{
+	corpus_option_s opt;
+	int c = 0;
+	int file_idx = 0;
+	int bit = 0;
+
+	opt.out_dir = NULL;
+	opt.count = 1;
+	opt.seed = 1;
+	opt.formats = CORPUS_FORMAT_ALL;
+	opt.tag_num = CORPUS_BASE_TAG_NUM;
+	opt.artwork_size = 32768;
+	opt.artwork_dim = 300;
+	opt.lyric_lines = 16;
+	opt.duration_ms = 5000;
+
+	while((c = getopt(argc, argv, "n:s:f:t:a:w:l:d:h")) != -1)
+	{
+		switch(c)
+		{
+			case 'n': opt.count = atoi(optarg); break;
+			case 's': opt.seed = strtoull(optarg, NULL, 0); break;
+			case 'f': opt.formats = __corpus_parse_formats(optarg); break;
+			case 't': opt.tag_num = atoi(optarg); break;
+			case 'a': opt.artwork_size = atoi(optarg); break;
+			case 'w': opt.artwork_dim = atoi(optarg); break;
+			case 'l': opt.lyric_lines = atoi(optarg); break;
+			case 'd': opt.duration_ms = atoi(optarg); break;
+			default:
+				__corpus_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if((optind >= argc) || (opt.formats <= 0) || (opt.count < 0) || (opt.tag_num < 0) ||
+		(opt.artwork_size < 0) || (opt.artwork_dim < 1) || (opt.artwork_dim > 65535) ||
+		(opt.lyric_lines < 0) || (opt.duration_ms < 1))
+	{
+		__corpus_usage(argv[0]);
+		return 1;
+	}
+
+	opt.out_dir = argv[optind];
+	if((mkdir(opt.out_dir, 0755) != 0) && (errno != EEXIST))
+	{
+		fprintf(stderr, "can not create [%s] (%s)\n", opt.out_dir, strerror(errno));
+		return 1;
+	}
+
+	for(file_idx = 0; file_idx < opt.count; file_idx++)
+	{
+		for(bit = 0; bit < 6; bit++)
+		{
+			if((opt.formats & (1 << bit)) == 0)
+				continue;
+
+			if(__corpus_generate(&opt, file_idx, (corpus_format_e)(1 << bit)) != 0)
+				return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Concurrent reader stress test.
+ *
+ * Several threads share one handle and start querying it at the same moment, so they race
+ * on the lazy extraction and then read in parallel. Every value is compared against a
+ * reference taken from a private handle. Build the library and this test with
+ * -DCMAKE_C_FLAGS=-fsanitize=thread to check for data races. With -a the shared handle runs
+ * in arena mode, so the readers also race on the arena.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <metadata_extractor.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+#define RESULT_FREE(src)    { if(!g_arena) SAFE_FREE(src) }
+
+#define THREAD_MAX		64
+#define ATTR_NUM		(METADATA_RECDATE + 1)
+
+typedef struct
+{
+	metadata_extractor_h metadata;
+	int iterations;
+	int mismatch;
+	int error;
+} thread_arg_s;
+
+static char *g_reference[ATTR_NUM];
+static int g_reference_artwork_size = 0;
+static pthread_barrier_t g_start;
+static bool g_arena = false;
+
+static int __is_same(const char *a, const char *b)
+{
+	if((a == NULL) || (b == NULL))
+		return a == b;
+
+	return strcmp(a, b) == 0;
+}
+
+static void *__reader(void *data)
+{
+	thread_arg_s *arg = (thread_arg_s *)data;
+	int idx = 0;
+	int attr = 0;
+
+	pthread_barrier_wait(&g_start);
+
+	for(idx = 0; idx < arg->iterations; idx++)
+	{
+		void *artwork = NULL;
+		int artwork_size = 0;
+		char *artwork_mime = NULL;
+		unsigned long time_stamp = 0;
+		char *lyrics = NULL;
+
+		for(attr = 0; attr < ATTR_NUM; attr++)
+		{
+			char *value = NULL;
+
+			if(metadata_extractor_get_metadata(arg->metadata, (metadata_extractor_attr_e)attr, &value) != METADATA_EXTRACTOR_ERROR_NONE)
+				arg->error++;
+			else if(!__is_same(value, g_reference[attr]))
+				arg->mismatch++;
+			RESULT_FREE(value);
+		}
+
+		if(metadata_extractor_get_artwork(arg->metadata, &artwork, &artwork_size, &artwork_mime) != METADATA_EXTRACTOR_ERROR_NONE)
+			arg->error++;
+		else if(artwork_size != g_reference_artwork_size)
+			arg->mismatch++;
+		RESULT_FREE(artwork);
+		RESULT_FREE(artwork_mime);
+
+		if(metadata_extractor_get_synclyrics(arg->metadata, 0, &time_stamp, &lyrics) != METADATA_EXTRACTOR_ERROR_NONE)
+			arg->error++;
+		RESULT_FREE(lyrics);
+	}
+
+	return NULL;
+}
+
+static int __build_reference(const char *path)
+{
+	metadata_extractor_h metadata = NULL;
+	void *artwork = NULL;
+	char *artwork_mime = NULL;
+	int attr = 0;
+	int ret = 0;
+
+	ret = metadata_extractor_create(&metadata);
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = metadata_extractor_set_path(metadata, path);
+
+	for(attr = 0; (ret == METADATA_EXTRACTOR_ERROR_NONE) && (attr < ATTR_NUM); attr++)
+		ret = metadata_extractor_get_metadata(metadata, (metadata_extractor_attr_e)attr, &g_reference[attr]);
+
+	if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		ret = metadata_extractor_get_artwork(metadata, &artwork, &g_reference_artwork_size, &artwork_mime);
+
+	SAFE_FREE(artwork);
+	SAFE_FREE(artwork_mime);
+
+	if(metadata != NULL)
+		metadata_extractor_destroy(metadata);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	metadata_extractor_h metadata = NULL;
+	pthread_t thread[THREAD_MAX];
+	thread_arg_s arg[THREAD_MAX];
+	int thread_num = 8;
+	int iterations = 1000;
+	int mismatch = 0;
+	int error = 0;
+	int idx = 0;
+	int c = 0;
+
+	while((c = getopt(argc, argv, "t:n:ah")) != -1)
+	{
+		switch(c)
+		{
+			case 't': thread_num = atoi(optarg); break;
+			case 'n': iterations = atoi(optarg); break;
+			case 'a': g_arena = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-t threads] [-n iterations] [-a] <file>\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if((optind >= argc) || (thread_num < 1) || (thread_num > THREAD_MAX) || (iterations < 1))
+	{
+		fprintf(stderr, "usage: %s [-t threads] [-n iterations] [-a] <file>\n", argv[0]);
+		return 1;
+	}
+
+	if(__build_reference(argv[optind]) != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		fprintf(stderr, "can not extract [%s]\n", argv[optind]);
+		return 1;
+	}
+
+	if((metadata_extractor_create(&metadata) != METADATA_EXTRACTOR_ERROR_NONE) ||
+		(metadata_extractor_set_path(metadata, argv[optind]) != METADATA_EXTRACTOR_ERROR_NONE))
+	{
+		fprintf(stderr, "can not create handle\n");
+		return 1;
+	}
+	metadata_extractor_set_arena_enabled(metadata, g_arena);
+
+	pthread_barrier_init(&g_start, NULL, thread_num);
+
+	for(idx = 0; idx < thread_num; idx++)
+	{
+		arg[idx].metadata = metadata;
+		arg[idx].iterations = iterations;
+		arg[idx].mismatch = 0;
+		arg[idx].error = 0;
+		pthread_create(&thread[idx], NULL, __reader, &arg[idx]);
+	}
+
+	for(idx = 0; idx < thread_num; idx++)
+	{
+		pthread_join(thread[idx], NULL);
+		mismatch += arg[idx].mismatch;
+		error += arg[idx].error;
+	}
+
+	pthread_barrier_destroy(&g_start);
+	metadata_extractor_destroy(metadata);
+
+	for(idx = 0; idx < ATTR_NUM; idx++)
+		SAFE_FREE(g_reference[idx]);
+
+	printf("threads=%d iterations=%d errors=%d mismatches=%d\n", thread_num, iterations, error, mismatch);
+
+	return ((error == 0) && (mismatch == 0)) ? 0 : 1;
+}
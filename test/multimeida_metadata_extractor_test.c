@@ -89,6 +89,9 @@ static bool __capi_metadata_extractor(metadata_extractor_h metadata)
 	int idx = 0;
 	unsigned long time_info = 0;
 	char *lyrics = NULL;
+	metadata_extractor_stats_s stats;
+	void *record = NULL;
+	size_t record_size = 0;
 
 	if(metadata == NULL)
 	{
@@ -175,6 +178,23 @@ static bool __capi_metadata_extractor(metadata_extractor_h metadata)
 	metadata_extractor_get_frame_at_time(metadata, 22500, false, &video_frame, &video_frame_len);
 	LOGI("video_frame[%p], video_frame_len = [%d]\n\n", video_frame, video_frame_len);
 
+	/*Get phase timing*/
+	metadata_extractor_get_stats(metadata, &stats);
+	LOGI("content[%llu] content_attr[%llu] tag[%llu] artwork[%llu] frame[%llu] usec\n", stats.content_time, stats.content_attr_time, stats.tag_time, stats.artwork_time, stats.frame_time);
+	LOGI("bytes_read[%llu] alloc_count[%u] alloc_size[%llu]\n\n", stats.bytes_read, stats.alloc_count, stats.alloc_size);
+
+	/*Serialize and read back in place*/
+	if(metadata_extractor_serialize(metadata, &record, &record_size) == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		const char *record_title = NULL;
+		int record_duration = 0;
+
+		LOGI("record = [%p], record_size = [%d], valid = [%d]\n", record, (int)record_size, metadata_extractor_record_validate(record, record_size));
+		metadata_extractor_record_get_int(record, METADATA_DURATION, &record_duration);
+		metadata_extractor_record_get_string(record, METADATA_TITLE, &record_title, NULL);
+		LOGI("record duration = [%d], title = [%s]\n\n", record_duration, record_title);
+	}
+
 	SAFE_FREE(duration );
 	SAFE_FREE(audio_bitrate );
 	SAFE_FREE(audio_channel );
@@ -208,6 +228,7 @@ static bool __capi_metadata_extractor(metadata_extractor_h metadata)
 	SAFE_FREE(unsynclyrics);
 	SAFE_FREE(synclyrics_num);
 	SAFE_FREE(rec_date);
+	SAFE_FREE(record);
 
 	return true;
 
@@ -217,6 +238,7 @@ int main(int argc, char *argv[])
 {
 	int ret = METADATA_EXTRACTOR_ERROR_NONE;
 	metadata_extractor_h metadata;
+	metadata_extractor_batch_h batch = NULL;
 	int idx = 0;
 	int cnt = argc -1;
 	LOGI("--- metadata extractor test start ---\n\n");
@@ -234,6 +256,8 @@ int main(int argc, char *argv[])
 		return 0;
 	}
 
+	metadata_extractor_set_stats_enabled(metadata, true);
+
 	for(idx = 0; idx < cnt; idx++)
 	{
 		LOGI("--------------------------------------------\n");
@@ -255,6 +279,28 @@ int main(int argc, char *argv[])
 
 	}
 
+	/*Extract all files into one columnar batch*/
+	if(metadata_extractor_batch_create(&batch) == METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		const int *durations = NULL;
+		const int *title_offsets = NULL;
+		const char *title_data = NULL;
+		int row_count = 0;
+		long long total_duration = 0;
+
+		metadata_extractor_batch_extract(metadata, (const char **)&argv[1], cnt, batch);
+		metadata_extractor_batch_get_row_count(batch, &row_count);
+		metadata_extractor_batch_get_int_column(batch, METADATA_DURATION, &durations, NULL);
+		metadata_extractor_batch_get_string_column(batch, METADATA_TITLE, &title_offsets, &title_data, NULL);
+		for(idx = 0; idx < row_count; idx++)
+		{
+			total_duration += durations[idx];
+			LOGI("batch row [%d] title = [%.*s]\n", idx, title_offsets[idx + 1] - title_offsets[idx], title_data + title_offsets[idx]);
+		}
+		LOGI("batch rows = [%d], total duration = [%lld]\n\n", row_count, total_duration);
+		metadata_extractor_batch_destroy(batch);
+	}
+
 exception:
 	ret = metadata_extractor_destroy(metadata);
 	LOGI("metadata_extractor_destroy [%d]\n", ret);
@@ -0,0 +1,633 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * metadata-extractor-dump: extract files in parallel and print one JSON object per line.
+ *
+ *   metadata-extractor-dump [-j workers] [-a attr,attr,...] [-s min_ms] <file|dir|->...
+ *
+ * Directories are walked recursively without following symlinks, "-" reads a path list from
+ * stdin. Paths go through a bounded queue and every record is written as soon as its file is
+ * done, so memory stays flat however many files are dumped. Records come out in completion
+ * order. With -s only files slower than min_ms are printed, which finds the slow files of a
+ * large tree.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <metadata_extractor.h>
+
+#define SAFE_FREE(src)      { if(src) {free(src); src = NULL;}}
+
+#define DUMP_QUEUE_SIZE		1024
+#define DUMP_WORKER_MAX		256
+#define DUMP_NFTW_FDS		64
+
+typedef enum
+{
+	DUMP_TYPE_INT,
+	DUMP_TYPE_DOUBLE,
+	DUMP_TYPE_STRING,
+} dump_type_e;
+
+typedef struct
+{
+	const char *name;
+	metadata_extractor_attr_e attr;
+	dump_type_e type;
+} dump_attr_s;
+
+typedef struct
+{
+	char *path[DUMP_QUEUE_SIZE];
+	int head;
+	int count;
+	bool closed;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+} dump_queue_s;
+
+typedef struct
+{
+	char *data;
+	size_t len;
+	size_t size;
+} dump_buffer_s;
+
+static const dump_attr_s g_dump_attr[] = {
+	{ "duration", METADATA_DURATION, DUMP_TYPE_INT },
+	{ "video_bitrate", METADATA_VIDEO_BITRATE, DUMP_TYPE_INT },
+	{ "video_fps", METADATA_VIDEO_FPS, DUMP_TYPE_INT },
+	{ "video_width", METADATA_VIDEO_WIDTH, DUMP_TYPE_INT },
+	{ "video_height", METADATA_VIDEO_HEIGHT, DUMP_TYPE_INT },
+	{ "has_video", METADATA_HAS_VIDEO, DUMP_TYPE_INT },
+	{ "audio_bitrate", METADATA_AUDIO_BITRATE, DUMP_TYPE_INT },
+	{ "audio_channels", METADATA_AUDIO_CHANNELS, DUMP_TYPE_INT },
+	{ "audio_samplerate", METADATA_AUDIO_SAMPLERATE, DUMP_TYPE_INT },
+	{ "has_audio", METADATA_HAS_AUDIO, DUMP_TYPE_INT },
+	{ "artist", METADATA_ARTIST, DUMP_TYPE_STRING },
+	{ "title", METADATA_TITLE, DUMP_TYPE_STRING },
+	{ "album", METADATA_ALBUM, DUMP_TYPE_STRING },
+	{ "genre", METADATA_GENRE, DUMP_TYPE_STRING },
+	{ "author", METADATA_AUTHOR, DUMP_TYPE_STRING },
+	{ "copyright", METADATA_COPYRIGHT, DUMP_TYPE_STRING },
+	{ "date", METADATA_DATE, DUMP_TYPE_STRING },
+	{ "description", METADATA_DESCRIPTION, DUMP_TYPE_STRING },
+	{ "track_num", METADATA_TRACK_NUM, DUMP_TYPE_STRING },
+	{ "classification", METADATA_CLASSIFICATION, DUMP_TYPE_STRING },
+	{ "rating", METADATA_RATING, DUMP_TYPE_STRING },
+	{ "longitude", METADATA_LONGITUDE, DUMP_TYPE_DOUBLE },
+	{ "latitude", METADATA_LATITUDE, DUMP_TYPE_DOUBLE },
+	{ "altitude", METADATA_ALTITUDE, DUMP_TYPE_DOUBLE },
+	{ "conductor", METADATA_CONDUCTOR, DUMP_TYPE_STRING },
+	{ "unsynclyrics", METADATA_UNSYNCLYRICS, DUMP_TYPE_STRING },
+	{ "synclyrics_num", METADATA_SYNCLYRICS_NUM, DUMP_TYPE_INT },
+	{ "recdate", METADATA_RECDATE, DUMP_TYPE_STRING },
+};
+
+#define DUMP_ATTR_NUM		(int)(sizeof(g_dump_attr) / sizeof(g_dump_attr[0]))
+
+static dump_queue_s g_queue;
+static bool g_selected[DUMP_ATTR_NUM];
+static unsigned long long g_min_usec = 0;
+static pthread_mutex_t g_output_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long long g_files = 0;
+static unsigned long long g_errors = 0;
+
+static unsigned long long __dump_now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000ULL + (unsigned long long)(ts.tv_nsec / 1000);
+}
+
+static void __dump_queue_init(dump_queue_s *queue)
+{
+	memset(queue, 0, sizeof(*queue));
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+}
+
+/* blocks while the queue is full, which is what keeps a huge walk in bounded memory */
+static void __dump_queue_push(dump_queue_s *queue, const char *path)
+{
+	char *dup = strdup(path);
+
+	if(dup == NULL)
+	{
+		fprintf(stderr, "out of memory, skipping [%s]\n", path);
+		return;
+	}
+
+	pthread_mutex_lock(&queue->lock);
+	while(queue->count == DUMP_QUEUE_SIZE)
+	{
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+	}
+	queue->path[(queue->head + queue->count) % DUMP_QUEUE_SIZE] = dup;
+	queue->count++;
+	pthread_cond_signal(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+}
+
+static char *__dump_queue_pop(dump_queue_s *queue)
+{
+	char *path = NULL;
+
+	pthread_mutex_lock(&queue->lock);
+	while((queue->count == 0) && (!queue->closed))
+	{
+		pthread_cond_wait(&queue->not_empty, &queue->lock);
+	}
+	if(queue->count > 0)
+	{
+		path = queue->path[queue->head];
+		queue->head = (queue->head + 1) % DUMP_QUEUE_SIZE;
+		queue->count--;
+		pthread_cond_signal(&queue->not_full);
+	}
+	pthread_mutex_unlock(&queue->lock);
+
+	return path;
+}
+
+static void __dump_queue_close(dump_queue_s *queue)
+{
+	pthread_mutex_lock(&queue->lock);
+	queue->closed = true;
+	pthread_cond_broadcast(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+}
+
+static bool __dump_buffer_reserve(dump_buffer_s *buffer, size_t len)
+{
+	char *data = NULL;
+	size_t size = (buffer->size > 0) ? buffer->size : 1024;
+
+	if(buffer->len + len + 1 <= buffer->size)
+	{
+		return true;
+	}
+
+	while(size < buffer->len + len + 1)
+	{
+		size *= 2;
+	}
+
+	data = (char *)realloc(buffer->data, size);
+	if(data == NULL)
+	{
+		return false;
+	}
+
+	buffer->data = data;
+	buffer->size = size;
+
+	return true;
+}
+
+static void __dump_buffer_append(dump_buffer_s *buffer, const char *str, size_t len)
+{
+	if(!__dump_buffer_reserve(buffer, len))
+	{
+		return;
+	}
+
+	memcpy(buffer->data + buffer->len, str, len);
+	buffer->len += len;
+	buffer->data[buffer->len] = '\0';
+}
+
+static void __dump_buffer_printf(dump_buffer_s *buffer, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void __dump_buffer_printf(dump_buffer_s *buffer, const char *fmt, ...)
+{
+	va_list ap;
+	int len = 0;
+
+	va_start(ap, fmt);
+	len = vsnprintf(NULL, 0, fmt, ap);
+	va_end(ap);
+
+	if((len <= 0) || (!__dump_buffer_reserve(buffer, len)))
+	{
+		return;
+	}
+
+	va_start(ap, fmt);
+	vsnprintf(buffer->data + buffer->len, buffer->size - buffer->len, fmt, ap);
+	va_end(ap);
+	buffer->len += len;
+}
+
+/* length of the valid UTF-8 sequence at str, 0 when it is not one */
+static int __dump_utf8_length(const unsigned char *str)
+{
+	if(str[0] < 0x80)
+	{
+		return 1;
+	}
+	if((str[0] >= 0xc2) && (str[0] <= 0xdf))
+	{
+		return ((str[1] & 0xc0) == 0x80) ? 2 : 0;
+	}
+	if((str[0] >= 0xe0) && (str[0] <= 0xef))
+	{
+		if(((str[1] & 0xc0) != 0x80) || ((str[2] & 0xc0) != 0x80))
+			return 0;
+		if(((str[0] == 0xe0) && (str[1] < 0xa0)) || ((str[0] == 0xed) && (str[1] > 0x9f)))
+			return 0;
+		return 3;
+	}
+	if((str[0] >= 0xf0) && (str[0] <= 0xf4))
+	{
+		if(((str[1] & 0xc0) != 0x80) || ((str[2] & 0xc0) != 0x80) || ((str[3] & 0xc0) != 0x80))
+			return 0;
+		if(((str[0] == 0xf0) && (str[1] < 0x90)) || ((str[0] == 0xf4) && (str[1] > 0x8f)))
+			return 0;
+		return 4;
+	}
+
+	return 0;
+}
+
+/* JSON string; bytes that are not UTF-8 become U+FFFD so that every line stays valid JSON */
+static void __dump_buffer_append_string(dump_buffer_s *buffer, const char *str)
+{
+	const unsigned char *ch = (const unsigned char *)str;
+
+	__dump_buffer_append(buffer, "\"", 1);
+
+	while(*ch != '\0')
+	{
+		const unsigned char *run = ch;
+		int len = 0;
+
+		while((*ch >= 0x20) && (*ch < 0x80) && (*ch != '"') && (*ch != '\\'))
+		{
+			ch++;
+		}
+		if(ch > run)
+		{
+			__dump_buffer_append(buffer, (const char *)run, ch - run);
+			continue;
+		}
+
+		if((*ch == '"') || (*ch == '\\'))
+		{
+			char esc[2] = { '\\', (char)*ch };
+			__dump_buffer_append(buffer, esc, 2);
+			ch++;
+		}
+		else if(*ch < 0x20)
+		{
+			__dump_buffer_printf(buffer, "\\u%04x", *ch);
+			ch++;
+		}
+		else if((len = __dump_utf8_length(ch)) > 0)
+		{
+			__dump_buffer_append(buffer, (const char *)ch, len);
+			ch += len;
+		}
+		else
+		{
+			__dump_buffer_append(buffer, "\\ufffd", 6);
+			ch++;
+		}
+	}
+
+	__dump_buffer_append(buffer, "\"", 1);
+}
+
+static const char *__dump_error_name(int error)
+{
+	switch(error)
+	{
+		case METADATA_EXTRACTOR_ERROR_NONE: return "none";
+		case METADATA_EXTRACTOR_ERROR_INVALID_PARAMETER: return "invalid_parameter";
+		case METADATA_EXTRACTOR_ERROR_OUT_OF_MEMORY: return "out_of_memory";
+		case METADATA_EXTRACTOR_ERROR_FILE_EXISTS: return "file_exists";
+		case METADATA_EXTRACTOR_ERROR_OPERATION_FAILED: return "operation_failed";
+		default: return "unknown";
+	}
+}
+
+static void __dump_format_record(dump_buffer_s *buffer, const void *record)
+{
+	int idx = 0;
+
+	for(idx = 0; idx < DUMP_ATTR_NUM; idx++)
+	{
+		const dump_attr_s *attr = &g_dump_attr[idx];
+
+		if(!g_selected[idx])
+		{
+			continue;
+		}
+
+		if(attr->type == DUMP_TYPE_INT)
+		{
+			int value = 0;
+
+			metadata_extractor_record_get_int(record, attr->attr, &value);
+			__dump_buffer_printf(buffer, ",\"%s\":%d", attr->name, value);
+		}
+		else if(attr->type == DUMP_TYPE_DOUBLE)
+		{
+			double value = 0;
+
+			metadata_extractor_record_get_double(record, attr->attr, &value);
+			if(isfinite(value))
+				__dump_buffer_printf(buffer, ",\"%s\":%.6f", attr->name, value);
+			else
+				__dump_buffer_printf(buffer, ",\"%s\":null", attr->name);
+		}
+		else
+		{
+			const char *value = NULL;
+
+			metadata_extractor_record_get_string(record, attr->attr, &value, NULL);
+			if(value == NULL)
+			{
+				continue;
+			}
+			__dump_buffer_printf(buffer, ",\"%s\":", attr->name);
+			__dump_buffer_append_string(buffer, value);
+		}
+	}
+}
+
+static void *__dump_worker(void *data)
+{
+	metadata_extractor_h metadata = NULL;
+	dump_buffer_s buffer = { NULL, 0, 0 };
+	char *path = NULL;
+
+	if(metadata_extractor_create(&metadata) != METADATA_EXTRACTOR_ERROR_NONE)
+	{
+		fprintf(stderr, "metadata_extractor_create failed\n");
+		return NULL;
+	}
+
+	/* the record of a file lives until the next set_path, nothing to free per file */
+	metadata_extractor_set_arena_enabled(metadata, true);
+
+	while((path = __dump_queue_pop(&g_queue)) != NULL)
+	{
+		unsigned long long begin = __dump_now_usec();
+		unsigned long long elapsed = 0;
+		void *record = NULL;
+		size_t record_size = 0;
+		int ret = 0;
+
+		ret = metadata_extractor_set_path(metadata, path);
+		if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			ret = metadata_extractor_serialize(metadata, &record, &record_size);
+		}
+		elapsed = __dump_now_usec() - begin;
+
+		if(elapsed >= g_min_usec)
+		{
+			buffer.len = 0;
+			__dump_buffer_append(&buffer, "{\"path\":", 8);
+			__dump_buffer_append_string(&buffer, path);
+			__dump_buffer_printf(&buffer, ",\"error\":%d,\"error_name\":\"%s\",\"time_us\":%llu", ret, __dump_error_name(ret), elapsed);
+			if(ret == METADATA_EXTRACTOR_ERROR_NONE)
+			{
+				__dump_format_record(&buffer, record);
+			}
+			__dump_buffer_append(&buffer, "}\n", 2);
+		}
+
+		pthread_mutex_lock(&g_output_lock);
+		if((elapsed >= g_min_usec) && (buffer.len > 0))
+		{
+			fwrite(buffer.data, 1, buffer.len, stdout);
+		}
+		g_files++;
+		if(ret != METADATA_EXTRACTOR_ERROR_NONE)
+		{
+			g_errors++;
+		}
+		pthread_mutex_unlock(&g_output_lock);
+
+		SAFE_FREE(path);
+	}
+
+	SAFE_FREE(buffer.data);
+	metadata_extractor_destroy(metadata);
+
+	return NULL;
+}
+
+static int __dump_walk_entry(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+	if(type == FTW_F)
+	{
+		__dump_queue_push(&g_queue, path);
+	}
+	else if((type == FTW_DNR) || (type == FTW_NS))
+	{
+		fprintf(stderr, "can not read [%s]\n", path);
+	}
+
+	return 0;
+}
+
+static void __dump_read_list(FILE *fp)
+{
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t len = 0;
+
+	while((len = getline(&line, &size, fp)) != -1)
+	{
+		while((len > 0) && ((line[len - 1] == '\n') || (line[len - 1] == '\r')))
+		{
+			line[--len] = '\0';
+		}
+		if(len > 0)
+		{
+			__dump_queue_push(&g_queue, line);
+		}
+	}
+
+	SAFE_FREE(line);
+}
+
+static bool __dump_select_attrs(const char *list)
+{
+	char *dup = strdup(list);
+	char *save = NULL;
+	char *name = NULL;
+	int idx = 0;
+
+	if(dup == NULL)
+	{
+		return false;
+	}
+
+	memset(g_selected, 0, sizeof(g_selected));
+
+	for(name = strtok_r(dup, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+	{
+		for(idx = 0; idx < DUMP_ATTR_NUM; idx++)
+		{
+			if(strcmp(name, g_dump_attr[idx].name) == 0)
+			{
+				g_selected[idx] = true;
+				break;
+			}
+		}
+		if(idx == DUMP_ATTR_NUM)
+		{
+			fprintf(stderr, "unknown attribute [%s]\n", name);
+			SAFE_FREE(dup);
+			return false;
+		}
+	}
+
+	SAFE_FREE(dup);
+
+	return true;
+}
+
+static void __dump_usage(const char *name)
+{
+	int idx = 0;
+
+	fprintf(stderr, "usage: %s [-j workers] [-a attr,attr,...] [-s min_ms] <file|dir|->...\n", name);
+	fprintf(stderr, "attributes:");
+	for(idx = 0; idx < DUMP_ATTR_NUM; idx++)
+	{
+		fprintf(stderr, " %s", g_dump_attr[idx].name);
+	}
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t worker[DUMP_WORKER_MAX];
+	long worker_num = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned long long begin = 0;
+	unsigned long long elapsed = 0;
+	int idx = 0;
+	int c = 0;
+
+	for(idx = 0; idx < DUMP_ATTR_NUM; idx++)
+	{
+		g_selected[idx] = true;
+	}
+
+	while((c = getopt(argc, argv, "j:a:s:h")) != -1)
+	{
+		switch(c)
+		{
+			case 'j': worker_num = atol(optarg); break;
+			case 'a':
+				if(!__dump_select_attrs(optarg))
+					return 1;
+				break;
+			case 's': g_min_usec = strtoull(optarg, NULL, 10) * 1000ULL; break;
+			default:
+				__dump_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if((optind >= argc) || (worker_num < 1))
+	{
+		__dump_usage(argv[0]);
+		return 1;
+	}
+
+	if(worker_num > DUMP_WORKER_MAX)
+	{
+		worker_num = DUMP_WORKER_MAX;
+	}
+
+	__dump_queue_init(&g_queue);
+
+	begin = __dump_now_usec();
+
+	for(idx = 0; idx < worker_num; idx++)
+	{
+		if(pthread_create(&worker[idx], NULL, __dump_worker, NULL) != 0)
+		{
+			fprintf(stderr, "can not start worker [%d]\n", idx);
+			worker_num = idx;
+			break;
+		}
+	}
+
+	if(worker_num == 0)
+	{
+		return 1;
+	}
+
+	for(idx = optind; idx < argc; idx++)
+	{
+		struct stat st;
+
+		if(strcmp(argv[idx], "-") == 0)
+		{
+			__dump_read_list(stdin);
+		}
+		else if(stat(argv[idx], &st) != 0)
+		{
+			/* still dumped, the record carries the error */
+			__dump_queue_push(&g_queue, argv[idx]);
+		}
+		else if(S_ISDIR(st.st_mode))
+		{
+			nftw(argv[idx], __dump_walk_entry, DUMP_NFTW_FDS, FTW_PHYS);
+		}
+		else
+		{
+			__dump_queue_push(&g_queue, argv[idx]);
+		}
+	}
+
+	__dump_queue_close(&g_queue);
+
+	for(idx = 0; idx < worker_num; idx++)
+	{
+		pthread_join(worker[idx], NULL);
+	}
+
+	fflush(stdout);
+
+	elapsed = __dump_now_usec() - begin;
+	fprintf(stderr, "files=%llu errors=%llu workers=%ld elapsed_ms=%llu files_per_sec=%.1f\n",
+			g_files, g_errors, worker_num, elapsed / 1000, elapsed ? (double)g_files * 1000000.0 / elapsed : 0.0);
+
+	return (g_errors == 0) ? 0 : 2;
+}